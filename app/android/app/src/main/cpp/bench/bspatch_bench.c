@@ -0,0 +1,589 @@
+/*
+ * bspatch_bench.c - Host benchmark for bspatch
+ *
+ * Usage:
+ *   bspatch_bench [--size MB]               synthetic old/new/patch triple
+ *   bspatch_bench OLD NEW PATCH             real APK pair and its patch
+ *
+ * Reports end-to-end apply throughput (with and without inline digests),
+ * the peak RSS of the applying process, and the throughput of the three
+ * stages in isolation: inflate, diff-add and write. The patched output is
+ * compared against NEW, so the tool doubles as a regression check; so is
+ * the resume check, which cancels bspatch_resume() part way and finishes
+ * the patch from its checkpoint.
+ *
+ * Peak RSS includes the resident pages of the memory-mapped old file; the
+ * anonymous part is bounded by bspatch_work_mem_size().
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <zlib.h>
+
+#include "bspatch.h"
+#include "bspatch_kernel.h"
+
+#define CHUNK (256 * 1024)
+#define RUNS 3
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static double mb(int64_t bytes) {
+    return bytes / (1024.0 * 1024.0);
+}
+
+static void die(const char *what) {
+    fprintf(stderr, "bspatch_bench: %s: %s\n", what, strerror(errno));
+    exit(2);
+}
+
+static int64_t file_size(const char *path) {
+    struct stat st;
+    if (stat(path, &st) != 0) die(path);
+    return st.st_size;
+}
+
+static void write_all(int fd, const void *buf, size_t len) {
+    const uint8_t *p = buf;
+    while (len > 0) {
+        ssize_t n = write(fd, p, len);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            die("write");
+        }
+        p += n;
+        len -= n;
+    }
+}
+
+/* ---- Synthetic patch generation ---- */
+
+static uint64_t rng_state = 0x9E3779B97F4A7C15ull;
+
+static uint64_t rng(void) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 7;
+    rng_state ^= rng_state << 17;
+    return rng_state;
+}
+
+static void offtout(int64_t x, uint8_t *buf) {
+    uint64_t y = x < 0 ? (uint64_t)-x : (uint64_t)x;
+    for (int i = 0; i < 8; i++) {
+        buf[i] = (uint8_t)(y >> (8 * i));
+    }
+    if (x < 0) buf[7] |= 0x80;
+}
+
+/* gzip stream that appends to a file descriptor */
+typedef struct {
+    z_stream strm;
+    int fd;
+    int64_t written;
+    uint8_t out[CHUNK];
+} gz_writer;
+
+static void gz_open(gz_writer *w, int fd) {
+    memset(&w->strm, 0, sizeof(w->strm));
+    if (deflateInit2(&w->strm, 6, Z_DEFLATED, 16 + MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+        fprintf(stderr, "bspatch_bench: deflateInit2 failed\n");
+        exit(2);
+    }
+    w->fd = fd;
+    w->written = 0;
+}
+
+static void gz_write(gz_writer *w, const uint8_t *data, size_t len, int flush) {
+    w->strm.next_in = (uint8_t *)data;
+    w->strm.avail_in = len;
+    do {
+        w->strm.next_out = w->out;
+        w->strm.avail_out = CHUNK;
+        deflate(&w->strm, flush);
+        size_t n = CHUNK - w->strm.avail_out;
+        write_all(w->fd, w->out, n);
+        w->written += n;
+    } while (w->strm.avail_out == 0);
+}
+
+static void gz_close(gz_writer *w) {
+    gz_write(w, NULL, 0, Z_FINISH);
+    deflateEnd(&w->strm);
+}
+
+static void append_file(int dst, const char *path) {
+    uint8_t buf[CHUNK];
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) die(path);
+    ssize_t n;
+    while ((n = read(fd, buf, sizeof(buf))) > 0) {
+        write_all(dst, buf, n);
+    }
+    close(fd);
+    unlink(path);
+}
+
+/*
+ * Build an old file and a new file that differs from it the way APK
+ * releases do: long runs of the old content with sparse byte changes,
+ * short inserted runs, and small seeks. The patch is written with the
+ * same layout bsdiff uses (BSDIFF40, gzip blocks).
+ */
+static void generate(const char *dir, int64_t size) {
+    char path[4096];
+    uint8_t *old = malloc(size);
+    uint8_t *buf = malloc(CHUNK);
+    uint8_t *ctrl = NULL;
+    size_t ctrl_len = 0, ctrl_cap = 0;
+    if (!old || !buf) die("malloc");
+
+    for (int64_t i = 0; i < size; i += 8) {
+        uint64_t r = rng();
+        memcpy(old + i, &r, size - i < 8 ? (size_t)(size - i) : 8);
+    }
+    snprintf(path, sizeof(path), "%s/old", dir);
+    int old_fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (old_fd < 0) die(path);
+    write_all(old_fd, old, size);
+    close(old_fd);
+
+    snprintf(path, sizeof(path), "%s/new", dir);
+    int new_fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    snprintf(path, sizeof(path), "%s/diff.tmp", dir);
+    int diff_fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    snprintf(path, sizeof(path), "%s/extra.tmp", dir);
+    int extra_fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (new_fd < 0 || diff_fd < 0 || extra_fd < 0) die("create");
+
+    static gz_writer diff_gz, extra_gz;
+    gz_open(&diff_gz, diff_fd);
+    gz_open(&extra_gz, extra_fd);
+
+    int64_t oldpos = 0, newpos = 0;
+    while (newpos < size) {
+        int64_t diff_len = 64 * 1024 + (int64_t)(rng() % (4 * 1024 * 1024));
+        int64_t extra_len = (int64_t)(rng() % (16 * 1024));
+        int64_t seek = (int64_t)(rng() % (128 * 1024)) - 64 * 1024;
+        if (diff_len > size - newpos) diff_len = size - newpos;
+        if (extra_len > size - newpos - diff_len) extra_len = size - newpos - diff_len;
+
+        for (int64_t done = 0; done < diff_len;) {
+            size_t n = diff_len - done < CHUNK ? (size_t)(diff_len - done) : CHUNK;
+            for (size_t i = 0; i < n; i++) {
+                /* About 2% of bytes change, by a small delta */
+                uint64_t r = rng();
+                buf[i] = (r & 63) == 0 ? (uint8_t)(r >> 8) & 7 : 0;
+            }
+            gz_write(&diff_gz, buf, n, Z_NO_FLUSH);
+            for (size_t i = 0; i < n; i++) {
+                int64_t o = oldpos + done + i;
+                if (o >= 0 && o < size) buf[i] += old[o];
+            }
+            write_all(new_fd, buf, n);
+            done += n;
+        }
+
+        for (int64_t i = 0; i < extra_len; i++) {
+            buf[i] = (uint8_t)rng();
+        }
+        gz_write(&extra_gz, buf, extra_len, Z_NO_FLUSH);
+        write_all(new_fd, buf, extra_len);
+
+        if (ctrl_len + 24 > ctrl_cap) {
+            ctrl_cap = ctrl_cap ? ctrl_cap * 2 : 4096;
+            ctrl = realloc(ctrl, ctrl_cap);
+            if (!ctrl) die("realloc");
+        }
+        offtout(diff_len, ctrl + ctrl_len);
+        offtout(extra_len, ctrl + ctrl_len + 8);
+        offtout(seek, ctrl + ctrl_len + 16);
+        ctrl_len += 24;
+
+        newpos += diff_len + extra_len;
+        oldpos += diff_len + seek;
+    }
+
+    gz_close(&diff_gz);
+    gz_close(&extra_gz);
+    close(diff_fd);
+    close(extra_fd);
+    close(new_fd);
+
+    snprintf(path, sizeof(path), "%s/patch", dir);
+    int patch_fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (patch_fd < 0) die(path);
+
+    static gz_writer ctrl_gz;
+    uint8_t header[32];
+    write_all(patch_fd, header, 32);  /* Placeholder, rewritten below */
+    gz_open(&ctrl_gz, patch_fd);
+    gz_write(&ctrl_gz, ctrl, ctrl_len, Z_NO_FLUSH);
+    gz_close(&ctrl_gz);
+
+    snprintf(path, sizeof(path), "%s/diff.tmp", dir);
+    append_file(patch_fd, path);
+    snprintf(path, sizeof(path), "%s/extra.tmp", dir);
+    append_file(patch_fd, path);
+
+    memcpy(header, "BSDIFF40", 8);
+    offtout(ctrl_gz.written, header + 8);
+    offtout(diff_gz.written, header + 16);
+    offtout(size, header + 24);
+    if (pwrite(patch_fd, header, 32, 0) != 32) die("pwrite");
+    close(patch_fd);
+
+    free(ctrl);
+    free(buf);
+    free(old);
+}
+
+/* ---- End-to-end apply ---- */
+
+typedef struct {
+    double seconds;
+    long max_rss_kb;
+    int result;
+} apply_run;
+
+/*
+ * Apply in a forked child, so its peak RSS is not polluted by the
+ * benchmark's own buffers.
+ */
+static apply_run run_apply(const char *old_path, const char *new_path,
+                           const char *patch_path, int digest, int checkpoint) {
+    apply_run run = { 0, 0, -100 };
+    int pipe_fd[2];
+    if (pipe(pipe_fd) != 0) die("pipe");
+
+    pid_t pid = fork();
+    if (pid < 0) die("fork");
+    if (pid == 0) {
+        uint8_t out[BSPATCH_DIGEST_MAX_SIZE];
+        bspatch_options options;
+        memset(&options, 0, sizeof(options));
+        options.digest = digest;
+        options.digest_out = out;
+
+        char checkpoint_path[4096];
+        if (snprintf(checkpoint_path, sizeof(checkpoint_path), "%s.ckpt", new_path) >=
+            (int)sizeof(checkpoint_path)) {
+            die("checkpoint path too long");
+        }
+
+        double start = now_sec();
+        int ret = checkpoint
+            ? bspatch_resume(old_path, new_path, patch_path, checkpoint_path, &options)
+            : bspatch_ex(old_path, new_path, patch_path, &options);
+        double elapsed = now_sec() - start;
+
+        write_all(pipe_fd[1], &elapsed, sizeof(elapsed));
+        _exit(ret == 0 ? 0 : 100 - ret);
+    }
+
+    close(pipe_fd[1]);
+    if (read(pipe_fd[0], &run.seconds, sizeof(run.seconds)) != sizeof(run.seconds)) {
+        run.seconds = 0;
+    }
+    close(pipe_fd[0]);
+
+    int status;
+    struct rusage usage;
+    if (wait4(pid, &status, 0, &usage) < 0) die("wait4");
+    run.max_rss_kb = usage.ru_maxrss;
+    run.result = WIFEXITED(status) && WEXITSTATUS(status) == 0
+        ? 0 : (WIFEXITED(status) ? 100 - WEXITSTATUS(status) : -100);
+    return run;
+}
+
+static apply_run best_apply(const char *old_path, const char *new_path,
+                            const char *patch_path, int digest, int checkpoint) {
+    apply_run best = { 0, 0, 0 };
+    for (int i = 0; i < RUNS; i++) {
+        apply_run run = run_apply(old_path, new_path, patch_path, digest, checkpoint);
+        if (run.result != 0) return run;
+        if (i == 0 || run.seconds < best.seconds) best.seconds = run.seconds;
+        if (run.max_rss_kb > best.max_rss_kb) best.max_rss_kb = run.max_rss_kb;
+    }
+    return best;
+}
+
+static int same_contents(const char *a, const char *b) {
+    static uint8_t buf_a[CHUNK], buf_b[CHUNK];
+    int fa = open(a, O_RDONLY), fb = open(b, O_RDONLY);
+    int same = fa >= 0 && fb >= 0;
+
+    while (same) {
+        ssize_t na = read(fa, buf_a, CHUNK);
+        ssize_t nb = read(fb, buf_b, CHUNK);
+        if (na != nb || na < 0) same = 0;
+        else if (na == 0) break;
+        else if (memcmp(buf_a, buf_b, na) != 0) same = 0;
+    }
+
+    if (fa >= 0) close(fa);
+    if (fb >= 0) close(fb);
+    return same;
+}
+
+/* Progress callback that cancels once the output reaches *user_data bytes */
+static int cancel_at(int64_t written, int64_t total, void *user_data) {
+    (void)total;
+    return written >= *(int64_t *)user_data;
+}
+
+/*
+ * Cancel bspatch_resume() at a quarter, half and three quarters of the
+ * output, resuming each time, then check the output and its digest.
+ */
+static int check_resume(const char *old_path, const char *new_path, const char *patch_path,
+                        const char *expected_path, int64_t new_size) {
+    char checkpoint_path[4096];
+    uint8_t expected[BSPATCH_DIGEST_MAX_SIZE], actual[BSPATCH_DIGEST_MAX_SIZE];
+    bspatch_options options;
+    if (snprintf(checkpoint_path, sizeof(checkpoint_path), "%s.ckpt", new_path) >=
+        (int)sizeof(checkpoint_path)) {
+        die("checkpoint path too long");
+    }
+
+    memset(&options, 0, sizeof(options));
+    options.digest = BSPATCH_DIGEST_SHA256;
+    options.digest_out = expected;
+    if (bspatch_ex(old_path, new_path, patch_path, &options) != 0) return 0;
+
+    int64_t cut = 0;
+    options.progress = cancel_at;
+    options.user_data = &cut;
+    options.digest_out = actual;
+    unlink(checkpoint_path);
+    for (int i = 1; i <= 3; i++) {
+        cut = new_size * i / 4;
+        if (bspatch_resume(old_path, new_path, patch_path, checkpoint_path, &options) != -13) {
+            return 0;
+        }
+    }
+    cut = INT64_MAX;
+    if (bspatch_resume(old_path, new_path, patch_path, checkpoint_path, &options) != 0) return 0;
+
+    size_t digest_size = bspatch_digest_size(BSPATCH_DIGEST_SHA256);
+    return access(checkpoint_path, F_OK) != 0 && memcmp(actual, expected, digest_size) == 0 &&
+           same_contents(new_path, expected_path);
+}
+
+/* ---- Stage benchmarks ---- */
+
+static int64_t offtin(const uint8_t *buf) {
+    int64_t y = buf[7] & 0x7F;
+    for (int i = 6; i >= 0; i--) {
+        y = y * 256 + buf[i];
+    }
+    return (buf[7] & 0x80) ? -y : y;
+}
+
+/* Inflate the diff block of a BSDIFF40 patch on one thread */
+static double bench_inflate(const char *patch_path, int64_t *out_bytes) {
+    uint8_t header[32];
+    static uint8_t in[64 * 1024], out[CHUNK];
+    int fd = open(patch_path, O_RDONLY);
+    if (fd < 0) die(patch_path);
+    if (pread(fd, header, 32, 0) != 32 || memcmp(header, "BSDIFF40", 8) != 0) {
+        close(fd);
+        *out_bytes = 0;
+        return 0;
+    }
+
+    off_t pos = 32 + offtin(header + 8);
+    off_t end = pos + offtin(header + 16);
+    z_stream strm;
+    memset(&strm, 0, sizeof(strm));
+    inflateInit2(&strm, 16 + MAX_WBITS);
+
+    double start = now_sec();
+    int ret = Z_OK;
+    while (ret != Z_STREAM_END) {
+        if (strm.avail_in == 0) {
+            size_t n = end - pos < (off_t)sizeof(in) ? (size_t)(end - pos) : sizeof(in);
+            if (n == 0 || pread(fd, in, n, pos) != (ssize_t)n) break;
+            pos += n;
+            strm.next_in = in;
+            strm.avail_in = n;
+        }
+        strm.next_out = out;
+        strm.avail_out = CHUNK;
+        ret = inflate(&strm, Z_NO_FLUSH);
+        if (ret != Z_OK && ret != Z_STREAM_END) break;
+    }
+    double elapsed = now_sec() - start;
+
+    *out_bytes = strm.total_out;
+    inflateEnd(&strm);
+    close(fd);
+    return elapsed;
+}
+
+static void scalar_add(uint8_t *dst, const uint8_t *src, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        dst[i] += src[i];
+    }
+}
+
+/* Time an add kernel over a cache-resident chunk, total bytes in all */
+static double bench_add(void (*kernel)(uint8_t *, const uint8_t *, size_t), int64_t total) {
+    static uint8_t dst[CHUNK], src[CHUNK];
+    for (size_t i = 0; i < CHUNK; i++) {
+        dst[i] = (uint8_t)rng();
+        src[i] = (uint8_t)rng();
+    }
+
+    double start = now_sec();
+    for (int64_t done = 0; done < total; done += CHUNK) {
+        kernel(dst, src, CHUNK);
+    }
+    double elapsed = now_sec() - start;
+
+    /* Keep the result observable */
+    volatile uint8_t sink = dst[rng() % CHUNK];
+    (void)sink;
+    return elapsed;
+}
+
+/* Write total bytes in bspatch-sized chunks, including the final fsync */
+static double bench_write(const char *dir, int64_t total) {
+    char path[4096];
+    static uint8_t buf[CHUNK];
+    snprintf(path, sizeof(path), "%s/write.tmp", dir);
+    int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) die(path);
+
+    double start = now_sec();
+    for (int64_t done = 0; done < total; done += CHUNK) {
+        size_t n = total - done < CHUNK ? (size_t)(total - done) : CHUNK;
+        write_all(fd, buf, n);
+    }
+    fsync(fd);
+    double elapsed = now_sec() - start;
+
+    close(fd);
+    unlink(path);
+    return elapsed;
+}
+
+static void report(const char *name, int64_t bytes, double seconds) {
+    printf("  %-26s %9.1f MB/s  (%.1f MB in %.3f s)\n",
+           name, seconds > 0 ? mb(bytes) / seconds : 0.0, mb(bytes), seconds);
+}
+
+static void usage(void) {
+    fprintf(stderr,
+            "usage: bspatch_bench [--size MB]\n"
+            "       bspatch_bench OLD NEW PATCH\n");
+    exit(2);
+}
+
+int main(int argc, char **argv) {
+    char dir[] = "/tmp/bspatch_bench.XXXXXX";
+    char old_path[4096], new_path[4096], patch_path[4096], out_path[4096];
+    int64_t synth_size = 64ll * 1024 * 1024;
+    int synthetic = 1;
+
+    if (argc == 3 && strcmp(argv[1], "--size") == 0) {
+        synth_size = atoll(argv[2]) * 1024 * 1024;
+        if (synth_size <= 0) usage();
+    } else if (argc == 4) {
+        synthetic = 0;
+    } else if (argc != 1) {
+        usage();
+    }
+
+    if (!mkdtemp(dir)) die("mkdtemp");
+
+    if (synthetic) {
+        snprintf(old_path, sizeof(old_path), "%s/old", dir);
+        snprintf(new_path, sizeof(new_path), "%s/new", dir);
+        snprintf(patch_path, sizeof(patch_path), "%s/patch", dir);
+
+        /* Generate in a child so the parent stays small for the RSS run */
+        pid_t pid = fork();
+        if (pid < 0) die("fork");
+        if (pid == 0) {
+            generate(dir, synth_size);
+            _exit(0);
+        }
+        int status;
+        waitpid(pid, &status, 0);
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) return 2;
+    } else {
+        snprintf(old_path, sizeof(old_path), "%s", argv[1]);
+        snprintf(new_path, sizeof(new_path), "%s", argv[2]);
+        snprintf(patch_path, sizeof(patch_path), "%s", argv[3]);
+    }
+    snprintf(out_path, sizeof(out_path), "%s/out", dir);
+
+    int64_t old_size = file_size(old_path);
+    int64_t new_size = file_size(new_path);
+    int64_t patch_size = file_size(patch_path);
+
+    printf("bspatch_bench (%s)\n", synthetic ? "synthetic" : "real pair");
+    printf("  old %.1f MB, new %.1f MB, patch %.1f MB, work mem %.2f MB\n",
+           mb(old_size), mb(new_size), mb(patch_size), mb(bspatch_work_mem_size()));
+
+    printf("apply (best of %d):\n", RUNS);
+    static const struct { const char *name; int digest; int checkpoint; } modes[] = {
+        { "apply", BSPATCH_DIGEST_NONE, 0 },
+        { "apply + md5", BSPATCH_DIGEST_MD5, 0 },
+        { "apply + sha256", BSPATCH_DIGEST_SHA256, 0 },
+        { "apply + checkpoints", BSPATCH_DIGEST_NONE, 1 },
+    };
+    long max_rss_kb = 0;
+    for (size_t i = 0; i < sizeof(modes) / sizeof(modes[0]); i++) {
+        apply_run run = best_apply(old_path, out_path, patch_path, modes[i].digest,
+                                   modes[i].checkpoint);
+        if (run.result != 0) {
+            printf("  %s failed: %d (%s)\n", modes[i].name, run.result, bspatch_strerror(run.result));
+            return 1;
+        }
+        report(modes[i].name, new_size, run.seconds);
+        if (run.max_rss_kb > max_rss_kb) max_rss_kb = run.max_rss_kb;
+    }
+    printf("  %-26s %9.1f MB\n", "peak RSS", max_rss_kb / 1024.0);
+
+    int ok = same_contents(out_path, new_path);
+    printf("  %-26s %s\n", "output matches new", ok ? "yes" : "NO");
+
+    int resumed = check_resume(old_path, out_path, patch_path, new_path, new_size);
+    printf("  %-26s %s\n", "resume after cancel", resumed ? "yes" : "NO");
+    ok = ok && resumed;
+
+    printf("stages (single thread):\n");
+    int64_t inflated;
+    double t = bench_inflate(patch_path, &inflated);
+    if (inflated > 0) report("inflate (diff block)", inflated, t);
+
+    int64_t add_total = 1024ll * 1024 * 1024;
+    report("diff-add (kernel)", add_total, bench_add(bspatch_add_bytes, add_total));
+    report("diff-add (scalar)", add_total, bench_add(scalar_add, add_total));
+    report("write + fsync", new_size, bench_write(dir, new_size));
+
+    unlink(out_path);
+    if (synthetic) {
+        unlink(old_path);
+        unlink(new_path);
+        unlink(patch_path);
+    }
+    rmdir(dir);
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,291 @@
+/*
+ * bspatch_fuzz.c - libFuzzer harness for bspatch parsing
+ *
+ * Default build: each input is used as a patch file against a small fixed
+ * old file. Inputs whose header claims an output larger than MAX_NEW_SIZE
+ * are skipped so the fuzzer spends its time on parsing rather than on
+ * writing large files.
+ *
+ * With BSPATCH_FUZZ_CHECKPOINT: setup applies a fixed patch with
+ * bspatch_resume() and cancels it part way, keeping a genuine checkpoint
+ * whose diff stream restarts mid-block. Each input is XORed over that
+ * checkpoint (bytes beyond its end are appended), the CRC is re-sealed so
+ * the mutation reaches the field checks rather than dying on the checksum,
+ * and bspatch_resume() runs against the result. The run is cancelled at
+ * the first progress callback, which is the restored position when the
+ * checkpoint is accepted, so each input costs the parse, the stream
+ * restore and the skip to the saved position.
+ */
+
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "bspatch.h"
+
+#ifdef BSPATCH_FUZZ_CHECKPOINT
+#include <zlib.h>
+#endif
+
+#define OLD_SIZE 4096
+#define MAX_NEW_SIZE (1 << 20)
+
+static char old_path[] = "/tmp/bspatch_fuzz_old.XXXXXX";
+static char patch_path[] = "/tmp/bspatch_fuzz_patch.XXXXXX";
+static char new_path[] = "/tmp/bspatch_fuzz_new.XXXXXX";
+static int patch_fd = -1;
+
+#ifndef BSPATCH_FUZZ_CHECKPOINT
+
+static int setup(void) {
+    uint8_t old[OLD_SIZE];
+    int fd = mkstemp(old_path);
+    if (fd < 0) return -1;
+    for (int i = 0; i < OLD_SIZE; i++) {
+        old[i] = (uint8_t)(i * 131 + 7);
+    }
+    if (write(fd, old, OLD_SIZE) != OLD_SIZE) return -1;
+    close(fd);
+
+    patch_fd = mkstemp(patch_path);
+    fd = mkstemp(new_path);
+    if (patch_fd < 0 || fd < 0) return -1;
+    close(fd);
+    return 0;
+}
+
+static int64_t offtin(const uint8_t *buf) {
+    int64_t y = buf[7] & 0x7F;
+    for (int i = 6; i >= 0; i--) {
+        y = y * 256 + buf[i];
+    }
+    return (buf[7] & 0x80) ? -y : y;
+}
+
+static int progress_cb(int64_t written, int64_t total, void *user_data) {
+    (void)user_data;
+    return written > total;  /* Never true; exercises the callback path */
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+    static int ready = 0;
+    if (!ready) {
+        if (setup() != 0) abort();
+        ready = 1;
+    }
+
+    if (size >= 32 && offtin(data + 24) > MAX_NEW_SIZE) return 0;
+
+    if (ftruncate(patch_fd, 0) != 0 || pwrite(patch_fd, data, size, 0) != (ssize_t)size) {
+        abort();
+    }
+
+    uint8_t digest[BSPATCH_DIGEST_MAX_SIZE];
+    bspatch_options options;
+    memset(&options, 0, sizeof(options));
+    options.progress = progress_cb;
+    options.progress_interval = 4096;
+    options.digest = BSPATCH_DIGEST_SHA256;
+    options.digest_out = digest;
+
+    bspatch_ex(old_path, new_path, patch_path, &options);
+    return 0;
+}
+
+#else /* BSPATCH_FUZZ_CHECKPOINT */
+
+/*
+ * One ctrl tuple: RESUME_DIFF bytes of diff then RESUME_EXTRA of extra. The
+ * template is cut at RESUME_CUT, past the diff stream's first restart point
+ * at 1 MB of inflated data.
+ */
+#define RESUME_DIFF (1536 * 1024)
+#define RESUME_EXTRA (64 * 1024)
+#define RESUME_NEW (RESUME_DIFF + RESUME_EXTRA)
+#define RESUME_CUT (1280 * 1024)
+#define RESUME_INTERVAL (256 * 1024)
+
+/* Offset of checkpoint_record.crc, asserted in bspatch.c */
+#define CHECKPOINT_CRC_OFFSET 12
+
+static char checkpoint_path[] = "/tmp/bspatch_fuzz_ckpt.XXXXXX";
+static uint8_t *template_data;    /* Checkpoint left by the cancelled setup run */
+static size_t template_len;
+static uint8_t *new_data;         /* Expected output, restored before each run */
+static uint8_t *scratch;
+
+static void offtout(int64_t x, uint8_t *buf) {
+    uint64_t y = x < 0 ? (uint64_t)-x : (uint64_t)x;
+    for (int i = 0; i < 8; i++) {
+        buf[i] = (uint8_t)(y >> (8 * i));
+    }
+    if (x < 0) buf[7] |= 0x80;
+}
+
+/* Append data as one gzip member; returns the compressed length or -1 */
+static int64_t write_gzip_block(int fd, const uint8_t *data, size_t len) {
+    z_stream strm;
+    uLong bound = compressBound((uLong)len) + 32;
+    uint8_t *out = malloc(bound);
+    int64_t n = -1;
+
+    memset(&strm, 0, sizeof(strm));
+    if (!out || deflateInit2(&strm, 6, Z_DEFLATED, 16 + MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+        free(out);
+        return -1;
+    }
+    strm.next_in = (uint8_t *)data;
+    strm.avail_in = (uInt)len;
+    strm.next_out = out;
+    strm.avail_out = (uInt)bound;
+    if (deflate(&strm, Z_FINISH) == Z_STREAM_END &&
+        write(fd, out, strm.total_out) == (ssize_t)strm.total_out) {
+        n = (int64_t)strm.total_out;
+    }
+    deflateEnd(&strm);
+    free(out);
+    return n;
+}
+
+static int write_file(const char *path, const uint8_t *data, size_t len) {
+    int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) return -1;
+    int failed = write(fd, data, len) != (ssize_t)len;
+    if (close(fd) != 0) failed = 1;
+    return failed ? -1 : 0;
+}
+
+static int cancel_at_cut(int64_t written, int64_t total, void *user_data) {
+    (void)total;
+    (void)user_data;
+    return written >= RESUME_CUT;
+}
+
+static int cancel_at_once(int64_t written, int64_t total, void *user_data) {
+    (void)written;
+    (void)total;
+    (void)user_data;
+    return 1;
+}
+
+static void init_options(bspatch_options *options, bspatch_progress_fn progress,
+                         uint8_t *digest) {
+    memset(options, 0, sizeof(*options));
+    options->progress = progress;
+    options->progress_interval = RESUME_INTERVAL;
+    options->digest = BSPATCH_DIGEST_SHA256;
+    options->digest_out = digest;
+    options->checkpoint_interval = RESUME_INTERVAL;
+}
+
+static int setup(void) {
+    uint8_t *old = malloc(RESUME_DIFF);
+    uint8_t *diff = calloc(1, RESUME_DIFF);
+    uint8_t header[32], ctrl[24];
+    uint8_t digest[BSPATCH_DIGEST_MAX_SIZE];
+    bspatch_options options;
+    int fd;
+
+    new_data = malloc(RESUME_NEW);
+    scratch = malloc(RESUME_NEW);
+    if (!old || !diff || !new_data || !scratch) return -1;
+
+    /*
+     * Incompressible old file and a sparse diff, so the patch stays small
+     * yet deflate still ends blocks often enough to leave restart points
+     */
+    uint32_t x = 0x9E3779B9u;
+    for (size_t i = 0; i < RESUME_DIFF; i++) {
+        x = x * 1664525u + 1013904223u;
+        old[i] = (uint8_t)(x >> 24);
+        if (i % 16 == 0) diff[i] = (uint8_t)(x >> 16);
+        new_data[i] = (uint8_t)(old[i] + diff[i]);
+    }
+    for (size_t i = RESUME_DIFF; i < RESUME_NEW; i++) {
+        new_data[i] = (uint8_t)(i * 131 + 7);
+    }
+
+    fd = mkstemp(old_path);
+    if (fd < 0 || write(fd, old, RESUME_DIFF) != RESUME_DIFF) return -1;
+    close(fd);
+
+    /* Ctrl block length goes in the header, so write it after the blocks */
+    patch_fd = mkstemp(patch_path);
+    if (patch_fd < 0 || lseek(patch_fd, sizeof(header), SEEK_SET) < 0) return -1;
+    offtout(RESUME_DIFF, ctrl);
+    offtout(RESUME_EXTRA, ctrl + 8);
+    offtout(0, ctrl + 16);
+    int64_t ctrl_len = write_gzip_block(patch_fd, ctrl, sizeof(ctrl));
+    int64_t diff_len = write_gzip_block(patch_fd, diff, RESUME_DIFF);
+    if (ctrl_len < 0 || diff_len < 0 ||
+        write_gzip_block(patch_fd, new_data + RESUME_DIFF, RESUME_EXTRA) < 0) {
+        return -1;
+    }
+    memcpy(header, "BSDIFF40", 8);
+    offtout(ctrl_len, header + 8);
+    offtout(diff_len, header + 16);
+    offtout(RESUME_NEW, header + 24);
+    if (pwrite(patch_fd, header, sizeof(header), 0) != (ssize_t)sizeof(header)) return -1;
+    free(old);
+    free(diff);
+
+    fd = mkstemp(new_path);
+    if (fd < 0) return -1;
+    close(fd);
+    fd = mkstemp(checkpoint_path);
+    if (fd < 0) return -1;
+    close(fd);
+
+    init_options(&options, cancel_at_cut, digest);
+    if (bspatch_resume(old_path, new_path, patch_path, checkpoint_path, &options) != -13) {
+        return -1;
+    }
+
+    fd = open(checkpoint_path, O_RDONLY);
+    if (fd < 0) return -1;
+    template_data = malloc(RESUME_NEW);
+    ssize_t n = template_data ? read(fd, template_data, RESUME_NEW) : -1;
+    close(fd);
+    if (n <= CHECKPOINT_CRC_OFFSET + 4) return -1;
+    template_len = (size_t)n;
+    return 0;
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+    static int ready = 0;
+    if (!ready) {
+        if (setup() != 0) abort();
+        ready = 1;
+    }
+
+    size_t len = size > template_len ? size : template_len;
+    if (len > RESUME_NEW) return 0;
+    memcpy(scratch, template_data, template_len);
+    if (len > template_len) {
+        memcpy(scratch + template_len, data + template_len, len - template_len);
+    }
+    for (size_t i = 0; i < size && i < template_len; i++) {
+        scratch[i] ^= data[i];
+    }
+
+    memset(scratch + CHECKPOINT_CRC_OFFSET, 0, 4);
+    uint32_t crc = (uint32_t)crc32(0, scratch, (uInt)len);
+    memcpy(scratch + CHECKPOINT_CRC_OFFSET, &crc, 4);
+
+    /* A previous run may have truncated or rewritten the output */
+    if (write_file(new_path, new_data, RESUME_NEW) != 0 ||
+        write_file(checkpoint_path, scratch, len) != 0) {
+        abort();
+    }
+
+    uint8_t digest[BSPATCH_DIGEST_MAX_SIZE];
+    bspatch_options options;
+    init_options(&options, cancel_at_once, digest);
+    bspatch_resume(old_path, new_path, patch_path, checkpoint_path, &options);
+    return 0;
+}
+
+#endif /* BSPATCH_FUZZ_CHECKPOINT */
@@ -14,16 +14,90 @@
  */
 
 #include "bspatch.h"
+#include "bspatch_kernel.h"
+#include "digest.h"
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
+#include <stdint.h>
+#include <errno.h>
 #include <fcntl.h>
+#include <pthread.h>
 #include <unistd.h>
 #include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
 #include <zlib.h>
 
-/* BSDIFF header magic */
+#ifdef BSPATCH_HAVE_ZSTD
+#define ZSTD_STATIC_LINKING_ONLY  /* ZSTD_createDStream_advanced */
+#include <zstd.h>
+#include <zstd_errors.h>
+#endif
+
+/*
+ * BSDIFF header magics.
+ *
+ * BSDIFF40 is the classic 32-byte header with gzip-compressed blocks.
+ * BSDIFF41 appends an 8-byte codec id (same encoding as the other header
+ * fields) giving a 40-byte header; all three blocks use that codec.
+ */
 static const char BSDIFF_MAGIC[] = "BSDIFF40";
+static const char BSDIFF41_MAGIC[] = "BSDIFF41";
+
+#define BSDIFF40_HEADER_SIZE 32
+#define BSDIFF41_HEADER_SIZE 40
+
+/* Block codec ids carried in a BSDIFF41 header */
+enum {
+    BSPATCH_CODEC_GZIP = 0,
+    BSPATCH_CODEC_ZSTD = 1,
+};
+
+/*
+ * Streaming buffer sizes. Peak memory of bspatch() is these plus the inflate
+ * rings below and zlib's per-stream window, independent of the file sizes.
+ */
+#define BSPATCH_IN_CHUNK  (64 * 1024)
+#define BSPATCH_OUT_CHUNK (256 * 1024)
+
+/*
+ * Ring buffer sizes for the pipelined inflate workers. Ctrl tuples are
+ * tiny; diff and extra get enough slack to absorb scheduling jitter.
+ */
+#define BSPATCH_CTRL_RING (64 * 1024)
+#define BSPATCH_DATA_RING (1024 * 1024)
+
+/* Per-stream zlib allocation: inflate state plus the 32 KB window */
+#define BSPATCH_ZLIB_MEM (48 * 1024)
+
+/* Default output interval between progress callbacks */
+#define BSPATCH_PROGRESS_INTERVAL (1024 * 1024)
+
+/* How much of the old file to prefetch when a ctrl tuple seeks into it */
+#define BSPATCH_OLD_READAHEAD (2 * 1024 * 1024)
+
+/* Default output interval between bspatch_resume() checkpoints */
+#define BSPATCH_CHECKPOINT_INTERVAL (4 * 1024 * 1024)
+
+/* Output bytes before the checkpoint position whose CRC a checkpoint keeps */
+#define BSPATCH_CHECKPOINT_TAIL (64 * 1024)
+_Static_assert(BSPATCH_CHECKPOINT_TAIL <= BSPATCH_OUT_CHUNK, "tail is read back into ctx->out");
+
+/*
+ * Restart points for resuming a gzip block mid-stream: one is taken every
+ * BSPATCH_POINT_SPAN inflated bytes, and the last BSPATCH_POINT_SLOTS are
+ * kept. A worker runs at most one ring (<= BSPATCH_POINT_SPAN) ahead of
+ * the apply loop, so at least one kept point is always behind it.
+ */
+#define BSPATCH_POINT_SPAN (1024 * 1024)
+#define BSPATCH_POINT_SLOTS 4
+#define BSPATCH_WINDOW_SIZE (32 * 1024)
+
+/* Longest checkpoint path bspatch_resume() reserves room for */
+#define BSPATCH_PATH_MAX 4096
+
+static const char BSPATCH_CHECKPOINT_MAGIC[] = "BSPCKPT1";
 
 /* Error messages */
 static const char* error_messages[] = {
@@ -38,7 +112,10 @@ static const char* error_messages[] = {
     "Cannot decompress extra block",
     "Cannot create new file",
     "Memory allocation failed",
-    "Corrupt patch"
+    "Corrupt patch",
+    "Unsupported patch compression",
+    "Cancelled",
+    "Cannot write checkpoint"
 };
 
 const char* bspatch_strerror(int error_code) {
@@ -51,7 +128,7 @@ const char* bspatch_strerror(int error_code) {
 }
 
 /* Read 8-byte signed integer (little-endian) */
-static int64_t offtin(uint8_t *buf) {
+static int64_t offtin(const uint8_t *buf) {
     int64_t y;
 
     y = buf[7] & 0x7F;
@@ -68,268 +145,1425 @@ static int64_t offtin(uint8_t *buf) {
     return y;
 }
 
-/* Decompress gzip data */
-static int decompress_gzip(uint8_t *in, size_t in_len, uint8_t **out, size_t *out_len) {
+/* pread() that retries on short reads and EINTR */
+static int pread_full(int fd, uint8_t *buf, size_t len, off_t offset) {
+    while (len > 0) {
+        ssize_t n = pread(fd, buf, len, offset);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        if (n == 0) return -1;  /* Unexpected end of file */
+        buf += n;
+        len -= n;
+        offset += n;
+    }
+    return 0;
+}
+
+/* write() that retries on short writes and EINTR */
+static int write_full(int fd, const uint8_t *buf, size_t len) {
+    while (len > 0) {
+        ssize_t n = write(fd, buf, len);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        buf += n;
+        len -= n;
+    }
+    return 0;
+}
+
+/*
+ * Bump allocator over the single block of working memory of one patch.
+ *
+ * The context, the inflate rings and zlib's state/windows are all carved
+ * from it, so applying a patch costs one allocation (none if the caller
+ * passes bspatch_options.work_mem) and nothing is allocated or grown once
+ * the apply loop runs. zstd allocates its buffers lazily from the worker
+ * threads, hence the lock.
+ *
+ * Only the block bspatch_apply() allocated itself may spill to the heap
+ * (zstd's window depends on the patch); caller memory running out is an
+ * error instead.
+ */
+typedef struct {
+    uint8_t *base;
+    size_t size;
+    size_t used;
+    int heap_fallback;
+    pthread_mutex_t lock;
+} bspatch_arena;
+
+#define ARENA_ALIGN(n) (((n) + 15) & ~(size_t)15)
+
+static void arena_init(bspatch_arena *a, void *mem, size_t size, int heap_fallback) {
+    uintptr_t p = (uintptr_t)mem;
+    uintptr_t aligned = ARENA_ALIGN(p);
+
+    a->base = (uint8_t *)aligned;
+    a->size = size > aligned - p ? size - (aligned - p) : 0;
+    a->used = 0;
+    a->heap_fallback = heap_fallback;
+    pthread_mutex_init(&a->lock, NULL);
+}
+
+static void *arena_alloc(bspatch_arena *a, size_t n) {
+    void *p = NULL;
+
+    n = ARENA_ALIGN(n);
+    pthread_mutex_lock(&a->lock);
+    if (a->size - a->used >= n) {
+        p = a->base + a->used;
+        a->used += n;
+    }
+    pthread_mutex_unlock(&a->lock);
+    return p;
+}
+
+/* Allocation for the decoders: the arena, then the heap if allowed */
+static void *arena_decoder_alloc(bspatch_arena *a, size_t n) {
+    void *p = arena_alloc(a, n);
+    return p || !a->heap_fallback ? p : malloc(n);
+}
+
+static void arena_decoder_free(bspatch_arena *a, void *ptr) {
+    uintptr_t p = (uintptr_t)ptr;
+
+    /* Arena memory is released all at once by the owner */
+    if (p < (uintptr_t)a->base || p >= (uintptr_t)a->base + a->size) {
+        free(ptr);
+    }
+}
+
+#ifdef BSPATCH_HAVE_ZSTD
+static void *arena_zstd_alloc(void *opaque, size_t size) {
+    return arena_decoder_alloc(opaque, size);
+}
+
+static void arena_zstd_free(void *opaque, void *address) {
+    arena_decoder_free(opaque, address);
+}
+#endif
+
+/*
+ * A place a block can be decoded from without inflating what precedes it.
+ *
+ * out == 0 is the start of the block, where decoding begins with the gzip
+ * header as usual. Other points sit on deflate block boundaries: decoding
+ * resumes as raw deflate at bit offset (in * 8 - bits), primed with the
+ * sliding window that preceded the point (zlib's zran technique).
+ */
+typedef struct {
+    int64_t out;            /* Inflated offset of the point; -1 if unused */
+    int64_t in;             /* Patch file offset of the next compressed byte */
+    int bits;               /* Low bits of byte in - 1 still to be decoded */
+    unsigned window_len;
+    uint8_t *window;        /* BSPATCH_WINDOW_SIZE bytes */
+} access_point;
+
+/*
+ * One compressed block of the patch file (gzip, or zstd when built with
+ * BSPATCH_HAVE_ZSTD), decoded on demand.
+ *
+ * The compressed bytes are pulled from the patch file with pread() in
+ * BSPATCH_IN_CHUNK pieces, so only a small window of each block is ever
+ * resident no matter how large the patch is.
+ *
+ * When started with block_stream_start(), a worker thread inflates the
+ * block ahead of the apply loop into a bounded ring buffer, so the three
+ * blocks decompress concurrently with each other and with diff-add/write.
+ * The ring has exactly one producer (the worker) and one consumer (the
+ * apply loop); each side works on its contiguous span outside the lock.
+ */
+typedef struct {
+    int codec;
     z_stream strm;
-    uint8_t *buf = NULL;
-    size_t buf_len = in_len * 4;  /* Initial guess */
-    int ret;
+    bspatch_arena *arena;
+    uint8_t *zmem;          /* BSPATCH_ZLIB_MEM reserved for zlib */
+    size_t zmem_used;
+#ifdef BSPATCH_HAVE_ZSTD
+    ZSTD_DStream *zstd;
+#endif
+    int fd;
+    off_t in_pos;           /* Next compressed byte to read */
+    off_t in_end;           /* End of this block in the patch file */
+    int initialized;
+    int finished;           /* End of the compressed stream seen */
+    uint8_t in[BSPATCH_IN_CHUNK];
+    size_t in_len;          /* Valid bytes in in[] */
+    size_t in_used;         /* Bytes of in[] already consumed */
 
-    /* Allocate initial buffer */
-    buf = malloc(buf_len);
-    if (!buf) return -1;
+    /* Pipelined mode */
+    int threaded;
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t not_empty;
+    pthread_cond_t not_full;
+    uint8_t *ring;
+    size_t ring_size;
+    size_t ring_head;       /* Consumer position */
+    size_t ring_count;      /* Bytes available to the consumer */
+    int ring_eof;           /* Worker reached the end of the block */
+    int ring_error;         /* Worker's block_inflate() error, or 0 */
+    int ring_stop;          /* Consumer is shutting the worker down */
 
-    /* Initialize zlib stream */
-    memset(&strm, 0, sizeof(strm));
-    strm.next_in = in;
-    strm.avail_in = in_len;
+    /* Resume support: restart points taken by whoever runs the decoder */
+    int64_t inflated;       /* Decoded so far, as an offset into the block */
+    int64_t consumed;       /* Handed to the apply loop so far */
+    off_t in_start;         /* Start of this block in the patch file */
+    access_point *points;   /* BSPATCH_POINT_SLOTS, or NULL when not tracking */
+    int next_slot;          /* Slot the next point overwrites */
+    int64_t next_point;     /* Take a point at the first boundary past this */
+} block_stream;
 
-    /* Use inflateInit2 with 16+MAX_WBITS for gzip format */
-    ret = inflateInit2(&strm, 16 + MAX_WBITS);
-    if (ret != Z_OK) {
-        free(buf);
-        return -1;
+/*
+ * zlib allocator hooks. The state and the window, which inflate allocates
+ * lazily on the worker thread, come from the stream's own reservation, so
+ * they never compete with the rings for the arena.
+ */
+static voidpf block_stream_zalloc(voidpf opaque, uInt items, uInt size) {
+    block_stream *bs = opaque;
+    size_t n = ARENA_ALIGN((size_t)items * size);
+
+    if (BSPATCH_ZLIB_MEM - bs->zmem_used >= n) {
+        void *p = bs->zmem + bs->zmem_used;
+        bs->zmem_used += n;
+        return p;
     }
+    return arena_decoder_alloc(bs->arena, n);
+}
 
-    /* Decompress */
-    size_t total_out = 0;
-    do {
-        /* Expand buffer if needed */
-        if (total_out >= buf_len) {
-            buf_len *= 2;
-            uint8_t *new_buf = realloc(buf, buf_len);
-            if (!new_buf) {
-                free(buf);
-                inflateEnd(&strm);
-                return -1;
-            }
-            buf = new_buf;
-        }
+static void block_stream_zfree(voidpf opaque, voidpf ptr) {
+    block_stream *bs = opaque;
+    arena_decoder_free(bs->arena, ptr);
+}
 
-        strm.next_out = buf + total_out;
-        strm.avail_out = buf_len - total_out;
+/* Mark a stream as holding no resources, so it is always safe to close */
+static void block_stream_init(block_stream *bs) {
+    bs->initialized = 0;
+    bs->threaded = 0;
+    bs->points = NULL;
+}
 
-        ret = inflate(&strm, Z_NO_FLUSH);
-        if (ret != Z_OK && ret != Z_STREAM_END) {
-            free(buf);
-            inflateEnd(&strm);
+/*
+ * Keep restart points for this block, so the apply loop can checkpoint it.
+ * Call before block_stream_open().
+ */
+static int block_stream_track(block_stream *bs, bspatch_arena *arena) {
+    bs->points = arena_alloc(arena, BSPATCH_POINT_SLOTS * sizeof(access_point));
+    if (!bs->points) return -1;
+    for (int i = 0; i < BSPATCH_POINT_SLOTS; i++) {
+        bs->points[i].out = -1;
+        bs->points[i].window = arena_alloc(arena, BSPATCH_WINDOW_SIZE);
+        if (!bs->points[i].window) return -1;
+    }
+    return 0;
+}
+
+/*
+ * Prepare to decode length bytes at offset in the patch file, from the
+ * start of the block or, if at is not NULL, from that restart point.
+ * Returns -1 if the decoder cannot be set up, -10 if its memory does not
+ * fit, -12 if the codec is not built in.
+ */
+static int block_stream_open(block_stream *bs, bspatch_arena *arena, int codec,
+                             int fd, off_t offset, off_t length,
+                             const access_point *at) {
+    int raw = at && at->out > 0;
+
+    bs->codec = codec;
+    bs->fd = fd;
+    bs->in_start = offset;
+    bs->in_pos = raw ? at->in : offset;
+    bs->in_end = offset + length;
+    bs->in_len = 0;
+    bs->in_used = 0;
+    bs->finished = 0;
+    bs->inflated = raw ? at->out : 0;
+    bs->consumed = bs->inflated;
+
+    /* The point decoding starts from is the first one kept */
+    if (bs->points) {
+        access_point *p = &bs->points[0];
+        p->out = bs->inflated;
+        p->in = bs->in_pos;
+        p->bits = raw ? at->bits : 0;
+        p->window_len = raw ? at->window_len : 0;
+        if (raw) memcpy(p->window, at->window, at->window_len);
+        bs->next_slot = 1;
+        bs->next_point = bs->inflated + BSPATCH_POINT_SPAN;
+    }
+
+    switch (codec) {
+    case BSPATCH_CODEC_GZIP:
+        break;
+#ifdef BSPATCH_HAVE_ZSTD
+    case BSPATCH_CODEC_ZSTD:
+        break;
+#endif
+    default:
+        return -12;  /* Unsupported patch compression */
+    }
+
+    /* An empty block (no extra data) is valid and simply yields nothing */
+    if (length == 0) {
+        bs->finished = 1;
+        return 0;
+    }
+
+#ifdef BSPATCH_HAVE_ZSTD
+    if (codec == BSPATCH_CODEC_ZSTD) {
+        if (raw) return -1;  /* No restart points inside zstd frames */
+        ZSTD_customMem mem = { arena_zstd_alloc, arena_zstd_free, arena };
+        bs->zstd = ZSTD_createDStream_advanced(mem);
+        if (!bs->zstd) return -10;
+        ZSTD_initDStream(bs->zstd);
+        bs->initialized = 1;
+        return 0;
+    }
+#endif
+
+    /*
+     * Use inflateInit2 with 16+MAX_WBITS for gzip format; a restart point
+     * is past the gzip header, so decoding continues as raw deflate.
+     */
+    bs->arena = arena;
+    bs->zmem = arena_alloc(arena, BSPATCH_ZLIB_MEM);
+    bs->zmem_used = 0;
+    if (!bs->zmem) return -10;
+
+    memset(&bs->strm, 0, sizeof(bs->strm));
+    bs->strm.zalloc = block_stream_zalloc;
+    bs->strm.zfree = block_stream_zfree;
+    bs->strm.opaque = bs;
+    int ret = inflateInit2(&bs->strm, raw ? -MAX_WBITS : 16 + MAX_WBITS);
+    if (ret != Z_OK) {
+        return ret == Z_MEM_ERROR ? -10 : -1;
+    }
+    bs->initialized = 1;
+
+    if (raw) {
+        uint8_t partial;
+        if (at->bits > 0 &&
+            (pread_full(fd, &partial, 1, at->in - 1) != 0 ||
+             inflatePrime(&bs->strm, at->bits, partial >> (8 - at->bits)) != Z_OK)) {
+            return -1;
+        }
+        if (inflateSetDictionary(&bs->strm, at->window, at->window_len) != Z_OK) {
             return -1;
         }
+    }
+    return 0;
+}
 
-        total_out = strm.total_out;
-    } while (ret != Z_STREAM_END);
+/*
+ * Record the deflate block boundary the decoder just stopped at as a
+ * restart point. Runs on whichever thread decodes the block.
+ */
+static void block_stream_mark(block_stream *bs) {
+    access_point *p = &bs->points[bs->next_slot];
+    unsigned window_len = BSPATCH_WINDOW_SIZE;
+
+    if (bs->threaded) pthread_mutex_lock(&bs->lock);
+    if (inflateGetDictionary(&bs->strm, p->window, &window_len) == Z_OK) {
+        p->out = bs->inflated;
+        p->in = bs->in_pos - (off_t)(bs->in_len - bs->in_used);
+        p->bits = bs->strm.data_type & 7;
+        p->window_len = window_len;
+        bs->next_slot = (bs->next_slot + 1) % BSPATCH_POINT_SLOTS;
+    }
+    if (bs->threaded) pthread_mutex_unlock(&bs->lock);
+
+    bs->next_point = bs->inflated + BSPATCH_POINT_SPAN;
+}
 
-    inflateEnd(&strm);
+/* Refill in[] from the patch file once it has been fully consumed */
+static int block_refill(block_stream *bs) {
+    if (bs->in_used < bs->in_len) return 0;
 
-    *out = buf;
-    *out_len = total_out;
+    off_t left = bs->in_end - bs->in_pos;
+    if (left <= 0) return -1;  /* Truncated block */
+
+    size_t n = left < BSPATCH_IN_CHUNK ? (size_t)left : BSPATCH_IN_CHUNK;
+    if (pread_full(bs->fd, bs->in, n, bs->in_pos) != 0) return -1;
+    bs->in_pos += n;
+    bs->in_len = n;
+    bs->in_used = 0;
     return 0;
 }
 
-/* Read entire file into memory */
-static int read_file(const char *path, uint8_t **data, size_t *size) {
-    FILE *f = fopen(path, "rb");
-    if (!f) return -1;
+/*
+ * Decode from in[] into *dst, advancing both; zlib flavour. When a restart
+ * point is due, inflate stops at the next deflate block boundary for it.
+ */
+static int gzip_decode(block_stream *bs, uint8_t **dst, size_t *left) {
+    int flush = bs->points && bs->inflated >= bs->next_point ? Z_BLOCK : Z_NO_FLUSH;
 
-    fseek(f, 0, SEEK_END);
-    *size = ftell(f);
-    fseek(f, 0, SEEK_SET);
+    bs->strm.next_in = bs->in + bs->in_used;
+    bs->strm.avail_in = bs->in_len - bs->in_used;
+    bs->strm.next_out = *dst;
+    bs->strm.avail_out = *left;
 
-    *data = malloc(*size);
-    if (!*data) {
-        fclose(f);
-        return -1;
+    int ret = inflate(&bs->strm, flush);
+
+    bs->in_used = bs->in_len - bs->strm.avail_in;
+    bs->inflated += *left - bs->strm.avail_out;
+    *dst = bs->strm.next_out;
+    *left = bs->strm.avail_out;
+
+    if (ret == Z_STREAM_END) {
+        bs->finished = 1;
+    } else if (ret != Z_OK) {
+        return ret == Z_MEM_ERROR ? -10 : -1;
+    } else if (flush == Z_BLOCK && (bs->strm.data_type & 128) &&
+               !(bs->strm.data_type & 64)) {
+        block_stream_mark(bs);
     }
+    return 0;
+}
 
-    if (fread(*data, 1, *size, f) != *size) {
-        free(*data);
-        fclose(f);
-        return -1;
+#ifdef BSPATCH_HAVE_ZSTD
+/* Decode from in[] into *dst, advancing both; zstd flavour */
+static int zstd_decode(block_stream *bs, uint8_t **dst, size_t *left) {
+    ZSTD_inBuffer in = { bs->in, bs->in_len, bs->in_used };
+    ZSTD_outBuffer out = { *dst, *left, 0 };
+
+    size_t ret = ZSTD_decompressStream(bs->zstd, &out, &in);
+    if (ZSTD_isError(ret)) {
+        return ZSTD_getErrorCode(ret) == ZSTD_error_memory_allocation ? -10 : -1;
     }
 
-    fclose(f);
+    bs->in_used = in.pos;
+    bs->inflated += out.pos;
+    *dst += out.pos;
+    *left -= out.pos;
+
+    /* A frame ended and there is no further frame in this block */
+    if (ret == 0 && bs->in_used == bs->in_len && bs->in_pos == bs->in_end) {
+        bs->finished = 1;
+    }
     return 0;
 }
+#endif
+
+/*
+ * Decode up to len bytes from the block into dst. *produced is set to the
+ * number of bytes written, which is less than len only at the block end.
+ * Returns -10 if the decoder ran out of memory, -1 on any other error.
+ */
+static int block_inflate(block_stream *bs, uint8_t *dst, size_t len, size_t *produced) {
+    size_t left = len;
+    int ret;
 
-/* Write data to file */
-static int write_file(const char *path, uint8_t *data, size_t size) {
-    FILE *f = fopen(path, "wb");
-    if (!f) return -1;
+    while (left > 0 && !bs->finished) {
+        if (block_refill(bs) != 0) return -1;
 
-    if (fwrite(data, 1, size, f) != size) {
-        fclose(f);
-        return -1;
+#ifdef BSPATCH_HAVE_ZSTD
+        if (bs->codec == BSPATCH_CODEC_ZSTD) {
+            if ((ret = zstd_decode(bs, &dst, &left)) != 0) return ret;
+            continue;
+        }
+#endif
+        if ((ret = gzip_decode(bs, &dst, &left)) != 0) return ret;
     }
 
-    fclose(f);
+    *produced = len - left;
     return 0;
 }
 
-int bspatch(const char *old_path, const char *new_path, const char *patch_path) {
-    FILE *f;
-    uint8_t header[32];
-    uint8_t *old = NULL;
-    uint8_t *new_data = NULL;
-    uint8_t *patch = NULL;
-    size_t oldsize, newsize, patchsize;
-    size_t bzctrllen, bzdatalen, bzdatalen_extra;
-    uint8_t *ctrl = NULL, *diff = NULL, *extra = NULL;
-    size_t ctrllen, difflen, extralen;
-    int64_t ctrl_tuple[3];
-    int64_t oldpos = 0, newpos = 0;
-    int ret = 0;
+/* Worker thread: keep the ring topped up until the block ends */
+static void *block_stream_worker(void *arg) {
+    block_stream *bs = arg;
+    int error = 0;
+
+    pthread_mutex_lock(&bs->lock);
+    while (!bs->ring_stop && !bs->finished) {
+        while (bs->ring_count == bs->ring_size && !bs->ring_stop) {
+            pthread_cond_wait(&bs->not_full, &bs->lock);
+        }
+        if (bs->ring_stop) break;
+
+        /*
+         * Contiguous free span after the data already in the ring, capped
+         * so the consumer sees each piece as soon as it is inflated rather
+         * than waiting for the whole free space to fill.
+         */
+        size_t tail = (bs->ring_head + bs->ring_count) % bs->ring_size;
+        size_t span = bs->ring_size - bs->ring_count;
+        if (span > bs->ring_size - tail) span = bs->ring_size - tail;
+        if (span > BSPATCH_OUT_CHUNK) span = BSPATCH_OUT_CHUNK;
+        pthread_mutex_unlock(&bs->lock);
 
-    /* Read old file */
-    if (read_file(old_path, &old, &oldsize) != 0) {
-        return -1;  /* Cannot open old file */
+        size_t produced = 0;
+        error = block_inflate(bs, bs->ring + tail, span, &produced);
+
+        pthread_mutex_lock(&bs->lock);
+        if (error != 0) break;
+        bs->ring_count += produced;
+        pthread_cond_signal(&bs->not_empty);
     }
+    if (error != 0) bs->ring_error = error;
+    bs->ring_eof = 1;
+    pthread_cond_signal(&bs->not_empty);
+    pthread_mutex_unlock(&bs->lock);
+
+    return NULL;
+}
 
-    /* Read patch file */
-    if (read_file(patch_path, &patch, &patchsize) != 0) {
-        free(old);
-        return -3;  /* Cannot open patch file */
+/*
+ * Move the block to a worker thread with a ring of ring_size bytes taken
+ * from the arena. If either is unavailable the block keeps inflating on
+ * the caller.
+ */
+static void block_stream_start(block_stream *bs, bspatch_arena *arena, size_t ring_size) {
+    if (bs->finished || ring_size == 0) return;  /* Nothing to inflate */
+
+    bs->ring = arena_alloc(arena, ring_size);
+    if (!bs->ring) return;
+    bs->ring_size = ring_size;
+    bs->ring_head = 0;
+    bs->ring_count = 0;
+    bs->ring_eof = 0;
+    bs->ring_error = 0;
+    bs->ring_stop = 0;
+    pthread_mutex_init(&bs->lock, NULL);
+    pthread_cond_init(&bs->not_empty, NULL);
+    pthread_cond_init(&bs->not_full, NULL);
+
+    /* Set before the worker runs: it locks around restart points by it */
+    bs->threaded = 1;
+    if (pthread_create(&bs->thread, NULL, block_stream_worker, bs) != 0) {
+        pthread_cond_destroy(&bs->not_full);
+        pthread_cond_destroy(&bs->not_empty);
+        pthread_mutex_destroy(&bs->lock);
+        bs->ring = NULL;
+        bs->threaded = 0;
     }
+}
+
+/* Take exactly len bytes from the worker's ring */
+static int ring_read(block_stream *bs, uint8_t *dst, size_t len) {
+    pthread_mutex_lock(&bs->lock);
+    while (len > 0) {
+        while (bs->ring_count == 0 && !bs->ring_eof) {
+            pthread_cond_wait(&bs->not_empty, &bs->lock);
+        }
+        if (bs->ring_count == 0) {
+            /* Worker is done: either it failed or the block is too short */
+            int error = bs->ring_error ? bs->ring_error : -1;
+            pthread_mutex_unlock(&bs->lock);
+            return error;
+        }
 
-    /* Check patch size */
-    if (patchsize < 32) {
-        free(old);
-        free(patch);
-        return -4;  /* Invalid patch header */
+        size_t span = bs->ring_count;
+        if (span > bs->ring_size - bs->ring_head) span = bs->ring_size - bs->ring_head;
+        if (span > len) span = len;
+        pthread_mutex_unlock(&bs->lock);
+
+        memcpy(dst, bs->ring + bs->ring_head, span);
+        dst += span;
+        len -= span;
+
+        pthread_mutex_lock(&bs->lock);
+        bs->ring_head = (bs->ring_head + span) % bs->ring_size;
+        bs->ring_count -= span;
+        pthread_cond_signal(&bs->not_full);
     }
+    pthread_mutex_unlock(&bs->lock);
+    return 0;
+}
 
-    /* Parse header */
-    memcpy(header, patch, 32);
+/*
+ * Read exactly len bytes of inflated data from the block into dst. Returns
+ * -10 if the decoder ran out of memory, -1 on any other error.
+ */
+static int block_stream_read(block_stream *bs, uint8_t *dst, size_t len) {
+    bs->consumed += len;
+    if (bs->threaded) return ring_read(bs, dst, len);
 
-    /* Check magic */
-    if (memcmp(header, BSDIFF_MAGIC, 8) != 0) {
-        free(old);
-        free(patch);
-        return -4;  /* Invalid patch header */
+    size_t produced;
+    int ret = block_inflate(bs, dst, len, &produced);
+    if (ret != 0) return ret;
+    return produced == len ? 0 : -1;  /* Block shorter than ctrl claims */
+}
+
+/*
+ * Decode and drop len bytes, using scratch as the output buffer. Brings a
+ * block reopened at a restart point up to where the apply loop was.
+ */
+static int block_stream_skip(block_stream *bs, int64_t len, uint8_t *scratch, size_t scratch_size) {
+    while (len > 0) {
+        size_t n = len < (int64_t)scratch_size ? (size_t)len : scratch_size;
+        int ret = block_stream_read(bs, scratch, n);
+        if (ret != 0) return ret;
+        len -= n;
     }
+    return 0;
+}
 
-    /* Read control block size, diff block size, and new file size */
-    bzctrllen = offtin(header + 8);
-    bzdatalen = offtin(header + 16);
-    newsize = offtin(header + 24);
+/* Error code for a failed read of a block: code, unless memory ran out */
+static int block_stream_error(int ret, int code) {
+    return ret == -10 ? -10 : code;
+}
 
-    /* Sanity check */
-    if (bzctrllen < 0 || bzdatalen < 0 || newsize < 0 ||
-        32 + bzctrllen + bzdatalen > patchsize) {
-        free(old);
-        free(patch);
-        return -5;  /* Patch header corrupt */
-    }
-
-    bzdatalen_extra = patchsize - 32 - bzctrllen - bzdatalen;
-
-    /* Decompress control block */
-    if (decompress_gzip(patch + 32, bzctrllen, &ctrl, &ctrllen) != 0) {
-        free(old);
-        free(patch);
-        return -6;  /* Cannot decompress ctrl block */
-    }
-
-    /* Decompress diff block */
-    if (decompress_gzip(patch + 32 + bzctrllen, bzdatalen, &diff, &difflen) != 0) {
-        free(old);
-        free(patch);
-        free(ctrl);
-        return -7;  /* Cannot decompress diff block */
-    }
-
-    /* Decompress extra block */
-    if (bzdatalen_extra > 0) {
-        if (decompress_gzip(patch + 32 + bzctrllen + bzdatalen, bzdatalen_extra, &extra, &extralen) != 0) {
-            free(old);
-            free(patch);
-            free(ctrl);
-            free(diff);
-            return -8;  /* Cannot decompress extra block */
+static void block_stream_close(block_stream *bs) {
+    if (bs->threaded) {
+        pthread_mutex_lock(&bs->lock);
+        bs->ring_stop = 1;
+        pthread_cond_signal(&bs->not_full);
+        pthread_mutex_unlock(&bs->lock);
+        pthread_join(bs->thread, NULL);
+
+        pthread_cond_destroy(&bs->not_full);
+        pthread_cond_destroy(&bs->not_empty);
+        pthread_mutex_destroy(&bs->lock);
+        bs->ring = NULL;
+        bs->threaded = 0;
+    }
+    if (bs->initialized) {
+#ifdef BSPATCH_HAVE_ZSTD
+        if (bs->codec == BSPATCH_CODEC_ZSTD) {
+            ZSTD_freeDStream(bs->zstd);
+            bs->initialized = 0;
+            return;
         }
-    } else {
-        extra = malloc(1);
-        extralen = 0;
+#endif
+        inflateEnd(&bs->strm);
+        bs->initialized = 0;
     }
+}
+
+/* Running digest of the output */
+typedef union {
+    md5_ctx md5;
+    sha256_ctx sha256;
+} bspatch_hash;
+
+/* Where one block stream resumes, as saved in a checkpoint */
+typedef struct {
+    int64_t out;            /* Restart point: inflated offset */
+    int64_t in;             /* Restart point: compressed offset */
+    int64_t consumed;       /* Bytes to skip past the point: consumed - out */
+    int32_t bits;
+    uint32_t window_len;    /* Window bytes following the record */
+} checkpoint_stream;
+
+/*
+ * Checkpoint file of bspatch_resume(): this record followed by the ctrl,
+ * diff and extra windows. It is only read back by the same build on the
+ * same device, so fields are stored in host layout; record_size and the
+ * CRC reject anything else.
+ */
+typedef struct {
+    char magic[8];
+    uint32_t record_size;
+    uint32_t crc;           /* crc32 of the file with this field zeroed */
+
+    /* Inputs the checkpoint belongs to */
+    int64_t oldsize;
+    int64_t old_mtime;
+    int64_t patchsize;
+    int64_t patch_mtime;
+    uint8_t header[BSDIFF41_HEADER_SIZE];
+    int32_t digest;
+
+    /* Apply loop state; the output is complete up to written */
+    int32_t in_tuple;
+    uint32_t tail_crc;      /* crc32 of the output tail ending at written */
+    int64_t written;
+    int64_t oldpos;
+    int64_t diff_left;
+    int64_t extra_left;
+    int64_t seek;
+    checkpoint_stream streams[3];
+    bspatch_hash hash;
+} checkpoint_record;
 
-    /* Allocate new file buffer */
-    new_data = malloc(newsize + 1);
-    if (!new_data) {
-        ret = -10;  /* Memory allocation failed */
-        goto cleanup;
+/* bench/bspatch_fuzz.c re-seals mutated checkpoints by patching the CRC here */
+_Static_assert(offsetof(checkpoint_record, crc) == 12, "checkpoint CRC offset");
+
+#define BSPATCH_CHECKPOINT_MAX (sizeof(checkpoint_record) + 3 * BSPATCH_WINDOW_SIZE)
+
+/* All state of one streaming patch application */
+typedef struct {
+    int old_fd;
+    int patch_fd;
+    int new_fd;
+    const uint8_t *old;     /* Read-only mapping of the old file */
+    int64_t oldsize;
+    int64_t newsize;
+    block_stream ctrl;
+    block_stream diff;
+    block_stream extra;
+    uint8_t out[BSPATCH_OUT_CHUNK];     /* Pending output, flushed when full */
+    size_t out_len;
+    int64_t written;                    /* Bytes of new file written so far */
+
+    bspatch_progress_fn progress;
+    void *user_data;
+    int64_t progress_interval;
+    int64_t next_progress;              /* Report when written reaches this */
+
+    int digest;                         /* BSPATCH_DIGEST_* of the output */
+    bspatch_hash hash;
+
+    /*
+     * Apply loop position. Kept here rather than in locals so a checkpoint
+     * can be taken whenever the output is flushed, mid-tuple included.
+     */
+    int64_t oldpos;
+    int64_t newpos;
+    int in_tuple;                       /* Current ctrl tuple not done yet */
+    int64_t diff_left;                  /* Of the current tuple */
+    int64_t extra_left;
+    int64_t seek;                       /* ctrl_tuple[2], applied last */
+
+    /* bspatch_resume() only; checkpoint_path is NULL otherwise */
+    const char *checkpoint_path;
+    char *checkpoint_tmp;               /* checkpoint_path + ".tmp" */
+    int64_t checkpoint_interval;
+    int64_t next_checkpoint;
+    checkpoint_record *checkpoint;      /* Identity filled in; rest scratch */
+} bspatch_ctx;
+
+/* Invoke the progress callback; returns -13 if it asks to cancel */
+static int report_progress(bspatch_ctx *ctx) {
+    ctx->next_progress = ctx->written + ctx->progress_interval;
+    if (ctx->progress(ctx->written, ctx->newsize, ctx->user_data) != 0) {
+        return -13;  /* Cancelled */
     }
+    return 0;
+}
 
-    /* Apply patch */
-    size_t ctrl_pos = 0;
-    size_t diff_pos = 0;
-    size_t extra_pos = 0;
+/*
+ * Snapshot where the block must resume for the apply loop to continue at
+ * its current position, appending the restart window at window.
+ */
+static void block_stream_save(block_stream *bs, checkpoint_stream *cs, uint8_t *window) {
+    const access_point *best = NULL;
 
-    while (newpos < newsize) {
-        /* Read control tuple */
-        if (ctrl_pos + 24 > ctrllen) {
-            ret = -11;  /* Corrupt patch */
-            goto cleanup;
+    if (bs->threaded) pthread_mutex_lock(&bs->lock);
+    for (int i = 0; i < BSPATCH_POINT_SLOTS; i++) {
+        const access_point *p = &bs->points[i];
+        if (p->out >= 0 && p->out <= bs->consumed && (!best || p->out > best->out)) {
+            best = p;
         }
+    }
+    if (best) {
+        cs->out = best->out;
+        cs->in = best->in;
+        cs->bits = best->bits;
+        cs->window_len = best->window_len;
+        memcpy(window, best->window, best->window_len);
+    } else {
+        /* Cannot happen with enough slots; the block start is always valid */
+        cs->out = 0;
+        cs->in = bs->in_start;
+        cs->bits = 0;
+        cs->window_len = 0;
+    }
+    cs->consumed = bs->consumed;
+    if (bs->threaded) pthread_mutex_unlock(&bs->lock);
+}
+
+/*
+ * CRC of the last BSPATCH_CHECKPOINT_TAIL bytes of output before written,
+ * read back through buf (at least that large).
+ */
+static int output_tail_crc(int fd, int64_t written, uint8_t *buf, uint32_t *crc) {
+    size_t len = written < BSPATCH_CHECKPOINT_TAIL ? (size_t)written : BSPATCH_CHECKPOINT_TAIL;
+    if (pread_full(fd, buf, len, written - len) != 0) return -1;
+    *crc = crc32(0, buf, (uInt)len);
+    return 0;
+}
+
+/*
+ * Persist the apply state to ctx->checkpoint_path. The output it refers
+ * to is synced first, and the checkpoint replaced by rename(), so the file
+ * on disk always describes output that is really there.
+ */
+static int save_checkpoint(bspatch_ctx *ctx) {
+    checkpoint_record *rec = ctx->checkpoint;
+    uint8_t *window = (uint8_t *)(rec + 1);
+    block_stream *streams[3] = { &ctx->ctrl, &ctx->diff, &ctx->extra };
+
+    rec->crc = 0;
+    rec->in_tuple = ctx->in_tuple;
+    rec->written = ctx->written;
+    rec->oldpos = ctx->oldpos;
+    rec->diff_left = ctx->diff_left;
+    rec->extra_left = ctx->extra_left;
+    rec->seek = ctx->seek;
+    for (int i = 0; i < 3; i++) {
+        block_stream_save(streams[i], &rec->streams[i], window);
+        window += rec->streams[i].window_len;
+    }
+    memcpy(&rec->hash, &ctx->hash, sizeof(rec->hash));
+
+    /* Called right after a flush, so ctx->out is free to read back into */
+    ctx->next_checkpoint = ctx->written + ctx->checkpoint_interval;
+    if (fdatasync(ctx->new_fd) != 0 ||
+        output_tail_crc(ctx->new_fd, ctx->written, ctx->out, &rec->tail_crc) != 0) {
+        return -14;
+    }
+
+    size_t len = window - (uint8_t *)rec;
+    rec->crc = crc32(0, (const Bytef *)rec, (uInt)len);
+
+    int fd = open(ctx->checkpoint_tmp, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) return -14;  /* Cannot write checkpoint */
+    int failed = write_full(fd, (const uint8_t *)rec, len) != 0 || fsync(fd) != 0;
+    if (close(fd) != 0) failed = 1;
+    if (failed || rename(ctx->checkpoint_tmp, ctx->checkpoint_path) != 0) {
+        unlink(ctx->checkpoint_tmp);
+        return -14;
+    }
+    return 0;
+}
+
+/*
+ * Check that a stream position read back from a checkpoint lies inside its
+ * block, so a stale file can never send the decoder out of bounds.
+ */
+static int checkpoint_stream_valid(const checkpoint_stream *cs, off_t start, off_t length,
+                                   int codec) {
+    if (cs->out == 0) {
+        return cs->in == start && cs->bits == 0 && cs->window_len == 0 && cs->consumed >= 0;
+    }
+    return codec == BSPATCH_CODEC_GZIP && cs->out > 0 && cs->consumed >= cs->out &&
+           cs->in > start && cs->in <= start + length &&
+           cs->bits >= 0 && cs->bits < 8 && cs->window_len <= BSPATCH_WINDOW_SIZE;
+}
+
+/*
+ * Read the checkpoint at ctx->checkpoint_path into ctx->checkpoint. Returns
+ * 0 if it belongs to this patch (the identity fields of id) and new_path
+ * still holds its output, so patching can resume from it.
+ */
+static int load_checkpoint(bspatch_ctx *ctx, const checkpoint_record *id, const char *new_path,
+                           const off_t starts[3], const off_t lengths[3], int codec) {
+    checkpoint_record *rec = ctx->checkpoint;
+    uint8_t *buf = (uint8_t *)rec;
+    struct stat st;
+    int fd, ok;
+
+    fd = open(ctx->checkpoint_path, O_RDONLY);
+    if (fd < 0) return -1;
+    ok = fstat(fd, &st) == 0 && st.st_size >= (off_t)sizeof(*rec) &&
+         st.st_size <= (off_t)BSPATCH_CHECKPOINT_MAX &&
+         pread_full(fd, buf, (size_t)st.st_size, 0) == 0;
+    close(fd);
+    if (!ok) return -1;
+
+    uint32_t crc = rec->crc;
+    rec->crc = 0;
+    if (crc32(0, buf, (uInt)st.st_size) != crc ||
+        memcmp(rec, id, offsetof(checkpoint_record, in_tuple)) != 0) {
+        return -1;
+    }
+
+    size_t windows = 0;
+    for (int i = 0; i < 3; i++) {
+        if (!checkpoint_stream_valid(&rec->streams[i], starts[i], lengths[i], codec)) return -1;
+        windows += rec->streams[i].window_len;
+    }
+    if (sizeof(*rec) + windows != (size_t)st.st_size ||
+        rec->written < 0 || rec->written > ctx->newsize ||
+        rec->diff_left < 0 || rec->extra_left < 0 ||
+        rec->diff_left + rec->extra_left > ctx->newsize - rec->written) {
+        return -1;
+    }
+
+    /*
+     * The output must still be there. Its size says nothing, since it is
+     * allocated in full up front, so check the tail the checkpoint saw.
+     * Nothing is in ctx->out before patching starts.
+     */
+    uint32_t tail_crc;
+    fd = open(new_path, O_RDONLY);
+    if (fd < 0) return -1;
+    ok = output_tail_crc(fd, rec->written, ctx->out, &tail_crc) == 0 && tail_crc == rec->tail_crc;
+    close(fd);
+    return ok ? 0 : -1;
+}
+
+static int flush_output(bspatch_ctx *ctx) {
+    if (ctx->out_len == 0) return 0;
+
+    /* Hash while the chunk is still hot in cache, so no re-read is needed */
+    if (ctx->digest == BSPATCH_DIGEST_MD5) {
+        md5_update(&ctx->hash.md5, ctx->out, ctx->out_len);
+    } else if (ctx->digest == BSPATCH_DIGEST_SHA256) {
+        sha256_update(&ctx->hash.sha256, ctx->out, ctx->out_len);
+    }
+
+    if (write_full(ctx->new_fd, ctx->out, ctx->out_len) != 0) return -9;
+    ctx->written += ctx->out_len;
+    ctx->out_len = 0;
+
+    if (ctx->checkpoint_path && ctx->written >= ctx->next_checkpoint &&
+        ctx->written < ctx->newsize) {
+        int ret = save_checkpoint(ctx);
+        if (ret != 0) return ret;
+    }
+
+    /* Throttled: at most one upcall per progress_interval bytes */
+    if (ctx->progress && ctx->written >= ctx->next_progress &&
+        ctx->written < ctx->newsize) {
+        return report_progress(ctx);
+    }
+    return 0;
+}
+
+/*
+ * Map the old file read-only. Pages are faulted in from the page cache on
+ * first touch, so nothing is read until the first ctrl tuple needs it.
+ */
+static int map_old_file(bspatch_ctx *ctx) {
+    ctx->old = NULL;
+    if (ctx->oldsize == 0) return 0;  /* mmap() rejects empty mappings */
+
+    void *p = mmap(NULL, (size_t)ctx->oldsize, PROT_READ, MAP_PRIVATE, ctx->old_fd, 0);
+    if (p == MAP_FAILED) return -1;
+
+    /* Diffs mostly walk the old file forwards */
+    madvise(p, (size_t)ctx->oldsize, MADV_SEQUENTIAL);
+    ctx->old = p;
+    return 0;
+}
+
+static void unmap_old_file(bspatch_ctx *ctx) {
+    if (ctx->old) {
+        munmap((void *)ctx->old, (size_t)ctx->oldsize);
+        ctx->old = NULL;
+    }
+}
+
+/*
+ * Hint the kernel to start reading the part of the old file the next diff
+ * will touch. Called once per ctrl tuple, since ctrl_tuple[2] may have
+ * moved oldpos far away from where sequential readahead was heading.
+ */
+static void prefetch_old(bspatch_ctx *ctx, int64_t oldpos, int64_t len) {
+    static long page_size = 0;
+    if (!ctx->old) return;
+
+    if (len > BSPATCH_OLD_READAHEAD) len = BSPATCH_OLD_READAHEAD;
+    int64_t start = oldpos < 0 ? 0 : oldpos;
+    int64_t end = oldpos + len;
+    if (end > ctx->oldsize) end = ctx->oldsize;
+    if (start >= end) return;
+
+    if (page_size == 0) page_size = sysconf(_SC_PAGESIZE);
+    start &= ~(int64_t)(page_size - 1);
+    madvise((void *)(ctx->old + start), (size_t)(end - start), MADV_WILLNEED);
+}
+
+/*
+ * Produce the diff part of the current tuple as diff + old[oldpos...].
+ *
+ * Diff bytes are inflated straight into the output buffer; only the part of
+ * the range that falls inside the old file gets the old bytes added, the
+ * rest is copied through unchanged.
+ */
+static int apply_diff(bspatch_ctx *ctx) {
+    while (ctx->diff_left > 0) {
+        size_t room = BSPATCH_OUT_CHUNK - ctx->out_len;
+        size_t n = ctx->diff_left < (int64_t)room ? (size_t)ctx->diff_left : room;
+        uint8_t *dst = ctx->out + ctx->out_len;
+        int64_t oldpos = ctx->oldpos;
 
-        ctrl_tuple[0] = offtin(ctrl + ctrl_pos);
-        ctrl_tuple[1] = offtin(ctrl + ctrl_pos + 8);
-        ctrl_tuple[2] = offtin(ctrl + ctrl_pos + 16);
-        ctrl_pos += 24;
+        int ret = block_stream_read(&ctx->diff, dst, n);
+        if (ret != 0) return block_stream_error(ret, -7);
 
-        /* Sanity check */
-        if (newpos + ctrl_tuple[0] > newsize) {
-            ret = -11;
-            goto cleanup;
+        /*
+         * Part of [oldpos, oldpos + n) that lies inside the old file. The
+         * head before it and the tail after it are diff bytes as-is, so
+         * the bounds are resolved once here rather than per byte.
+         */
+        int64_t lo = oldpos < 0 ? -oldpos : 0;
+        int64_t hi = ctx->oldsize - oldpos;
+        if (lo > (int64_t)n) lo = n;
+        if (hi > (int64_t)n) hi = n;
+
+        if (hi > lo) {
+            bspatch_add_bytes(dst + lo, ctx->old + oldpos + lo, (size_t)(hi - lo));
         }
 
-        /* Read diff block and add old data */
-        if (diff_pos + ctrl_tuple[0] > difflen) {
-            ret = -11;
-            goto cleanup;
+        /* Position first: a flush may checkpoint it */
+        ctx->out_len += n;
+        ctx->oldpos += n;
+        ctx->newpos += n;
+        ctx->diff_left -= n;
+        if (ctx->out_len == BSPATCH_OUT_CHUNK) {
+            int ret = flush_output(ctx);
+            if (ret != 0) return ret;
         }
+    }
+    return 0;
+}
 
-        for (int64_t i = 0; i < ctrl_tuple[0]; i++) {
-            if (oldpos + i >= 0 && oldpos + i < oldsize) {
-                new_data[newpos + i] = diff[diff_pos + i] + old[oldpos + i];
-            } else {
-                new_data[newpos + i] = diff[diff_pos + i];
-            }
+/* Copy the extra part of the current tuple to the output */
+static int apply_extra(bspatch_ctx *ctx) {
+    while (ctx->extra_left > 0) {
+        size_t room = BSPATCH_OUT_CHUNK - ctx->out_len;
+        size_t n = ctx->extra_left < (int64_t)room ? (size_t)ctx->extra_left : room;
+
+        int ret = block_stream_read(&ctx->extra, ctx->out + ctx->out_len, n);
+        if (ret != 0) return block_stream_error(ret, -8);
+
+        ctx->out_len += n;
+        ctx->newpos += n;
+        ctx->extra_left -= n;
+        if (ctx->out_len == BSPATCH_OUT_CHUNK) {
+            int ret = flush_output(ctx);
+            if (ret != 0) return ret;
         }
+    }
+    return 0;
+}
 
-        diff_pos += ctrl_tuple[0];
-        newpos += ctrl_tuple[0];
-        oldpos += ctrl_tuple[0];
+/*
+ * Run the control tuples until newsize bytes have been produced, starting
+ * from the position in ctx (the beginning, or a resumed checkpoint).
+ */
+static int apply_patch(bspatch_ctx *ctx) {
+    uint8_t buf[24];
+    int64_t ctrl_tuple[3];
+    int ret;
+
+    while (ctx->in_tuple || ctx->newpos < ctx->newsize) {
+        if (!ctx->in_tuple) {
+            /* Read control tuple */
+            ret = block_stream_read(&ctx->ctrl, buf, 24);
+            if (ret != 0) {
+                return block_stream_error(ret, -11);  /* Corrupt patch */
+            }
+
+            ctrl_tuple[0] = offtin(buf);
+            ctrl_tuple[1] = offtin(buf + 8);
+            ctrl_tuple[2] = offtin(buf + 16);
 
-        /* Sanity check */
-        if (newpos + ctrl_tuple[1] > newsize) {
-            ret = -11;
-            goto cleanup;
+            /* Sanity check */
+            if (ctrl_tuple[0] < 0 || ctrl_tuple[1] < 0 ||
+                ctrl_tuple[0] > ctx->newsize - ctx->newpos ||
+                ctrl_tuple[1] > ctx->newsize - ctx->newpos - ctrl_tuple[0]) {
+                return -11;
+            }
+
+            ctx->in_tuple = 1;
+            ctx->diff_left = ctrl_tuple[0];
+            ctx->extra_left = ctrl_tuple[1];
+            ctx->seek = ctrl_tuple[2];
+            prefetch_old(ctx, ctx->oldpos, ctx->diff_left);
         }
 
+        /* Read diff block and add old data */
+        ret = apply_diff(ctx);
+        if (ret != 0) return ret;
+
         /* Read extra block */
-        if (extra_pos + ctrl_tuple[1] > extralen) {
-            ret = -11;
-            goto cleanup;
+        ret = apply_extra(ctx);
+        if (ret != 0) return ret;
+
+        ctx->oldpos += ctx->seek;
+        ctx->in_tuple = 0;
+    }
+
+    ret = flush_output(ctx);
+    if (ret != 0) return ret;
+
+    /* Always deliver the final 100% report */
+    return ctx->progress ? report_progress(ctx) : 0;
+}
+
+int bspatch(const char *old_path, const char *new_path, const char *patch_path) {
+    return bspatch_ex(old_path, new_path, patch_path, NULL);
+}
+
+/* Additional working memory of bspatch_resume(): restart points and I/O */
+static size_t resume_mem_size(void) {
+    size_t points = ARENA_ALIGN(BSPATCH_POINT_SLOTS * sizeof(access_point)) +
+                    BSPATCH_POINT_SLOTS * BSPATCH_WINDOW_SIZE;
+    return 3 * points + ARENA_ALIGN(BSPATCH_CHECKPOINT_MAX) + BSPATCH_PATH_MAX + 16;
+}
+
+size_t bspatch_work_mem_size(void) {
+    /*
+     * Slack covers aligning the caller's pointer and each allocation. The
+     * resume part is only touched by bspatch_resume(), so on the heap its
+     * pages are never faulted in for plain patching.
+     */
+    return ARENA_ALIGN(sizeof(bspatch_ctx)) + BSPATCH_CTRL_RING +
+           2 * BSPATCH_DATA_RING + 3 * BSPATCH_ZLIB_MEM + resume_mem_size() + 64;
+}
+
+/*
+ * Ring size for a data block. Diff and extra together expand to newsize
+ * bytes, so a small patch never needs more ring than that.
+ */
+static size_t data_ring_size(int64_t newsize) {
+    return newsize < BSPATCH_DATA_RING ? (size_t)newsize : BSPATCH_DATA_RING;
+}
+
+size_t bspatch_digest_size(int digest) {
+    switch (digest) {
+    case BSPATCH_DIGEST_MD5:
+        return MD5_DIGEST_SIZE;
+    case BSPATCH_DIGEST_SHA256:
+        return SHA256_DIGEST_SIZE;
+    default:
+        return 0;
+    }
+}
+
+/*
+ * Set up checkpointing for bspatch_resume() and, if a usable checkpoint is
+ * on disk, load it. Returns 1 to resume from ctx->checkpoint, 0 to start
+ * afresh, or a negative error code.
+ */
+static int prepare_checkpoint(bspatch_ctx *ctx, bspatch_arena *arena, const char *new_path,
+                              const struct stat *old_st, const struct stat *patch_st,
+                              const uint8_t *header, const off_t starts[3],
+                              const off_t lengths[3], int codec) {
+    checkpoint_record id;
+    size_t path_len = strlen(ctx->checkpoint_path);
+
+    if (path_len + sizeof(".tmp") > BSPATCH_PATH_MAX) return -14;
+    ctx->checkpoint_tmp = arena_alloc(arena, path_len + sizeof(".tmp"));
+    ctx->checkpoint = arena_alloc(arena, BSPATCH_CHECKPOINT_MAX);
+    if (!ctx->checkpoint_tmp || !ctx->checkpoint ||
+        block_stream_track(&ctx->ctrl, arena) != 0 ||
+        block_stream_track(&ctx->diff, arena) != 0 ||
+        block_stream_track(&ctx->extra, arena) != 0) {
+        return -10;  /* Memory allocation failed */
+    }
+    memcpy(ctx->checkpoint_tmp, ctx->checkpoint_path, path_len);
+    memcpy(ctx->checkpoint_tmp + path_len, ".tmp", sizeof(".tmp"));
+
+    /* Everything that has to match for a checkpoint to apply */
+    memset(&id, 0, sizeof(id));
+    memcpy(id.magic, BSPATCH_CHECKPOINT_MAGIC, sizeof(id.magic));
+    id.record_size = sizeof(id);
+    id.oldsize = old_st->st_size;
+    id.old_mtime = old_st->st_mtime;
+    id.patchsize = patch_st->st_size;
+    id.patch_mtime = patch_st->st_mtime;
+    memcpy(id.header, header, sizeof(id.header));
+    id.digest = ctx->digest;
+
+    if (load_checkpoint(ctx, &id, new_path, starts, lengths, codec) == 0) return 1;
+
+    /*
+     * Starting afresh truncates the output, so a checkpoint that was only
+     * rejected for its missing output must not survive to be loaded later.
+     */
+    unlink(ctx->checkpoint_path);
+    memcpy(ctx->checkpoint, &id, sizeof(id));
+    return 0;
+}
+
+/* Continue the apply loop, digest and output position from the checkpoint */
+static void restore_checkpoint(bspatch_ctx *ctx) {
+    const checkpoint_record *rec = ctx->checkpoint;
+
+    ctx->written = rec->written;
+    ctx->newpos = rec->written;
+    ctx->oldpos = rec->oldpos;
+    ctx->in_tuple = rec->in_tuple;
+    ctx->diff_left = rec->diff_left;
+    ctx->extra_left = rec->extra_left;
+    ctx->seek = rec->seek;
+    memcpy(&ctx->hash, &rec->hash, sizeof(ctx->hash));
+    ctx->next_progress = ctx->written + ctx->progress_interval;
+    ctx->next_checkpoint = ctx->written + ctx->checkpoint_interval;
+}
+
+/* Restart point of stream i in a loaded checkpoint, windows in file order */
+static access_point checkpoint_point(const checkpoint_record *rec, int i) {
+    uint8_t *window = (uint8_t *)(rec + 1);
+    access_point p;
+
+    for (int j = 0; j < i; j++) window += rec->streams[j].window_len;
+    p.out = rec->streams[i].out;
+    p.in = rec->streams[i].in;
+    p.bits = rec->streams[i].bits;
+    p.window_len = rec->streams[i].window_len;
+    p.window = window;
+    return p;
+}
+
+static int bspatch_apply(const char *old_path, const char *new_path, const char *patch_path,
+                         const char *checkpoint_path, const bspatch_options *options) {
+    bspatch_arena arena;
+    void *heap_mem = NULL;
+    bspatch_ctx *ctx;
+    uint8_t header[BSDIFF41_HEADER_SIZE];
+    struct stat st, old_st;
+    int64_t bzctrllen, bzdatalen, patchsize, hdrsize;
+    off_t starts[3], lengths[3];
+    access_point points[3];
+    int codec;
+    int resumed = 0;
+    int ret;
+
+    /* All working memory comes from one block, the caller's if given */
+    if (options && options->work_mem) {
+        arena_init(&arena, options->work_mem, options->work_mem_size, 0);
+    } else {
+        size_t size = bspatch_work_mem_size();
+        heap_mem = malloc(size);
+        /* On failure the empty arena fails the first allocation below */
+        arena_init(&arena, heap_mem, heap_mem ? size : 0, 1);
+    }
+
+    ctx = arena_alloc(&arena, sizeof(*ctx));
+    if (!ctx) {
+        ret = -10;
+        goto free_arena;
+    }
+    ctx->new_fd = -1;
+    ctx->old = NULL;
+    ctx->out_len = 0;
+    ctx->written = 0;
+    ctx->progress = options ? options->progress : NULL;
+    ctx->user_data = options ? options->user_data : NULL;
+    ctx->progress_interval = (options && options->progress_interval > 0)
+        ? options->progress_interval : BSPATCH_PROGRESS_INTERVAL;
+    ctx->next_progress = ctx->progress_interval;
+    ctx->digest = (options && options->digest_out) ? options->digest : BSPATCH_DIGEST_NONE;
+    if (ctx->digest == BSPATCH_DIGEST_MD5) {
+        md5_init(&ctx->hash.md5);
+    } else if (ctx->digest == BSPATCH_DIGEST_SHA256) {
+        sha256_init(&ctx->hash.sha256);
+    }
+    ctx->oldpos = 0;
+    ctx->newpos = 0;
+    ctx->in_tuple = 0;
+    ctx->checkpoint_path = checkpoint_path;
+    ctx->checkpoint_interval = (options && options->checkpoint_interval > 0)
+        ? options->checkpoint_interval : BSPATCH_CHECKPOINT_INTERVAL;
+    block_stream_init(&ctx->ctrl);
+    block_stream_init(&ctx->diff);
+    block_stream_init(&ctx->extra);
+
+    /* Open old file */
+    ctx->old_fd = open(old_path, O_RDONLY);
+    if (ctx->old_fd < 0) {
+        ret = -1;  /* Cannot open old file */
+        goto free_arena;
+    }
+    if (fstat(ctx->old_fd, &old_st) != 0) {
+        ret = -2;  /* Cannot read old file */
+        goto close_old;
+    }
+    ctx->oldsize = old_st.st_size;
+    if (map_old_file(ctx) != 0) {
+        ret = -2;
+        goto close_old;
+    }
+
+    /* Open patch file */
+    ctx->patch_fd = open(patch_path, O_RDONLY);
+    if (ctx->patch_fd < 0) {
+        ret = -3;  /* Cannot open patch file */
+        goto close_old;
+    }
+    if (fstat(ctx->patch_fd, &st) != 0) {
+        ret = -3;
+        goto close_patch;
+    }
+    patchsize = st.st_size;
+
+    /* Check patch size and magic */
+    if (patchsize < BSDIFF40_HEADER_SIZE ||
+        pread_full(ctx->patch_fd, header, BSDIFF40_HEADER_SIZE, 0) != 0) {
+        ret = -4;  /* Invalid patch header */
+        goto close_patch;
+    }
+    if (memcmp(header, BSDIFF_MAGIC, 8) == 0) {
+        memset(header + BSDIFF40_HEADER_SIZE, 0, BSDIFF41_HEADER_SIZE - BSDIFF40_HEADER_SIZE);
+        hdrsize = BSDIFF40_HEADER_SIZE;
+        codec = BSPATCH_CODEC_GZIP;
+    } else if (memcmp(header, BSDIFF41_MAGIC, 8) == 0) {
+        hdrsize = BSDIFF41_HEADER_SIZE;
+        if (patchsize < hdrsize ||
+            pread_full(ctx->patch_fd, header + 32, 8, 32) != 0) {
+            ret = -4;
+            goto close_patch;
         }
+        int64_t id = offtin(header + 32);
+        codec = (id >= 0 && id <= 0xFF) ? (int)id : -1;
+    } else {
+        ret = -4;
+        goto close_patch;
+    }
+
+    /* Read control block size, diff block size, and new file size */
+    bzctrllen = offtin(header + 8);
+    bzdatalen = offtin(header + 16);
+    ctx->newsize = offtin(header + 24);
 
-        memcpy(new_data + newpos, extra + extra_pos, ctrl_tuple[1]);
-        extra_pos += ctrl_tuple[1];
-        newpos += ctrl_tuple[1];
-        oldpos += ctrl_tuple[2];
+    /* Sanity check */
+    if (bzctrllen < 0 || bzdatalen < 0 || ctx->newsize < 0 ||
+        bzctrllen > patchsize - hdrsize || bzdatalen > patchsize - hdrsize - bzctrllen) {
+        ret = -5;  /* Patch header corrupt */
+        goto close_patch;
     }
 
-    /* Write new file */
-    if (write_file(new_path, new_data, newsize) != 0) {
+    starts[0] = hdrsize;
+    lengths[0] = bzctrllen;
+    starts[1] = hdrsize + bzctrllen;
+    lengths[1] = bzdatalen;
+    starts[2] = hdrsize + bzctrllen + bzdatalen;
+    lengths[2] = patchsize - hdrsize - bzctrllen - bzdatalen;
+
+    if (checkpoint_path) {
+        resumed = prepare_checkpoint(ctx, &arena, new_path, &old_st, &st, header,
+                                     starts, lengths, codec);
+        if (resumed < 0) {
+            ret = resumed;
+            goto close_patch;
+        }
+        for (int i = 0; resumed && i < 3; i++) {
+            points[i] = checkpoint_point(ctx->checkpoint, i);
+        }
+    }
+
+    /* Set up the three block streams; nothing is inflated yet */
+    ret = block_stream_open(&ctx->ctrl, &arena, codec, ctx->patch_fd, starts[0], lengths[0],
+                            resumed ? &points[0] : NULL);
+    if (ret != 0) {
+        if (ret != -12) ret = block_stream_error(ret, -6);  /* Cannot decompress ctrl block */
+        goto close_streams;
+    }
+    ret = block_stream_open(&ctx->diff, &arena, codec, ctx->patch_fd, starts[1], lengths[1],
+                            resumed ? &points[1] : NULL);
+    if (ret != 0) {
+        ret = block_stream_error(ret, -7);  /* Cannot decompress diff block */
+        goto close_streams;
+    }
+    ret = block_stream_open(&ctx->extra, &arena, codec, ctx->patch_fd, starts[2], lengths[2],
+                            resumed ? &points[2] : NULL);
+    if (ret != 0) {
+        ret = block_stream_error(ret, -8);  /* Cannot decompress extra block */
+        goto close_streams;
+    }
+
+    if (resumed) {
+        /* Decode from each restart point up to where the apply loop was */
+        const checkpoint_stream *cs = ctx->checkpoint->streams;
+        ret = block_stream_skip(&ctx->ctrl, cs[0].consumed - cs[0].out,
+                                ctx->out, BSPATCH_OUT_CHUNK);
+        if (ret != 0) {
+            ret = block_stream_error(ret, -6);
+            goto close_streams;
+        }
+        ret = block_stream_skip(&ctx->diff, cs[1].consumed - cs[1].out,
+                                ctx->out, BSPATCH_OUT_CHUNK);
+        if (ret != 0) {
+            ret = block_stream_error(ret, -7);
+            goto close_streams;
+        }
+        ret = block_stream_skip(&ctx->extra, cs[2].consumed - cs[2].out,
+                                ctx->out, BSPATCH_OUT_CHUNK);
+        if (ret != 0) {
+            ret = block_stream_error(ret, -8);
+            goto close_streams;
+        }
+        restore_checkpoint(ctx);
+    }
+
+    /* Inflate all three blocks concurrently with the apply loop */
+    block_stream_start(&ctx->ctrl, &arena, BSPATCH_CTRL_RING);
+    block_stream_start(&ctx->diff, &arena, data_ring_size(ctx->newsize));
+    block_stream_start(&ctx->extra, &arena, data_ring_size(ctx->newsize));
+
+    /*
+     * Create new file, or reopen the partial one to continue after written.
+     * Opened for reading too, as checkpoints CRC the output tail back.
+     */
+    ctx->new_fd = open(new_path, resumed ? O_RDWR : O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (ctx->new_fd < 0) {
         ret = -9;  /* Cannot create new file */
-        goto cleanup;
+        goto close_streams;
+    }
+    if (resumed && lseek(ctx->new_fd, ctx->written, SEEK_SET) < 0) {
+        ret = -9;
+        goto close_new;
+    }
+
+    /*
+     * Reserve the exact output size up front: the file never has to grow
+     * block by block, and a full disk fails now rather than minutes in.
+     * Filesystems without fallocate support are simply written as before.
+     */
+    if (ctx->newsize > 0 && posix_fallocate(ctx->new_fd, 0, ctx->newsize) == ENOSPC) {
+        ret = -9;
+        goto close_new;
+    }
+
+    /* Let the caller show the restored position before any new work */
+    if (resumed && ctx->progress) {
+        ret = report_progress(ctx);
+        if (ret != 0) goto close_new;
+    }
+    if (ctx->in_tuple) {
+        prefetch_old(ctx, ctx->oldpos, ctx->diff_left);
+    }
+
+    ret = apply_patch(ctx);
+
+    if (ret == 0 && ctx->digest == BSPATCH_DIGEST_MD5) {
+        md5_final(&ctx->hash.md5, options->digest_out);
+    } else if (ret == 0 && ctx->digest == BSPATCH_DIGEST_SHA256) {
+        sha256_final(&ctx->hash.sha256, options->digest_out);
+    }
+
+close_new:
+    if (close(ctx->new_fd) != 0 && ret == 0) {
+        ret = -9;
+    }
+    /* Never leave a half-written file behind (bspatch_resume() below) */
+    if (ret != 0 && !checkpoint_path) {
+        unlink(new_path);
     }
 
-cleanup:
-    free(old);
-    free(patch);
-    free(ctrl);
-    free(diff);
-    free(extra);
-    free(new_data);
+close_streams:
+    block_stream_close(&ctx->ctrl);
+    block_stream_close(&ctx->diff);
+    block_stream_close(&ctx->extra);
+close_patch:
+    close(ctx->patch_fd);
+close_old:
+    unmap_old_file(ctx);
+    close(ctx->old_fd);
+free_arena:
+    pthread_mutex_destroy(&arena.lock);
+    free(heap_mem);
+
+    /*
+     * A cancelled bspatch_resume() keeps its output and checkpoint so a
+     * later call can continue. Any other outcome removes the checkpoint,
+     * and a failure at any stage also removes the output, which may be a
+     * partial file adopted from an earlier run.
+     */
+    if (checkpoint_path && ret != -13) {
+        unlink(checkpoint_path);
+        if (ret != 0) unlink(new_path);
+    }
 
     return ret;
 }
+
+int bspatch_ex(const char *old_path, const char *new_path, const char *patch_path,
+               const bspatch_options *options) {
+    return bspatch_apply(old_path, new_path, patch_path, NULL, options);
+}
+
+int bspatch_resume(const char *old_path, const char *new_path, const char *patch_path,
+                   const char *checkpoint_path, const bspatch_options *options) {
+    return bspatch_apply(old_path, new_path, patch_path, checkpoint_path, options);
+}
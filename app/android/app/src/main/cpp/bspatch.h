@@ -10,6 +10,7 @@
 #ifndef BSPATCH_H
 #define BSPATCH_H
 
+#include <stddef.h>
 #include <stdint.h>
 
 #ifdef __cplusplus
@@ -19,6 +20,11 @@ extern "C" {
 /**
  * Apply a bsdiff patch to create a new file.
  *
+ * The patch is applied in a single streaming pass: the ctrl, diff and extra
+ * blocks are inflated incrementally and the output is written in bounded
+ * chunks, so peak memory stays at a few MB regardless of file size.
+ * On failure the partially written output file is removed.
+ *
  * @param old_path Path to the original file
  * @param new_path Path to the output (patched) file
  * @param patch_path Path to the patch file
@@ -36,9 +42,119 @@ extern "C" {
  *  -9: Cannot create new file
  *  -10: Memory allocation failed
  *  -11: Corrupt patch
+ *  -12: Unsupported patch compression
+ *  -13: Cancelled
+ *  -14: Cannot write checkpoint
+ *
+ * Both BSDIFF40 patches (gzip blocks) and BSDIFF41 patches (40-byte header
+ * carrying a codec id: 0 = gzip, 1 = zstd) are accepted. zstd blocks need
+ * the library to be built with BSPATCH_WITH_ZSTD.
  */
 int bspatch(const char *old_path, const char *new_path, const char *patch_path);
 
+/**
+ * Progress callback for bspatch_ex().
+ *
+ * Called on the thread that invoked bspatch_ex(), once every
+ * progress_interval bytes of output and once more when the file is done.
+ *
+ * @param written Bytes of the new file written so far
+ * @param total Size of the new file from the patch header
+ * @param user_data Value of bspatch_options.user_data
+ * @return 0 to continue, non-zero to cancel (bspatch_ex returns -13)
+ */
+typedef int (*bspatch_progress_fn)(int64_t written, int64_t total, void *user_data);
+
+/**
+ * Digests bspatch_ex() can compute over the output as it is written.
+ */
+enum {
+    BSPATCH_DIGEST_NONE = 0,
+    BSPATCH_DIGEST_MD5 = 1,
+    BSPATCH_DIGEST_SHA256 = 2,
+};
+
+/* Largest digest any BSPATCH_DIGEST_* produces */
+#define BSPATCH_DIGEST_MAX_SIZE 32
+
+/**
+ * Optional settings for bspatch_ex(). Zero-initialise and set what is needed.
+ */
+typedef struct {
+    bspatch_progress_fn progress;   /* May be NULL */
+    void *user_data;
+    int64_t progress_interval;      /* Bytes between callbacks; 0 = 1 MB */
+
+    int digest;                     /* BSPATCH_DIGEST_* of the new file */
+    uint8_t *digest_out;            /* Receives the digest on success */
+
+    /*
+     * Caller-owned working memory, typically bspatch_work_mem_size() bytes.
+     * When set, bspatch_ex() never allocates from the heap and fails with
+     * -10 once the block is exhausted. The decoding context and zlib's
+     * state need about 0.6 MB; a block between that and
+     * bspatch_work_mem_size() only loses pipelined inflate for the rings
+     * that do not fit. bspatch_resume() needs about 0.5 MB more for its
+     * checkpoint buffers. zstd patches also take the decoder's window
+     * (up to the window size the patch was made with) from this block.
+     * Without work_mem, one block of bspatch_work_mem_size() is allocated
+     * and only zstd may use the heap beyond it.
+     */
+    void *work_mem;
+    size_t work_mem_size;
+
+    /* Output bytes between bspatch_resume() checkpoints; 0 = 4 MB */
+    int64_t checkpoint_interval;
+} bspatch_options;
+
+/**
+ * Same as bspatch(), with progress reporting and cancellation.
+ *
+ * @param options May be NULL, which behaves exactly like bspatch()
+ */
+int bspatch_ex(const char *old_path, const char *new_path, const char *patch_path,
+               const bspatch_options *options);
+
+/**
+ * Same as bspatch_ex(), but survives the process being killed mid-patch.
+ *
+ * Every checkpoint_interval bytes of output the apply state is saved to
+ * checkpoint_path: the ctrl/diff/extra positions, oldpos/newpos, the digest
+ * state and, for each gzip block, a restart point (compressed bit offset
+ * plus the 32 KB inflate window) at most about 1 MB behind the position
+ * reached, and a CRC of the last 64 KB of output. The output written so
+ * far is synced to disk before each checkpoint, which is replaced
+ * atomically.
+ *
+ * If checkpoint_path holds a checkpoint of the same old file, patch and
+ * digest, and the end of the output in new_path still matches its CRC
+ * (earlier output is trusted, not re-read), patching continues from there
+ * and the progress callback is invoked immediately with the restored
+ * position. Otherwise the patch starts from scratch.
+ * zstd blocks cannot be entered mid-stream and are re-decoded up to the
+ * saved position on resume.
+ *
+ * On success the checkpoint is removed. On cancellation (-13) the output
+ * and checkpoint are kept so a later call can resume; on any other error,
+ * including one before patching starts, both are removed.
+ *
+ * @param checkpoint_path Checkpoint file, typically next to new_path
+ * @param options May be NULL
+ */
+int bspatch_resume(const char *old_path, const char *new_path, const char *patch_path,
+                   const char *checkpoint_path, const bspatch_options *options);
+
+/**
+ * Working memory bspatch_ex() or bspatch_resume() needs for one patch,
+ * regardless of file sizes.
+ */
+size_t bspatch_work_mem_size(void);
+
+/**
+ * Size in bytes of a BSPATCH_DIGEST_* digest (0 for BSPATCH_DIGEST_NONE).
+ */
+size_t bspatch_digest_size(int digest);
+
 /**
  * Get error message for bspatch error code.
  *
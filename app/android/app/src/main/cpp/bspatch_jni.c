@@ -55,6 +55,148 @@ Java_com_example_ai_1bookkeeping_BsPatchHelper_applyPatch(
     return result;
 }
 
+/* Forwards bspatch progress to a BsPatchHelper.ProgressListener */
+typedef struct {
+    JNIEnv *env;
+    jobject listener;
+    jmethodID on_progress;
+} jni_progress;
+
+static int jni_progress_cb(int64_t written, int64_t total, void *user_data) {
+    jni_progress *p = user_data;
+    JNIEnv *env = p->env;
+
+    jboolean keep_going = (*env)->CallBooleanMethod(
+        env, p->listener, p->on_progress, (jlong)written, (jlong)total);
+    if ((*env)->ExceptionCheck(env)) {
+        /* Leave the exception pending for Kotlin; just stop patching */
+        return 1;
+    }
+    return keep_going ? 0 : 1;
+}
+
+/*
+ * Shared body of applyPatchEx and applyPatchResumable: bspatch_ex(), or
+ * bspatch_resume() when checkpoint_path is not NULL.
+ */
+static jint apply_patch_ex(
+    JNIEnv *env,
+    jstring old_path,
+    jstring new_path,
+    jstring patch_path,
+    jstring checkpoint_path,
+    jobject listener,
+    jint digest,
+    jbyteArray digest_out
+) {
+    bspatch_options options;
+    jni_progress progress;
+    uint8_t digest_buf[BSPATCH_DIGEST_MAX_SIZE];
+    size_t digest_size = bspatch_digest_size(digest);
+
+    memset(&options, 0, sizeof(options));
+    if (digest_size > 0) {
+        if (!digest_out || (*env)->GetArrayLength(env, digest_out) < (jsize)digest_size) {
+            LOGE("Digest buffer too small for algorithm %d", digest);
+            return -10;
+        }
+        options.digest = digest;
+        options.digest_out = digest_buf;
+    }
+    if (listener) {
+        jclass listener_class = (*env)->GetObjectClass(env, listener);
+        progress.env = env;
+        progress.listener = listener;
+        progress.on_progress = (*env)->GetMethodID(env, listener_class, "onProgress", "(JJ)Z");
+        (*env)->DeleteLocalRef(env, listener_class);
+        if (!progress.on_progress) {
+            LOGE("ProgressListener.onProgress not found");
+            return -10;
+        }
+        options.progress = jni_progress_cb;
+        options.user_data = &progress;
+    }
+
+    const char *old_path_c = (*env)->GetStringUTFChars(env, old_path, NULL);
+    const char *new_path_c = (*env)->GetStringUTFChars(env, new_path, NULL);
+    const char *patch_path_c = (*env)->GetStringUTFChars(env, patch_path, NULL);
+    const char *checkpoint_path_c = checkpoint_path
+        ? (*env)->GetStringUTFChars(env, checkpoint_path, NULL) : NULL;
+
+    if (!old_path_c || !new_path_c || !patch_path_c || (checkpoint_path && !checkpoint_path_c)) {
+        LOGE("Failed to get string paths");
+        if (old_path_c) (*env)->ReleaseStringUTFChars(env, old_path, old_path_c);
+        if (new_path_c) (*env)->ReleaseStringUTFChars(env, new_path, new_path_c);
+        if (patch_path_c) (*env)->ReleaseStringUTFChars(env, patch_path, patch_path_c);
+        if (checkpoint_path_c) (*env)->ReleaseStringUTFChars(env, checkpoint_path, checkpoint_path_c);
+        return -10;  /* Memory allocation failed */
+    }
+
+    LOGI("Applying patch: %s + %s -> %s", old_path_c, patch_path_c, new_path_c);
+
+    int result = checkpoint_path_c
+        ? bspatch_resume(old_path_c, new_path_c, patch_path_c, checkpoint_path_c, &options)
+        : bspatch_ex(old_path_c, new_path_c, patch_path_c, &options);
+
+    if (result == 0) {
+        LOGI("Patch applied successfully");
+        if (digest_size > 0) {
+            (*env)->SetByteArrayRegion(env, digest_out, 0, (jsize)digest_size,
+                                       (const jbyte *)digest_buf);
+        }
+    } else {
+        LOGE("Patch failed with error: %d (%s)", result, bspatch_strerror(result));
+    }
+
+    (*env)->ReleaseStringUTFChars(env, old_path, old_path_c);
+    (*env)->ReleaseStringUTFChars(env, new_path, new_path_c);
+    (*env)->ReleaseStringUTFChars(env, patch_path, patch_path_c);
+    if (checkpoint_path_c) (*env)->ReleaseStringUTFChars(env, checkpoint_path, checkpoint_path_c);
+
+    return result;
+}
+
+/*
+ * Class:     com_example_ai_bookkeeping_BsPatchHelper
+ * Method:    applyPatchEx
+ * Signature: (Ljava/lang/String;Ljava/lang/String;Ljava/lang/String;Lcom/example/ai_bookkeeping/BsPatchHelper$ProgressListener;I[B)I
+ */
+JNIEXPORT jint JNICALL
+Java_com_example_ai_1bookkeeping_BsPatchHelper_applyPatchEx(
+    JNIEnv *env,
+    jclass clazz,
+    jstring old_path,
+    jstring new_path,
+    jstring patch_path,
+    jobject listener,
+    jint digest,
+    jbyteArray digest_out
+) {
+    return apply_patch_ex(env, old_path, new_path, patch_path, NULL,
+                          listener, digest, digest_out);
+}
+
+/*
+ * Class:     com_example_ai_bookkeeping_BsPatchHelper
+ * Method:    applyPatchResumable
+ * Signature: (Ljava/lang/String;Ljava/lang/String;Ljava/lang/String;Ljava/lang/String;Lcom/example/ai_bookkeeping/BsPatchHelper$ProgressListener;I[B)I
+ */
+JNIEXPORT jint JNICALL
+Java_com_example_ai_1bookkeeping_BsPatchHelper_applyPatchResumable(
+    JNIEnv *env,
+    jclass clazz,
+    jstring old_path,
+    jstring new_path,
+    jstring patch_path,
+    jstring checkpoint_path,
+    jobject listener,
+    jint digest,
+    jbyteArray digest_out
+) {
+    return apply_patch_ex(env, old_path, new_path, patch_path, checkpoint_path,
+                          listener, digest, digest_out);
+}
+
 /*
  * Class:     com_example_ai_bookkeeping_BsPatchHelper
  * Method:    getErrorMessage
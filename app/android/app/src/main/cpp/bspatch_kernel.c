@@ -0,0 +1,64 @@
+/*
+ * bspatch_kernel.c - Vectorized inner loops of bspatch
+ */
+
+#include "bspatch_kernel.h"
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define BSPATCH_HAVE_NEON 1
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define BSPATCH_HAVE_SSE2 1
+#endif
+
+/*
+ * dst[i] += src[i] for i in [0, n), wrapping modulo 256.
+ *
+ * This is the diff-add hot loop. NEON is baseline on arm64 and enabled by
+ * default for armeabi-v7a; SSE2 is baseline on x86/x86_64. Everything else
+ * (and the last < 16 bytes) goes through the scalar loop.
+ */
+void bspatch_add_bytes(uint8_t *dst, const uint8_t *src, size_t n) {
+    size_t i = 0;
+
+#if defined(BSPATCH_HAVE_NEON)
+    for (; i + 64 <= n; i += 64) {
+        uint8x16_t a0 = vaddq_u8(vld1q_u8(dst + i), vld1q_u8(src + i));
+        uint8x16_t a1 = vaddq_u8(vld1q_u8(dst + i + 16), vld1q_u8(src + i + 16));
+        uint8x16_t a2 = vaddq_u8(vld1q_u8(dst + i + 32), vld1q_u8(src + i + 32));
+        uint8x16_t a3 = vaddq_u8(vld1q_u8(dst + i + 48), vld1q_u8(src + i + 48));
+        vst1q_u8(dst + i, a0);
+        vst1q_u8(dst + i + 16, a1);
+        vst1q_u8(dst + i + 32, a2);
+        vst1q_u8(dst + i + 48, a3);
+    }
+    for (; i + 16 <= n; i += 16) {
+        vst1q_u8(dst + i, vaddq_u8(vld1q_u8(dst + i), vld1q_u8(src + i)));
+    }
+#elif defined(BSPATCH_HAVE_SSE2)
+    for (; i + 64 <= n; i += 64) {
+        __m128i a0 = _mm_loadu_si128((const __m128i *)(dst + i));
+        __m128i a1 = _mm_loadu_si128((const __m128i *)(dst + i + 16));
+        __m128i a2 = _mm_loadu_si128((const __m128i *)(dst + i + 32));
+        __m128i a3 = _mm_loadu_si128((const __m128i *)(dst + i + 48));
+        a0 = _mm_add_epi8(a0, _mm_loadu_si128((const __m128i *)(src + i)));
+        a1 = _mm_add_epi8(a1, _mm_loadu_si128((const __m128i *)(src + i + 16)));
+        a2 = _mm_add_epi8(a2, _mm_loadu_si128((const __m128i *)(src + i + 32)));
+        a3 = _mm_add_epi8(a3, _mm_loadu_si128((const __m128i *)(src + i + 48)));
+        _mm_storeu_si128((__m128i *)(dst + i), a0);
+        _mm_storeu_si128((__m128i *)(dst + i + 16), a1);
+        _mm_storeu_si128((__m128i *)(dst + i + 32), a2);
+        _mm_storeu_si128((__m128i *)(dst + i + 48), a3);
+    }
+    for (; i + 16 <= n; i += 16) {
+        __m128i a = _mm_loadu_si128((const __m128i *)(dst + i));
+        a = _mm_add_epi8(a, _mm_loadu_si128((const __m128i *)(src + i)));
+        _mm_storeu_si128((__m128i *)(dst + i), a);
+    }
+#endif
+
+    for (; i < n; i++) {
+        dst[i] += src[i];
+    }
+}
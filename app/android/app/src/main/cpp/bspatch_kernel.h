@@ -0,0 +1,27 @@
+/*
+ * bspatch_kernel.h - Vectorized inner loops of bspatch
+ *
+ * Internal to the bspatch library; split out so the host benchmark can
+ * time the kernels on their own.
+ */
+
+#ifndef BSPATCH_KERNEL_H
+#define BSPATCH_KERNEL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * dst[i] += src[i] for i in [0, n), wrapping modulo 256.
+ */
+void bspatch_add_bytes(uint8_t *dst, const uint8_t *src, size_t n);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BSPATCH_KERNEL_H */
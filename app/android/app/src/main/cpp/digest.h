@@ -0,0 +1,47 @@
+/*
+ * digest.h - MD5 and SHA-256 message digests
+ *
+ * Small self-contained implementations so bspatch can hash its output
+ * while writing it, without pulling in a crypto library.
+ */
+
+#ifndef DIGEST_H
+#define DIGEST_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define MD5_DIGEST_SIZE 16
+#define SHA256_DIGEST_SIZE 32
+
+typedef struct {
+    uint32_t state[4];
+    uint64_t length;        /* Total bytes hashed */
+    uint8_t block[64];
+    size_t block_len;
+} md5_ctx;
+
+typedef struct {
+    uint32_t state[8];
+    uint64_t length;        /* Total bytes hashed */
+    uint8_t block[64];
+    size_t block_len;
+} sha256_ctx;
+
+void md5_init(md5_ctx *ctx);
+void md5_update(md5_ctx *ctx, const uint8_t *data, size_t len);
+void md5_final(md5_ctx *ctx, uint8_t out[MD5_DIGEST_SIZE]);
+
+void sha256_init(sha256_ctx *ctx);
+void sha256_update(sha256_ctx *ctx, const uint8_t *data, size_t len);
+void sha256_final(sha256_ctx *ctx, uint8_t out[SHA256_DIGEST_SIZE]);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DIGEST_H */
@@ -6,19 +6,13 @@
  */
 
 #include <jni.h>
+#include <stdint.h>
 #include <string.h>
-#include <stdlib.h>
 
 // XOR加密密钥
 static const unsigned char XOR_KEY[] = {0x4B, 0x5A, 0x3C, 0x7F, 0x2E, 0x9A, 0x1D, 0x8B};
-static const size_t XOR_KEY_LEN = 8;
-
-// XOR解密函数
-static void xor_decrypt(const unsigned char* src, char* dest, size_t len) {
-    for (size_t i = 0; i < len; i++) {
-        dest[i] = src[i] ^ XOR_KEY[i % XOR_KEY_LEN];
-    }
-}
+#define XOR_KEY_LEN sizeof(XOR_KEY)
+_Static_assert(sizeof(XOR_KEY) == sizeof(uint64_t), "xor_decrypt 按 64 位字异或");
 
 // 阿里云 AccessKey ID (XOR加密后的字节数组)
 static const unsigned char AK_ID_ENC[] = {
@@ -26,7 +20,6 @@ static const unsigned char AK_ID_ENC[] = {
     0x3D, 0x1C, 0x64, 0x4C, 0x74, 0xD7, 0x7F, 0xC9,
     0x3F, 0x2C, 0x55, 0x3E, 0x79, 0xF9, 0x4A, 0xE0
 };
-static const size_t AK_ID_LEN = 24;
 
 // 阿里云 AccessKey Secret (XOR加密后的字节数组)
 static const unsigned char AK_SEC_ENC[] = {
@@ -35,14 +28,12 @@ static const unsigned char AK_SEC_ENC[] = {
     0x0F, 0x17, 0x4F, 0x0F, 0x1A, 0xAB, 0x75, 0xC1,
     0x11, 0x30, 0x4D, 0x18, 0x4D, 0xEC
 };
-static const size_t AK_SEC_LEN = 30;
 
 // 阿里云 AppKey (XOR加密后的字节数组)
 static const unsigned char APP_KEY_ENC[] = {
     0x08, 0x62, 0x7A, 0x4F, 0x4A, 0xE0, 0x2D, 0xE2,
     0x23, 0x1C, 0x51, 0x09, 0x65, 0xD2, 0x25, 0xCC
 };
-static const size_t APP_KEY_LEN = 16;
 
 // 通义千问 API Key (XOR加密后的字节数组)
 static const unsigned char QWEN_ENC[] = {
@@ -52,84 +43,105 @@ static const unsigned char QWEN_ENC[] = {
     0x7E, 0x3B, 0x5A, 0x4D, 0x1A, 0xAE, 0x2B, 0xE8,
     0x7D, 0x6D, 0x5D
 };
-static const size_t QWEN_LEN = 35;
-
-// 组装解密后的密钥
-static char* decrypt_key(const unsigned char* enc, size_t len) {
-    char* result = (char*)malloc(len + 1);
-    if (!result) return NULL;
-
-    xor_decrypt(enc, result, len);
-    result[len] = '\0';
 
-    return result;
-}
-
-JNIEXPORT jstring JNICALL
-Java_com_example_ai_1bookkeeping_SecureKeyStore_getAliyunAccessKeyId(JNIEnv *env, jobject thiz) {
-    char* key = decrypt_key(AK_ID_ENC, AK_ID_LEN);
-    if (!key) return NULL;
-
-    jstring result = (*env)->NewStringUTF(env, key);
-
-    // 清除内存中的密钥
-    memset(key, 0, AK_ID_LEN);
-    free(key);
+// 公开地址（不需要混淆）
+static const char ASR_URL[] = "wss://nls-gateway-cn-shanghai.aliyuncs.com/ws/v1";
+static const char ASR_REST_URL[] = "https://nls-gateway-cn-shanghai.aliyuncs.com/stream/v1/asr";
+static const char TTS_URL[] = "wss://nls-gateway-cn-shanghai.aliyuncs.com/ws/v1";
 
-    return result;
-}
-
-JNIEXPORT jstring JNICALL
-Java_com_example_ai_1bookkeeping_SecureKeyStore_getAliyunAccessKeySecret(JNIEnv *env, jobject thiz) {
-    char* key = decrypt_key(AK_SEC_ENC, AK_SEC_LEN);
-    if (!key) return NULL;
-
-    jstring result = (*env)->NewStringUTF(env, key);
+/**
+ * getAllKeys 返回数组中的顺序，与 SecureKeyStore.kt 中的 KEY_NAMES 一致
+ *
+ * enc 为 NULL 的项是公开地址，直接返回 plain
+ */
+static const struct {
+    const unsigned char* enc;
+    size_t len;
+    const char* plain;
+} KEYS[] = {
+    { AK_ID_ENC, sizeof(AK_ID_ENC), NULL },
+    { AK_SEC_ENC, sizeof(AK_SEC_ENC), NULL },
+    { APP_KEY_ENC, sizeof(APP_KEY_ENC), NULL },
+    { QWEN_ENC, sizeof(QWEN_ENC), NULL },
+    { NULL, 0, ASR_URL },
+    { NULL, 0, ASR_REST_URL },
+    { NULL, 0, TTS_URL },
+};
+#define KEY_COUNT (sizeof(KEYS) / sizeof(KEYS[0]))
 
-    memset(key, 0, AK_SEC_LEN);
-    free(key);
+// 全部密钥解密后（含结尾 '\0'）所需的缓冲区大小
+#define KEYS_BUFFER_SIZE (sizeof(AK_ID_ENC) + sizeof(AK_SEC_ENC) + sizeof(APP_KEY_ENC) + \
+                          sizeof(QWEN_ENC) + 4)
 
-    return result;
+/**
+ * XOR 解密到 dest 并补 '\0'
+ *
+ * XOR 密钥恰好 8 字节，每个密钥都从密钥首字节开始循环，
+ * 因此整 8 字节按一个 64 位字异或，只有末尾不足 8 字节时逐字节处理
+ */
+static void xor_decrypt(const unsigned char* src, char* dest, size_t len) {
+    uint64_t key_word;
+    size_t i = 0;
+
+    memcpy(&key_word, XOR_KEY, sizeof(key_word));
+    for (; i + sizeof(key_word) <= len; i += sizeof(key_word)) {
+        uint64_t word;
+        memcpy(&word, src + i, sizeof(word));
+        word ^= key_word;
+        memcpy(dest + i, &word, sizeof(word));
+    }
+    for (; i < len; i++) {
+        dest[i] = (char)(src[i] ^ XOR_KEY[i % XOR_KEY_LEN]);
+    }
+    dest[len] = '\0';
 }
 
-JNIEXPORT jstring JNICALL
-Java_com_example_ai_1bookkeeping_SecureKeyStore_getAliyunAppKey(JNIEnv *env, jobject thiz) {
-    char* key = decrypt_key(APP_KEY_ENC, APP_KEY_LEN);
-    if (!key) return NULL;
-
-    jstring result = (*env)->NewStringUTF(env, key);
-
-    memset(key, 0, APP_KEY_LEN);
-    free(key);
-
-    return result;
+// 清除栈上的明文；经 volatile 写入，不会被编译器当作死存储优化掉
+static void secure_zero(void* p, size_t len) {
+    volatile unsigned char* v = (volatile unsigned char*)p;
+    while (len--) *v++ = 0;
 }
 
-JNIEXPORT jstring JNICALL
-Java_com_example_ai_1bookkeeping_SecureKeyStore_getQwenApiKey(JNIEnv *env, jobject thiz) {
-    char* key = decrypt_key(QWEN_ENC, QWEN_LEN);
-    if (!key) return NULL;
-
-    jstring result = (*env)->NewStringUTF(env, key);
+/**
+ * 一次 JNI 调用解密并返回全部密钥
+ *
+ * 所有密钥解密到同一块栈缓冲区，创建完 jstring 后立即清零，
+ * 不做堆分配。任何一步失败返回 NULL（并保留挂起的 Java 异常）
+ */
+JNIEXPORT jobjectArray JNICALL
+Java_com_example_ai_1bookkeeping_SecureKeyStore_getAllKeys(JNIEnv *env, jobject thiz) {
+    char buffer[KEYS_BUFFER_SIZE];
+    char* next = buffer;
+    const char* values[KEY_COUNT];
+    jobjectArray result = NULL;
+
+    for (size_t i = 0; i < KEY_COUNT; i++) {
+        if (!KEYS[i].enc) {
+            values[i] = KEYS[i].plain;
+            continue;
+        }
+        xor_decrypt(KEYS[i].enc, next, KEYS[i].len);
+        values[i] = next;
+        next += KEYS[i].len + 1;
+    }
 
-    memset(key, 0, QWEN_LEN);
-    free(key);
+    jclass string_class = (*env)->FindClass(env, "java/lang/String");
+    if (string_class) {
+        result = (*env)->NewObjectArray(env, (jsize)KEY_COUNT, string_class, NULL);
+        (*env)->DeleteLocalRef(env, string_class);
+    }
+    for (size_t i = 0; result && i < KEY_COUNT; i++) {
+        jstring value = (*env)->NewStringUTF(env, values[i]);
+        if (!value) {
+            (*env)->DeleteLocalRef(env, result);
+            result = NULL;
+            break;
+        }
+        (*env)->SetObjectArrayElement(env, result, (jsize)i, value);
+        (*env)->DeleteLocalRef(env, value);
+    }
 
+    // 清除内存中的密钥
+    secure_zero(buffer, sizeof(buffer));
     return result;
 }
-
-// ASR URL (不需要混淆，是公开的)
-JNIEXPORT jstring JNICALL
-Java_com_example_ai_1bookkeeping_SecureKeyStore_getAsrUrl(JNIEnv *env, jobject thiz) {
-    return (*env)->NewStringUTF(env, "wss://nls-gateway-cn-shanghai.aliyuncs.com/ws/v1");
-}
-
-JNIEXPORT jstring JNICALL
-Java_com_example_ai_1bookkeeping_SecureKeyStore_getAsrRestUrl(JNIEnv *env, jobject thiz) {
-    return (*env)->NewStringUTF(env, "https://nls-gateway-cn-shanghai.aliyuncs.com/stream/v1/asr");
-}
-
-JNIEXPORT jstring JNICALL
-Java_com_example_ai_1bookkeeping_SecureKeyStore_getTtsUrl(JNIEnv *env, jobject thiz) {
-    return (*env)->NewStringUTF(env, "wss://nls-gateway-cn-shanghai.aliyuncs.com/ws/v1");
-}
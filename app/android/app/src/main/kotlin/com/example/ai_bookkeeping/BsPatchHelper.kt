@@ -5,6 +5,7 @@ import android.content.pm.ApplicationInfo
 import android.util.Log
 import java.io.File
 import java.security.MessageDigest
+import java.util.concurrent.atomic.AtomicBoolean
 
 /**
  * Helper class for bspatch operations.
@@ -17,6 +18,17 @@ import java.security.MessageDigest
 object BsPatchHelper {
     private const val TAG = "BsPatchHelper"
 
+    /** Error code returned when a [ProgressListener] cancels the patch */
+    const val ERROR_CANCELLED = -13
+
+    /** Checkpoint file of [applyPatchWithVerification], next to the output */
+    const val CHECKPOINT_SUFFIX = ".ckpt"
+
+    /** Digest algorithms [applyPatchEx] can compute over the output */
+    const val DIGEST_NONE = 0
+    const val DIGEST_MD5 = 1
+    const val DIGEST_SHA256 = 2
+
     init {
         try {
             System.loadLibrary("bspatch")
@@ -37,6 +49,62 @@ object BsPatchHelper {
     @JvmStatic
     external fun applyPatch(oldPath: String, newPath: String, patchPath: String): Int
 
+    /**
+     * Receives progress from [applyPatchEx].
+     *
+     * Called on the patching thread about once per MB of output, and once
+     * more when the output is complete.
+     */
+    fun interface ProgressListener {
+        /**
+         * @param bytesWritten Bytes of the new APK written so far
+         * @param totalBytes Final size of the new APK
+         * @return true to continue, false to cancel the patch
+         */
+        fun onProgress(bytesWritten: Long, totalBytes: Long): Boolean
+    }
+
+    /**
+     * Apply a bsdiff patch, reporting progress, allowing cancellation and
+     * hashing the output as it is written.
+     *
+     * @param listener Progress listener, or null for no reporting
+     * @param digestAlgorithm One of [DIGEST_NONE], [DIGEST_MD5], [DIGEST_SHA256]
+     * @param digestOut Receives the digest on success (16 bytes for MD5, 32 for SHA-256)
+     * @return 0 on success, [ERROR_CANCELLED] if cancelled, other negative
+     *         error code on failure
+     */
+    @JvmStatic
+    external fun applyPatchEx(
+        oldPath: String,
+        newPath: String,
+        patchPath: String,
+        listener: ProgressListener?,
+        digestAlgorithm: Int,
+        digestOut: ByteArray?
+    ): Int
+
+    /**
+     * Same as [applyPatchEx], but checkpoints the apply state to
+     * [checkpointPath] every few MB of output. If a checkpoint of an
+     * interrupted run of the same patch exists (the process was killed, or
+     * the listener cancelled), patching continues from it and the listener
+     * first sees the restored position.
+     *
+     * On success the checkpoint is removed; after [ERROR_CANCELLED] the
+     * partial output and checkpoint are kept for the next call.
+     */
+    @JvmStatic
+    external fun applyPatchResumable(
+        oldPath: String,
+        newPath: String,
+        patchPath: String,
+        checkpointPath: String,
+        listener: ProgressListener?,
+        digestAlgorithm: Int,
+        digestOut: ByteArray?
+    ): Int
+
     /**
      * Get error message for a bspatch error code.
      *
@@ -96,15 +164,7 @@ object BsPatchHelper {
                 }
             }
 
-            val digest = md.digest()
-            val hexString = StringBuilder()
-            for (b in digest) {
-                val hex = Integer.toHexString(0xff and b.toInt())
-                if (hex.length == 1) hexString.append('0')
-                hexString.append(hex)
-            }
-
-            hexString.toString().lowercase()
+            toHex(md.digest())
         } catch (e: Exception) {
             Log.e(TAG, "Failed to calculate MD5: ${e.message}")
             null
@@ -112,12 +172,36 @@ object BsPatchHelper {
     }
 
     /**
-     * Apply patch with MD5 verification.
+     * Convert a digest to a lowercase hex string.
+     */
+    private fun toHex(digest: ByteArray): String {
+        val hexString = StringBuilder()
+        for (b in digest) {
+            val hex = Integer.toHexString(0xff and b.toInt())
+            if (hex.length == 1) hexString.append('0')
+            hexString.append(hex)
+        }
+        return hexString.toString().lowercase()
+    }
+
+    /**
+     * Apply patch with digest verification.
+     *
+     * The digest is computed natively while the output is written, so
+     * verification needs no second pass over the APK. SHA-256 is preferred
+     * when both expected values are given.
+     *
+     * A patch interrupted by a process kill or [cancelSignal] resumes from
+     * its checkpoint ([outputPath] + [CHECKPOINT_SUFFIX]) when called again
+     * with the same arguments.
      *
      * @param context Application context
      * @param patchPath Path to the patch file
      * @param outputPath Path for the output APK
      * @param expectedMd5 Expected MD5 of the output APK (optional)
+     * @param expectedSha256 Expected SHA-256 of the output APK (optional)
+     * @param onProgress Called with the completed percentage (0-100) whenever it changes
+     * @param cancelSignal Set to true from any thread to abort the patch
      * @return Result containing success status and output path or error message
      */
     @JvmStatic
@@ -125,7 +209,10 @@ object BsPatchHelper {
         context: Context,
         patchPath: String,
         outputPath: String,
-        expectedMd5: String? = null
+        expectedMd5: String? = null,
+        expectedSha256: String? = null,
+        onProgress: ((Int) -> Unit)? = null,
+        cancelSignal: AtomicBoolean? = null
     ): PatchResult {
         // Get current APK path
         val currentApkPath = getCurrentApkPath(context)
@@ -139,7 +226,29 @@ object BsPatchHelper {
         Log.i(TAG, "Applying patch: $currentApkPath + $patchPath -> $outputPath")
 
         // Apply patch
-        val result = applyPatch(currentApkPath, outputPath, patchPath)
+        var lastPercent = -1
+        val listener = ProgressListener { bytesWritten, totalBytes ->
+            val percent = if (totalBytes > 0) (bytesWritten * 100 / totalBytes).toInt() else 100
+            if (percent != lastPercent) {
+                lastPercent = percent
+                onProgress?.invoke(percent)
+            }
+            cancelSignal?.get() != true
+        }
+        val (digestAlgorithm, expectedDigest) = when {
+            !expectedSha256.isNullOrEmpty() -> DIGEST_SHA256 to expectedSha256
+            !expectedMd5.isNullOrEmpty() -> DIGEST_MD5 to expectedMd5
+            else -> DIGEST_NONE to null
+        }
+        val digestOut = ByteArray(32)
+        val result = applyPatchResumable(
+            currentApkPath, outputPath, patchPath, outputPath + CHECKPOINT_SUFFIX,
+            listener, digestAlgorithm, digestOut
+        )
+        if (result == ERROR_CANCELLED) {
+            Log.i(TAG, "Patch cancelled, checkpoint kept for resume")
+            return PatchResult.failure("Patch cancelled")
+        }
         if (result != 0) {
             val errorMsg = getErrorMessage(result)
             Log.e(TAG, "Patch failed: $errorMsg (code: $result)")
@@ -152,21 +261,19 @@ object BsPatchHelper {
             return PatchResult.failure("Output file was not created")
         }
 
-        // Verify MD5 if provided
-        if (expectedMd5 != null && expectedMd5.isNotEmpty()) {
-            val actualMd5 = calculateMd5(outputPath)
-            if (actualMd5 == null) {
-                outputFile.delete()
-                return PatchResult.failure("Failed to calculate output MD5")
-            }
+        // Verify digest if provided
+        if (expectedDigest != null) {
+            val name = if (digestAlgorithm == DIGEST_SHA256) "SHA-256" else "MD5"
+            val size = if (digestAlgorithm == DIGEST_SHA256) 32 else 16
+            val actualDigest = toHex(digestOut.copyOf(size))
 
-            if (actualMd5.lowercase() != expectedMd5.lowercase()) {
-                Log.e(TAG, "MD5 mismatch! Expected: $expectedMd5, Actual: $actualMd5")
+            if (actualDigest != expectedDigest.lowercase()) {
+                Log.e(TAG, "$name mismatch! Expected: $expectedDigest, Actual: $actualDigest")
                 outputFile.delete()
-                return PatchResult.failure("MD5 verification failed")
+                return PatchResult.failure("$name verification failed")
             }
 
-            Log.i(TAG, "MD5 verification passed: $actualMd5")
+            Log.i(TAG, "$name verification passed: $actualDigest")
         }
 
         Log.i(TAG, "Patch applied successfully: $outputPath")
@@ -12,6 +12,7 @@ import io.flutter.plugin.common.MethodChannel
 import io.flutter.plugin.common.EventChannel
 import java.io.File
 import java.io.FileOutputStream
+import java.util.concurrent.atomic.AtomicBoolean
 
 class MainActivity : FlutterActivity() {
 
@@ -32,6 +33,7 @@ class MainActivity : FlutterActivity() {
     private var eventSink: EventChannel.EventSink? = null
     private var deepLinkEventSink: EventChannel.EventSink? = null
     private var pendingDeepLink: String? = null
+    private val patchCancelSignal = AtomicBoolean(false)
 
     override fun configureFlutterEngine(flutterEngine: FlutterEngine) {
         super.configureFlutterEngine(flutterEngine)
@@ -466,12 +468,14 @@ class MainActivity : FlutterActivity() {
             }
         )
 
-        MethodChannel(flutterEngine.dartExecutor.binaryMessenger, CHANNEL).setMethodCallHandler { call, result ->
+        val bspatchChannel = MethodChannel(flutterEngine.dartExecutor.binaryMessenger, CHANNEL)
+        bspatchChannel.setMethodCallHandler { call, result ->
             when (call.method) {
                 "applyPatch" -> {
                     val patchPath = call.argument<String>("patch")
                     val outputPath = call.argument<String>("output")
                     val expectedMd5 = call.argument<String>("expectedMd5")
+                    val expectedSha256 = call.argument<String>("expectedSha256")
 
                     if (patchPath == null || outputPath == null) {
                         result.error("INVALID_ARGS", "patch and output paths are required", null)
@@ -479,12 +483,20 @@ class MainActivity : FlutterActivity() {
                     }
 
                     // Run patch in background thread
+                    patchCancelSignal.set(false)
                     Thread {
                         val patchResult = BsPatchHelper.applyPatchWithVerification(
                             context = applicationContext,
                             patchPath = patchPath,
                             outputPath = outputPath,
-                            expectedMd5 = expectedMd5
+                            expectedMd5 = expectedMd5,
+                            expectedSha256 = expectedSha256,
+                            onProgress = { percent ->
+                                runOnUiThread {
+                                    bspatchChannel.invokeMethod("onPatchProgress", percent)
+                                }
+                            },
+                            cancelSignal = patchCancelSignal
                         )
 
                         runOnUiThread {
@@ -503,6 +515,11 @@ class MainActivity : FlutterActivity() {
                     }.start()
                 }
 
+                "cancelPatch" -> {
+                    patchCancelSignal.set(true)
+                    result.success(true)
+                }
+
                 "getCurrentApkPath" -> {
                     val apkPath = BsPatchHelper.getCurrentApkPath(applicationContext)
                     result.success(apkPath)
@@ -1,5 +1,8 @@
 package com.example.ai_bookkeeping
 
+import android.os.Handler
+import android.os.Looper
+import android.util.Log
 import io.flutter.embedding.engine.FlutterEngine
 import io.flutter.plugin.common.MethodChannel
 
@@ -7,69 +10,89 @@ import io.flutter.plugin.common.MethodChannel
  * 安全密钥存储
  *
  * 通过 JNI 从 Native 层获取密钥，避免在 Dart/Kotlin 代码中明文存储。
+ * secure_keys 库在第一次取密钥时才于后台线程加载，并通过一次 JNI 调用
+ * 解密全部密钥后缓存，不占用冷启动的主线程。
  */
 class SecureKeyStore {
     companion object {
+        private const val TAG = "SecureKeyStore"
         private const val CHANNEL = "com.example.ai_bookkeeping/secure_keys"
 
-        init {
+        /** getAllKeys 返回数组的顺序，与 secure_keys.c 中的 KEYS 一致 */
+        private val KEY_NAMES = arrayOf(
+            "accessKeyId",
+            "accessKeySecret",
+            "appKey",
+            "qwenApiKey",
+            "asrUrl",
+            "asrRestUrl",
+            "ttsUrl"
+        )
+
+        /** 单个密钥的方法名到 [KEY_NAMES] 中名称的映射 */
+        private val METHOD_KEYS = mapOf(
+            "getAliyunAccessKeyId" to "accessKeyId",
+            "getAliyunAccessKeySecret" to "accessKeySecret",
+            "getAliyunAppKey" to "appKey",
+            "getQwenApiKey" to "qwenApiKey",
+            "getAsrUrl" to "asrUrl",
+            "getAsrRestUrl" to "asrRestUrl",
+            "getTtsUrl" to "ttsUrl"
+        )
+
+        private val mainHandler = Handler(Looper.getMainLooper())
+
+        /**
+         * 解密后的全部密钥，首次访问时加载库并解密一次
+         *
+         * lazy 默认同步，并发的首次请求只会解密一次
+         */
+        private val keys: Lazy<Map<String, String>> = lazy {
             System.loadLibrary("secure_keys")
+            val values = SecureKeyStore().getAllKeys()
+            KEY_NAMES.zip(values).toMap()
         }
 
+        private fun valueFor(method: String): Any? =
+            if (method == "getAllKeys") keys.value else keys.value[METHOD_KEYS[method]]
+
         /**
          * 注册 Flutter MethodChannel
+         *
+         * 只注册通道，不加载 Native 库
          */
         fun registerWith(flutterEngine: FlutterEngine) {
-            val keyStore = SecureKeyStore()
-
             MethodChannel(flutterEngine.dartExecutor.binaryMessenger, CHANNEL).setMethodCallHandler { call, result ->
-                when (call.method) {
-                    "getAliyunAccessKeyId" -> {
-                        result.success(keyStore.getAliyunAccessKeyId())
-                    }
-                    "getAliyunAccessKeySecret" -> {
-                        result.success(keyStore.getAliyunAccessKeySecret())
-                    }
-                    "getAliyunAppKey" -> {
-                        result.success(keyStore.getAliyunAppKey())
-                    }
-                    "getQwenApiKey" -> {
-                        result.success(keyStore.getQwenApiKey())
-                    }
-                    "getAsrUrl" -> {
-                        result.success(keyStore.getAsrUrl())
-                    }
-                    "getAsrRestUrl" -> {
-                        result.success(keyStore.getAsrRestUrl())
-                    }
-                    "getTtsUrl" -> {
-                        result.success(keyStore.getTtsUrl())
-                    }
-                    "getAllKeys" -> {
-                        result.success(mapOf(
-                            "accessKeyId" to keyStore.getAliyunAccessKeyId(),
-                            "accessKeySecret" to keyStore.getAliyunAccessKeySecret(),
-                            "appKey" to keyStore.getAliyunAppKey(),
-                            "qwenApiKey" to keyStore.getQwenApiKey(),
-                            "asrUrl" to keyStore.getAsrUrl(),
-                            "asrRestUrl" to keyStore.getAsrRestUrl(),
-                            "ttsUrl" to keyStore.getTtsUrl()
-                        ))
+                val method = call.method
+                if (method != "getAllKeys" && method !in METHOD_KEYS) {
+                    result.notImplemented()
+                    return@setMethodCallHandler
+                }
+
+                // 已缓存时直接返回；库加载与解密只在首次调用时发生，放到后台线程
+                if (keys.isInitialized()) {
+                    result.success(valueFor(method))
+                    return@setMethodCallHandler
+                }
+                Thread {
+                    val value: Any? = try {
+                        valueFor(method)
+                    } catch (e: Throwable) {
+                        Log.e(TAG, "Failed to load keys: ${e.message}")
+                        null
                     }
-                    else -> {
-                        result.notImplemented()
+                    mainHandler.post {
+                        if (value != null) {
+                            result.success(value)
+                        } else {
+                            result.error("UNAVAILABLE", "secure_keys unavailable", null)
+                        }
                     }
-                }
+                }.start()
             }
         }
     }
 
-    // Native 方法声明
-    external fun getAliyunAccessKeyId(): String
-    external fun getAliyunAccessKeySecret(): String
-    external fun getAliyunAppKey(): String
-    external fun getQwenApiKey(): String
-    external fun getAsrUrl(): String
-    external fun getAsrRestUrl(): String
-    external fun getTtsUrl(): String
+    // Native 方法声明：一次返回全部密钥，顺序见 KEY_NAMES
+    external fun getAllKeys(): Array<String>
 }
@@ -38,13 +38,31 @@ class PatchResult {
 class BsPatchService {
   static final BsPatchService _instance = BsPatchService._internal();
   factory BsPatchService() => _instance;
-  BsPatchService._internal();
+  BsPatchService._internal() {
+    _channel.setMethodCallHandler(_handleNativeCall);
+  }
 
   static const MethodChannel _channel =
       MethodChannel('com.example.ai_bookkeeping/bspatch');
 
+  /// 原生端断点文件相对输出 APK 的后缀（与 BsPatchHelper.CHECKPOINT_SUFFIX 一致）
+  ///
+  /// 进程被杀或取消后，再次对同一输出路径应用同一补丁会从断点续传
+  static const String checkpointSuffix = '.ckpt';
+
   final Logger _logger = Logger();
 
+  /// 当前补丁的进度回调（0-100）
+  void Function(int percent)? _onProgress;
+
+  /// 处理原生端回调
+  Future<void> _handleNativeCall(MethodCall call) async {
+    if (call.method == 'onPatchProgress') {
+      final percent = call.arguments as int? ?? 0;
+      _onProgress?.call(percent);
+    }
+  }
+
   /// 检查平台是否支持 bspatch
   bool get isSupported => Platform.isAndroid;
 
@@ -73,15 +91,23 @@ class BsPatchService {
   /// [patchPath] 补丁文件路径
   /// [outputPath] 输出 APK 路径
   /// [expectedMd5] 预期的输出文件 MD5（可选，用于验证）
+  /// [expectedSha256] 预期的输出文件 SHA-256（可选，优先于 MD5）
+  /// [onProgress] 补丁进度回调（0-100），可调用 [cancelPatch] 中止
+  ///
+  /// 摘要在原生端写出时同步计算，校验无需再次读取输出文件。
+  /// 原生端每写出几 MB 保存一次断点，中断后以相同参数再次调用即可续传
   Future<PatchResult> applyPatch({
     required String patchPath,
     required String outputPath,
     String? expectedMd5,
+    String? expectedSha256,
+    void Function(int percent)? onProgress,
   }) async {
     if (!isSupported) {
       return PatchResult.failure('Platform not supported');
     }
 
+    _onProgress = onProgress;
     try {
       _logger.info(
         'Applying patch: $patchPath -> $outputPath',
@@ -94,6 +120,7 @@ class BsPatchService {
           'patch': patchPath,
           'output': outputPath,
           'expectedMd5': expectedMd5,
+          'expectedSha256': expectedSha256,
         },
       );
 
@@ -120,6 +147,22 @@ class BsPatchService {
     } catch (e) {
       _logger.error('Unexpected error: $e', tag: 'BsPatch');
       return PatchResult.failure('Unexpected error: $e');
+    } finally {
+      _onProgress = null;
+    }
+  }
+
+  /// 取消正在进行的补丁应用
+  ///
+  /// 原生端会在下一个进度点停止，[applyPatch] 返回失败结果
+  Future<void> cancelPatch() async {
+    if (!isSupported) return;
+
+    try {
+      await _channel.invokeMethod('cancelPatch');
+      _logger.info('Patch cancellation requested', tag: 'BsPatch');
+    } on PlatformException catch (e) {
+      _logger.error('Failed to cancel patch: ${e.message}', tag: 'BsPatch');
     }
   }
 
@@ -154,7 +197,9 @@ class BsPatchService {
     required String patchPath,
     required String targetVersion,
     String? expectedMd5,
+    String? expectedSha256,
     String? outputDir,
+    void Function(int percent)? onProgress,
   }) async {
     if (!isSupported) {
       return PatchResult.failure('Incremental update not supported on this platform');
@@ -181,9 +226,10 @@ class BsPatchService {
       outputPath = '$patchDir/ai_bookkeeping_$targetVersion.apk';
     }
 
-    // 删除已存在的输出文件
+    // 删除已存在的输出文件；有断点文件时保留，原生端从断点续传
     final outputFile = File(outputPath);
-    if (await outputFile.exists()) {
+    final checkpointFile = File('$outputPath$checkpointSuffix');
+    if (await outputFile.exists() && !await checkpointFile.exists()) {
       await outputFile.delete();
     }
 
@@ -192,6 +238,8 @@ class BsPatchService {
       patchPath: patchPath,
       outputPath: outputPath,
       expectedMd5: expectedMd5,
+      expectedSha256: expectedSha256,
+      onProgress: onProgress,
     );
   }
 }
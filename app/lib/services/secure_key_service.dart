@@ -18,6 +18,8 @@ class SecureKeyService {
   Map<String, String>? _cachedKeys;
 
   /// 获取所有密钥
+  ///
+  /// 原生端一次 JNI 调用解密全部密钥，下面的单项获取都从这份缓存读取
   Future<Map<String, String>> getAllKeys() async {
     if (_cachedKeys != null) {
       return _cachedKeys!;
@@ -37,74 +39,25 @@ class SecureKeyService {
   }
 
   /// 获取阿里云 AccessKey ID
-  Future<String?> getAliyunAccessKeyId() async {
-    try {
-      return await _channel.invokeMethod<String>('getAliyunAccessKeyId');
-    } catch (e) {
-      debugPrint('[SecureKeyService] 获取 AccessKeyId 失败: $e');
-      return null;
-    }
-  }
+  Future<String?> getAliyunAccessKeyId() async => (await getAllKeys())['accessKeyId'];
 
   /// 获取阿里云 AccessKey Secret
-  Future<String?> getAliyunAccessKeySecret() async {
-    try {
-      return await _channel.invokeMethod<String>('getAliyunAccessKeySecret');
-    } catch (e) {
-      debugPrint('[SecureKeyService] 获取 AccessKeySecret 失败: $e');
-      return null;
-    }
-  }
+  Future<String?> getAliyunAccessKeySecret() async => (await getAllKeys())['accessKeySecret'];
 
   /// 获取阿里云 AppKey
-  Future<String?> getAliyunAppKey() async {
-    try {
-      return await _channel.invokeMethod<String>('getAliyunAppKey');
-    } catch (e) {
-      debugPrint('[SecureKeyService] 获取 AppKey 失败: $e');
-      return null;
-    }
-  }
+  Future<String?> getAliyunAppKey() async => (await getAllKeys())['appKey'];
 
   /// 获取通义千问 API Key
-  Future<String?> getQwenApiKey() async {
-    try {
-      return await _channel.invokeMethod<String>('getQwenApiKey');
-    } catch (e) {
-      debugPrint('[SecureKeyService] 获取 QwenApiKey 失败: $e');
-      return null;
-    }
-  }
+  Future<String?> getQwenApiKey() async => (await getAllKeys())['qwenApiKey'];
 
   /// 获取 ASR WebSocket URL
-  Future<String?> getAsrUrl() async {
-    try {
-      return await _channel.invokeMethod<String>('getAsrUrl');
-    } catch (e) {
-      debugPrint('[SecureKeyService] 获取 AsrUrl 失败: $e');
-      return null;
-    }
-  }
+  Future<String?> getAsrUrl() async => (await getAllKeys())['asrUrl'];
 
   /// 获取 ASR REST URL
-  Future<String?> getAsrRestUrl() async {
-    try {
-      return await _channel.invokeMethod<String>('getAsrRestUrl');
-    } catch (e) {
-      debugPrint('[SecureKeyService] 获取 AsrRestUrl 失败: $e');
-      return null;
-    }
-  }
+  Future<String?> getAsrRestUrl() async => (await getAllKeys())['asrRestUrl'];
 
   /// 获取 TTS WebSocket URL
-  Future<String?> getTtsUrl() async {
-    try {
-      return await _channel.invokeMethod<String>('getTtsUrl');
-    } catch (e) {
-      debugPrint('[SecureKeyService] 获取 TtsUrl 失败: $e');
-      return null;
-    }
-  }
+  Future<String?> getTtsUrl() async => (await getAllKeys())['ttsUrl'];
 
   /// 清除缓存
   void clearCache() {
@@ -119,6 +119,16 @@ class AudioProcessorService {
     }
   }
 
+  /// 处理麦克风采集的音频并返回 VAD 判决
+  ///
+  /// 需先 [setVadEnabled]；未启用处理时原样返回并视为语音
+  Future<ApmCaptureResult> processAudioWithVad(Uint8List audioData) async {
+    if (!_isInitialized || !_isEnabled) {
+      return ApmCaptureResult(audioData: audioData, isSpeech: true);
+    }
+    return _processor.processAudioWithVad(audioData);
+  }
+
   /// 输入 TTS 播放的音频作为 AEC 参考信号
   ///
   /// [audioData] TTS 播放的 PCM16 音频数据
@@ -151,6 +161,12 @@ class AudioProcessorService {
     await _processor.setAgcEnabled(enabled);
   }
 
+  /// 启用/禁用 VAD，静音段跳过 AEC/NS/AGC 以节省耗时
+  Future<void> setVadEnabled(bool enabled) async {
+    if (!_isInitialized) return;
+    await _processor.setVadEnabled(enabled);
+  }
+
   /// 应用环境噪声校准结果
   ///
   /// 根据校准结果动态调整 NS 抑制级别（自适应模式）
@@ -1,6 +1,12 @@
 #include "my_application.h"
+#include "startup.h"
 
 int main(int argc, char** argv) {
+  startup_trace_begin();
+  if (startup_prewarm_enabled()) {
+    startup_prewarm_project();
+  }
+
   g_autoptr(MyApplication) app = my_application_new();
   return g_application_run(G_APPLICATION(app), argc, argv);
 }
@@ -6,6 +6,7 @@
 #endif
 
 #include "flutter/generated_plugin_registrant.h"
+#include "startup.h"
 
 struct _MyApplication {
   GtkApplication parent_instance;
@@ -14,6 +15,21 @@ struct _MyApplication {
 
 G_DEFINE_TYPE(MyApplication, my_application, GTK_TYPE_APPLICATION)
 
+// Called when the first Flutter frame is rendered.
+static void first_frame_cb(FlView* view, gpointer user_data) {
+  g_signal_handlers_disconnect_by_func(view, reinterpret_cast<gpointer>(first_frame_cb), user_data);
+  startup_trace_mark("first_frame");
+
+  // A pre-warmed window stays hidden until there is something to show.
+  gtk_widget_show(gtk_widget_get_toplevel(GTK_WIDGET(view)));
+
+  if (startup_defer_plugins_enabled()) {
+    register_deferred_plugins(FL_PLUGIN_REGISTRY(view));
+    startup_trace_mark("deferred_plugins_registered");
+  }
+  startup_trace_write();
+}
+
 // Implements GApplication::activate.
 static void my_application_activate(GApplication* application) {
   MyApplication* self = MY_APPLICATION(application);
@@ -48,7 +64,11 @@ static void my_application_activate(GApplication* application) {
   }
 
   gtk_window_set_default_size(window, 1280, 720);
-  gtk_widget_show(GTK_WIDGET(window));
+  gboolean prewarm = startup_prewarm_enabled();
+  if (!prewarm) {
+    gtk_widget_show(GTK_WIDGET(window));
+  }
+  startup_trace_mark("window_created");
 
   g_autoptr(FlDartProject) project = fl_dart_project_new();
   fl_dart_project_set_dart_entrypoint_arguments(project, self->dart_entrypoint_arguments);
@@ -56,8 +76,21 @@ static void my_application_activate(GApplication* application) {
   FlView* view = fl_view_new(project);
   gtk_widget_show(GTK_WIDGET(view));
   gtk_container_add(GTK_CONTAINER(window), GTK_WIDGET(view));
+  startup_trace_mark("engine_init");
+
+  g_signal_connect(view, "first-frame", G_CALLBACK(first_frame_cb), self);
+  if (prewarm) {
+    // Realizing the hidden window lets the engine start rendering while the
+    // window manager has nothing to map yet; first_frame_cb shows it.
+    gtk_widget_realize(GTK_WIDGET(view));
+  }
 
-  fl_register_plugins(FL_PLUGIN_REGISTRY(view));
+  if (startup_defer_plugins_enabled()) {
+    register_startup_plugins(FL_PLUGIN_REGISTRY(view));
+  } else {
+    fl_register_plugins(FL_PLUGIN_REGISTRY(view));
+  }
+  startup_trace_mark("plugins_registered");
 
   gtk_widget_grab_focus(GTK_WIDGET(view));
 }
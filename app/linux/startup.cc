@@ -0,0 +1,126 @@
+#include "startup.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <file_selector_linux/file_selector_plugin.h>
+#include <flutter_secure_storage_linux/flutter_secure_storage_linux_plugin.h>
+#include <record_linux/record_linux_plugin.h>
+#include <url_launcher_linux/url_launcher_plugin.h>
+
+namespace {
+
+constexpr int kMaxTraceEvents = 16;
+
+struct TraceEvent {
+  const gchar* name;
+  gint64 time_us;
+};
+
+gchar* trace_path = nullptr;
+gint64 trace_start_us = 0;
+TraceEvent trace_events[kMaxTraceEvents];
+int trace_event_count = 0;
+
+// Returns TRUE if the environment variable |name| is set to anything but
+// an empty string or "0".
+gboolean env_flag(const gchar* name) {
+  const gchar* value = g_getenv(name);
+  return value != nullptr && value[0] != '\0' && g_strcmp0(value, "0") != 0;
+}
+
+// Starts kernel readahead of |path|. Missing files are skipped silently as
+// the bundle layout differs between debug and release builds.
+void prewarm_file(const gchar* path) {
+  int fd = open(path, O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return;
+  }
+  posix_fadvise(fd, 0, 0, POSIX_FADV_WILLNEED);
+  close(fd);
+}
+
+}  // namespace
+
+void startup_trace_begin() {
+  trace_start_us = g_get_monotonic_time();
+  const gchar* path = g_getenv("AI_BOOKKEEPING_STARTUP_TRACE");
+  if (path != nullptr && path[0] != '\0') {
+    trace_path = g_strdup(path);
+  }
+}
+
+void startup_trace_mark(const gchar* event) {
+  if (trace_path == nullptr || trace_event_count == kMaxTraceEvents) {
+    return;
+  }
+  trace_events[trace_event_count++] = {event, g_get_monotonic_time()};
+}
+
+void startup_trace_write() {
+  if (trace_path == nullptr) {
+    return;
+  }
+
+  g_autoptr(GString) contents = g_string_new(nullptr);
+  gint64 previous_us = trace_start_us;
+  for (int i = 0; i < trace_event_count; i++) {
+    const TraceEvent& event = trace_events[i];
+    g_string_append_printf(contents,
+                           "%s\t%" G_GINT64_FORMAT "\t%" G_GINT64_FORMAT "\n",
+                           event.name, event.time_us - trace_start_us,
+                           event.time_us - previous_us);
+    previous_us = event.time_us;
+  }
+
+  g_autoptr(GError) error = nullptr;
+  if (!g_file_set_contents(trace_path, contents->str, contents->len, &error)) {
+    g_warning("Failed to write startup trace: %s", error->message);
+  }
+  g_clear_pointer(&trace_path, g_free);
+}
+
+gboolean startup_prewarm_enabled() {
+  return env_flag("AI_BOOKKEEPING_PREWARM");
+}
+
+gboolean startup_defer_plugins_enabled() {
+  return env_flag("AI_BOOKKEEPING_DEFER_PLUGINS");
+}
+
+void startup_prewarm_project() {
+  g_autofree gchar* executable = g_file_read_link("/proc/self/exe", nullptr);
+  if (executable == nullptr) {
+    return;
+  }
+  g_autofree gchar* bundle = g_path_get_dirname(executable);
+
+  // Same locations FlDartProject resolves against the executable.
+  g_autofree gchar* aot_library = g_build_filename(bundle, "lib", "libapp.so", nullptr);
+  g_autofree gchar* icu_data = g_build_filename(bundle, "data", "icudtl.dat", nullptr);
+  g_autofree gchar* kernel_blob = g_build_filename(
+      bundle, "data", "flutter_assets", "kernel_blob.bin", nullptr);
+  prewarm_file(aot_library);
+  prewarm_file(icu_data);
+  prewarm_file(kernel_blob);
+}
+
+void register_startup_plugins(FlPluginRegistry* registry) {
+  // Read by the auth and HTTP services right after the first frame.
+  g_autoptr(FlPluginRegistrar) flutter_secure_storage_linux_registrar =
+      fl_plugin_registry_get_registrar_for_plugin(registry, "FlutterSecureStorageLinuxPlugin");
+  flutter_secure_storage_linux_plugin_register_with_registrar(flutter_secure_storage_linux_registrar);
+  // The wake-up service may start listening during startup.
+  g_autoptr(FlPluginRegistrar) record_linux_registrar =
+      fl_plugin_registry_get_registrar_for_plugin(registry, "RecordLinuxPlugin");
+  record_linux_plugin_register_with_registrar(record_linux_registrar);
+}
+
+void register_deferred_plugins(FlPluginRegistry* registry) {
+  g_autoptr(FlPluginRegistrar) file_selector_linux_registrar =
+      fl_plugin_registry_get_registrar_for_plugin(registry, "FileSelectorPlugin");
+  file_selector_plugin_register_with_registrar(file_selector_linux_registrar);
+  g_autoptr(FlPluginRegistrar) url_launcher_linux_registrar =
+      fl_plugin_registry_get_registrar_for_plugin(registry, "UrlLauncherPlugin");
+  url_launcher_plugin_register_with_registrar(url_launcher_linux_registrar);
+}
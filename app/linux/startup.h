@@ -0,0 +1,81 @@
+#ifndef FLUTTER_STARTUP_H_
+#define FLUTTER_STARTUP_H_
+
+#include <flutter_linux/flutter_linux.h>
+
+// Startup-time helpers for the runner. Everything here is controlled by
+// environment variables so release builds behave exactly like the stock
+// runner unless a variable is set:
+//
+//   AI_BOOKKEEPING_STARTUP_TRACE=<path>  record startup milestones to <path>.
+//   AI_BOOKKEEPING_PREWARM=1             warm the Dart project files and start
+//                                        the engine before the window is shown.
+//   AI_BOOKKEEPING_DEFER_PLUGINS=1       register plugins that are only used
+//                                        on user action after the first frame.
+
+/**
+ * startup_trace_begin:
+ *
+ * Starts the startup trace if AI_BOOKKEEPING_STARTUP_TRACE is set. Call as
+ * early as possible in main(); all timestamps are relative to this call.
+ */
+void startup_trace_begin();
+
+/**
+ * startup_trace_mark:
+ * @event: a static string naming the milestone.
+ *
+ * Records the monotonic time of @event. No-op when tracing is disabled.
+ */
+void startup_trace_mark(const gchar* event);
+
+/**
+ * startup_trace_write:
+ *
+ * Writes the recorded milestones to the trace file, one
+ * "event<TAB>elapsed_us<TAB>delta_us" line each. Only the first call writes.
+ */
+void startup_trace_write();
+
+/**
+ * startup_prewarm_enabled:
+ *
+ * Returns: %TRUE if AI_BOOKKEEPING_PREWARM is set.
+ */
+gboolean startup_prewarm_enabled();
+
+/**
+ * startup_defer_plugins_enabled:
+ *
+ * Returns: %TRUE if AI_BOOKKEEPING_DEFER_PLUGINS is set.
+ */
+gboolean startup_defer_plugins_enabled();
+
+/**
+ * startup_prewarm_project:
+ *
+ * Asks the kernel to read the AOT snapshot and ICU data of the bundle into the
+ * page cache in the background, so the engine does not fault them in from
+ * disk on a cold start.
+ */
+void startup_prewarm_project();
+
+/**
+ * register_startup_plugins:
+ * @registry: the plugin registry of the Flutter view.
+ *
+ * Registers the plugins the app uses while starting up. Together with
+ * register_deferred_plugins() this mirrors fl_register_plugins(); keep both
+ * in step with flutter/generated_plugin_registrant.cc.
+ */
+void register_startup_plugins(FlPluginRegistry* registry);
+
+/**
+ * register_deferred_plugins:
+ * @registry: the plugin registry of the Flutter view.
+ *
+ * Registers the plugins that are only used on user action.
+ */
+void register_deferred_plugins(FlPluginRegistry* registry);
+
+#endif  // FLUTTER_STARTUP_H_
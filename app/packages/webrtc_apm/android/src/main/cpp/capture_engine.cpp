@@ -0,0 +1,239 @@
+#include "capture_engine.h"
+#include "include/audio_processor.h"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <ctime>
+#include <dlfcn.h>
+#include <mutex>
+
+#define LOG_TAG "WebRTC_APM_Capture"
+#include "apm_log.h"
+
+namespace webrtc_apm {
+
+namespace {
+    int64_t MonotonicNowNs() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    /**
+     * 运行时加载的 AAudio 接口
+     *
+     * minSdk 低于 26 时不能直接链接 libaaudio.so，按需 dlopen 后解析所用的符号。
+     * setInputPreset 为 API 28 新增，缺失时跳过
+     */
+    struct AAudioApi {
+        aaudio_result_t (*createStreamBuilder)(AAudioStreamBuilder**) = nullptr;
+        void (*setDirection)(AAudioStreamBuilder*, aaudio_direction_t) = nullptr;
+        void (*setSampleRate)(AAudioStreamBuilder*, int32_t) = nullptr;
+        void (*setChannelCount)(AAudioStreamBuilder*, int32_t) = nullptr;
+        void (*setFormat)(AAudioStreamBuilder*, aaudio_format_t) = nullptr;
+        void (*setPerformanceMode)(AAudioStreamBuilder*, aaudio_performance_mode_t) = nullptr;
+        void (*setSharingMode)(AAudioStreamBuilder*, aaudio_sharing_mode_t) = nullptr;
+        void (*setInputPreset)(AAudioStreamBuilder*, aaudio_input_preset_t) = nullptr;
+        void (*setDataCallback)(AAudioStreamBuilder*, AAudioStream_dataCallback, void*) = nullptr;
+        void (*setErrorCallback)(AAudioStreamBuilder*, AAudioStream_errorCallback, void*) = nullptr;
+        aaudio_result_t (*openStream)(AAudioStreamBuilder*, AAudioStream**) = nullptr;
+        aaudio_result_t (*deleteBuilder)(AAudioStreamBuilder*) = nullptr;
+        aaudio_result_t (*requestStart)(AAudioStream*) = nullptr;
+        aaudio_result_t (*requestStop)(AAudioStream*) = nullptr;
+        aaudio_result_t (*close)(AAudioStream*) = nullptr;
+        int32_t (*getSampleRate)(AAudioStream*) = nullptr;
+        int32_t (*getChannelCount)(AAudioStream*) = nullptr;
+        aaudio_format_t (*getFormat)(AAudioStream*) = nullptr;
+        int32_t (*getBufferCapacityInFrames)(AAudioStream*) = nullptr;
+        const char* (*convertResultToText)(aaudio_result_t) = nullptr;
+        bool loaded = false;
+    };
+
+    template <typename T>
+    bool Resolve(void* library, const char* name, T* function) {
+        *function = reinterpret_cast<T>(dlsym(library, name));
+        return *function != nullptr;
+    }
+
+    const AAudioApi& LoadAAudio() {
+        static AAudioApi api;
+        static std::once_flag once;
+        std::call_once(once, [] {
+            void* library = dlopen("libaaudio.so", RTLD_NOW);
+            if (!library) {
+                LOGD("AAudio not available: %s", dlerror());
+                return;
+            }
+            bool ok = Resolve(library, "AAudio_createStreamBuilder", &api.createStreamBuilder) &&
+                      Resolve(library, "AAudioStreamBuilder_setDirection", &api.setDirection) &&
+                      Resolve(library, "AAudioStreamBuilder_setSampleRate", &api.setSampleRate) &&
+                      Resolve(library, "AAudioStreamBuilder_setChannelCount", &api.setChannelCount) &&
+                      Resolve(library, "AAudioStreamBuilder_setFormat", &api.setFormat) &&
+                      Resolve(library, "AAudioStreamBuilder_setPerformanceMode", &api.setPerformanceMode) &&
+                      Resolve(library, "AAudioStreamBuilder_setSharingMode", &api.setSharingMode) &&
+                      Resolve(library, "AAudioStreamBuilder_setDataCallback", &api.setDataCallback) &&
+                      Resolve(library, "AAudioStreamBuilder_setErrorCallback", &api.setErrorCallback) &&
+                      Resolve(library, "AAudioStreamBuilder_openStream", &api.openStream) &&
+                      Resolve(library, "AAudioStreamBuilder_delete", &api.deleteBuilder) &&
+                      Resolve(library, "AAudioStream_requestStart", &api.requestStart) &&
+                      Resolve(library, "AAudioStream_requestStop", &api.requestStop) &&
+                      Resolve(library, "AAudioStream_close", &api.close) &&
+                      Resolve(library, "AAudioStream_getSampleRate", &api.getSampleRate) &&
+                      Resolve(library, "AAudioStream_getChannelCount", &api.getChannelCount) &&
+                      Resolve(library, "AAudioStream_getFormat", &api.getFormat) &&
+                      Resolve(library, "AAudioStream_getBufferCapacityInFrames", &api.getBufferCapacityInFrames) &&
+                      Resolve(library, "AAudio_convertResultToText", &api.convertResultToText);
+            if (!ok) {
+                LOGE("AAudio symbols missing: %s", dlerror());
+                return;
+            }
+            Resolve(library, "AAudioStreamBuilder_setInputPreset", &api.setInputPreset);
+            api.loaded = true;
+        });
+        return api;
+    }
+}
+
+CaptureEngine::CaptureEngine(AudioProcessor* processor) : processor_(processor) {
+    sem_init(&available_, 0, 0);
+}
+
+CaptureEngine::~CaptureEngine() {
+    Stop();
+    sem_destroy(&available_);
+}
+
+bool CaptureEngine::IsSupported() {
+    return LoadAAudio().loaded;
+}
+
+bool CaptureEngine::Start(int sampleRate, int channels, int queueMs) {
+    std::lock_guard<std::mutex> lock(controlMutex_);
+    if (stream_) return true;
+
+    const AAudioApi& api = LoadAAudio();
+    if (!api.loaded || sampleRate <= 0 || channels <= 0 || queueMs <= 0) return false;
+
+    AAudioStreamBuilder* builder = nullptr;
+    aaudio_result_t result = api.createStreamBuilder(&builder);
+    if (result != AAUDIO_OK) {
+        LOGE("createStreamBuilder failed: %s", api.convertResultToText(result));
+        return false;
+    }
+
+    // 采样率与声道数必须与处理器一致，由 AAudio 负责设备侧的格式转换
+    api.setDirection(builder, AAUDIO_DIRECTION_INPUT);
+    api.setSampleRate(builder, sampleRate);
+    api.setChannelCount(builder, channels);
+    api.setFormat(builder, AAUDIO_FORMAT_PCM_I16);
+    api.setPerformanceMode(builder, AAUDIO_PERFORMANCE_MODE_LOW_LATENCY);
+    api.setSharingMode(builder, AAUDIO_SHARING_MODE_SHARED);
+    if (api.setInputPreset) {
+        // 语音识别预设：不叠加系统的通话处理，由本模块完成 AEC/NS/AGC
+        api.setInputPreset(builder, AAUDIO_INPUT_PRESET_VOICE_RECOGNITION);
+    }
+    api.setDataCallback(builder, &CaptureEngine::OnData, this);
+    api.setErrorCallback(builder, &CaptureEngine::OnError, this);
+
+    AAudioStream* stream = nullptr;
+    result = api.openStream(builder, &stream);
+    api.deleteBuilder(builder);
+    if (result != AAUDIO_OK) {
+        LOGE("openStream failed: %s", api.convertResultToText(result));
+        return false;
+    }
+
+    if (api.getSampleRate(stream) != sampleRate || api.getChannelCount(stream) != channels ||
+        api.getFormat(stream) != AAUDIO_FORMAT_PCM_I16) {
+        LOGE("Stream format mismatch: sampleRate=%d, channels=%d",
+             api.getSampleRate(stream), api.getChannelCount(stream));
+        api.close(stream);
+        return false;
+    }
+
+    channels_ = channels;
+    sampleRate_ = sampleRate;
+    scratch_.assign(static_cast<size_t>(std::max(api.getBufferCapacityInFrames(stream), 1)) * channels_, 0);
+    queue_.Reset(sampleRate_ * queueMs / 1000 * channels_, sampleRate_ * channels_);
+
+    stream_ = stream;
+    running_.store(true, std::memory_order_release);
+    result = api.requestStart(stream_);
+    if (result != AAUDIO_OK) {
+        LOGE("requestStart failed: %s", api.convertResultToText(result));
+        CloseStream();
+        return false;
+    }
+
+    LOGD("Capture started: sampleRate=%d, channels=%d, capacity=%d frames",
+         sampleRate_, channels_, static_cast<int>(scratch_.size()) / channels_);
+    return true;
+}
+
+void CaptureEngine::Stop() {
+    std::lock_guard<std::mutex> lock(controlMutex_);
+    if (!stream_) return;
+    LoadAAudio().requestStop(stream_);
+    CloseStream();
+    LOGD("Capture stopped, overruns=%llu", static_cast<unsigned long long>(queue_.Overruns()));
+}
+
+void CaptureEngine::CloseStream() {
+    // close 会等待正在执行的回调返回，之后不会再有回调
+    LoadAAudio().close(stream_);
+    stream_ = nullptr;
+    running_.store(false, std::memory_order_release);
+    sem_post(&available_);
+}
+
+int CaptureEngine::Read(int16_t* out, int count, int timeoutMs, int64_t* timestampNs) {
+    if (!out || count <= 0) return -1;
+
+    timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_sec += timeoutMs / 1000;
+    deadline.tv_nsec += static_cast<long>(timeoutMs % 1000) * 1000000L;
+    if (deadline.tv_nsec >= 1000000000L) {
+        deadline.tv_sec += 1;
+        deadline.tv_nsec -= 1000000000L;
+    }
+
+    // 信号量只用于唤醒，是否可读以队列中的样本数为准
+    while (queue_.Available() < count) {
+        if (!IsRunning()) return -1;
+        if (sem_timedwait(&available_, &deadline) != 0 && errno == ETIMEDOUT) {
+            return queue_.Available() >= count ? queue_.Read(out, count, timestampNs) : 0;
+        }
+    }
+    return queue_.Read(out, count, timestampNs);
+}
+
+aaudio_data_callback_result_t CaptureEngine::OnData(AAudioStream* /* stream */, void* userData,
+                                                    void* audioData, int32_t numFrames) {
+    auto* self = static_cast<CaptureEngine*>(userData);
+    const auto* input = static_cast<const int16_t*>(audioData);
+    int64_t timestampNs = MonotonicNowNs() - static_cast<int64_t>(numFrames) * 1000000000LL / self->sampleRate_;
+
+    // 回调长度不超过流的缓冲区容量，超出时分段处理
+    int remaining = numFrames * self->channels_;
+    int capacity = static_cast<int>(self->scratch_.size());
+    while (remaining > 0) {
+        int n = std::min(remaining, capacity);
+        int processed = self->processor_->ProcessCaptureFrame(input, n, self->scratch_.data());
+        self->queue_.Write(self->scratch_.data(), processed, timestampNs);
+        input += n;
+        remaining -= n;
+    }
+
+    sem_post(&self->available_);
+    return AAUDIO_CALLBACK_RESULT_CONTINUE;
+}
+
+void CaptureEngine::OnError(AAudioStream* /* stream */, void* userData, aaudio_result_t error) {
+    // 不能在错误回调中关闭流：只标记停止并唤醒投递线程，由控制线程调用 Stop
+    auto* self = static_cast<CaptureEngine*>(userData);
+    LOGE_LIMITED("Capture stream error: %s", LoadAAudio().convertResultToText(error));
+    self->running_.store(false, std::memory_order_release);
+    sem_post(&self->available_);
+}
+
+} // namespace webrtc_apm
@@ -0,0 +1,95 @@
+#ifndef CAPTURE_ENGINE_H
+#define CAPTURE_ENGINE_H
+
+#include "render_ring.h"
+#include <aaudio/AAudio.h>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <semaphore.h>
+#include <vector>
+
+namespace webrtc_apm {
+
+class AudioProcessor;
+
+/**
+ * 原生采集引擎：由 native 持有 AAudio 输入流，在音频回调线程上直接处理
+ *
+ * AAudio 的低延迟数据回调运行在系统提供的高优先级（实时调度）线程上，
+ * 每个回调内对采集数据调用 AudioProcessor::ProcessCaptureFrame，
+ * 再把处理后的样本写入单生产者/单消费者无锁队列，由投递线程取出交给上层。
+ * 回调中不加锁、不分配内存（处理器的内部缓冲区在前几个回调后即稳定）。
+ * 采集期间平台线程上的配置调用只写入处理器的待生效配置，由回调线程在块边界应用；
+ * 运行期间回调线程是处理器唯一的采集线程：JNI 层以采集占用标记让启动与逐帧采集调用互斥，
+ * 逐帧调用进行中时启动失败，启动后直到 Stop 逐帧调用被拒绝（批量处理使用独立状态，不受影响）。
+ *
+ * AAudio 需要 Android 8.0（API 26），运行时通过 dlopen 加载，
+ * 低版本系统上 Start 返回 false，调用方应回退到逐帧处理的路径。
+ */
+class CaptureEngine {
+public:
+    explicit CaptureEngine(AudioProcessor* processor);
+    ~CaptureEngine();
+
+    CaptureEngine(const CaptureEngine&) = delete;
+    CaptureEngine& operator=(const CaptureEngine&) = delete;
+
+    /**
+     * 当前系统是否可用 AAudio
+     */
+    static bool IsSupported();
+
+    /**
+     * 打开并启动输入流，格式与处理器一致
+     * @param queueMs 处理后数据队列的容量（毫秒），投递线程来不及取走时丢弃新数据
+     */
+    bool Start(int sampleRate, int channels, int queueMs);
+
+    /**
+     * 停止并关闭输入流，唤醒阻塞在 Read 上的投递线程
+     */
+    void Stop();
+
+    bool IsRunning() const { return running_.load(std::memory_order_acquire); }
+
+    /**
+     * 阻塞读取恰好 count 个处理后的样本（投递线程调用）
+     * @param timestampNs 可选，返回第一个样本的采集时间（单调时钟）
+     * @return count；超时返回 0；引擎已停止或音频流出错返回 -1
+     */
+    int Read(int16_t* out, int count, int timeoutMs, int64_t* timestampNs);
+
+    /**
+     * 因队列满而丢弃的回调次数
+     */
+    uint64_t Overruns() const { return queue_.Overruns(); }
+
+private:
+    static aaudio_data_callback_result_t OnData(AAudioStream* stream, void* userData,
+                                                void* audioData, int32_t numFrames);
+    static void OnError(AAudioStream* stream, void* userData, aaudio_result_t error);
+
+    void CloseStream();
+
+    AudioProcessor* processor_;
+
+    // Start/Stop 之间互斥，不在音频回调路径上
+    std::mutex controlMutex_;
+    AAudioStream* stream_ = nullptr;
+
+    std::atomic<bool> running_{false};
+    int channels_ = 1;
+    int sampleRate_ = 16000;
+
+    // 回调线程使用的处理缓冲区，Start 时按流的最大回调长度分配
+    std::vector<int16_t> scratch_;
+
+    // 回调线程写入、投递线程读取，写入后以信号量唤醒
+    RenderRing queue_;
+    sem_t available_;
+};
+
+} // namespace webrtc_apm
+
+#endif // CAPTURE_ENGINE_H
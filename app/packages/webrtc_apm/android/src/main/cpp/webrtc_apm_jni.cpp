@@ -1,22 +1,206 @@
 #include <jni.h>
-#include <android/log.h>
 #include "include/audio_processor.h"
-#include <map>
-#include <mutex>
+#include "capture_engine.h"
+#include <atomic>
+#include <cstdint>
+#include <initializer_list>
+#include <thread>
 
 #define LOG_TAG "WebRTC_APM_JNI"
-#define LOGD(...) __android_log_print(ANDROID_LOG_DEBUG, LOG_TAG, __VA_ARGS__)
-#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, __VA_ARGS__)
+#include "apm_log.h"
 
 namespace {
-    std::map<jlong, webrtc_apm::AudioProcessor*> processors;
-    std::mutex processorsMutex;
-    jlong nextHandle = 1;
+    /**
+     * 固定容量的无锁句柄表
+     *
+     * 句柄 = (generation << 16) | (slot + 1)。每个槽位的状态打包在一个 64 位原子量中：
+     *   bit 63     LIVE       处理器可用，允许新的引用
+     *   bit 62     ALLOCATED  槽位已被占用（含销毁中）
+     *   bit 32-61  generation 每次销毁后递增，旧句柄随之失效
+     *   bit 0-31   refs       正在进行中的 JNI 调用数
+     *
+     * 每帧调用只做一次 CAS 加引用和一次原子减，不加锁。
+     * nativeDestroy 先清除 LIVE 拒绝新引用，再等待 refs 归零后才释放处理器，
+     * 因此不会与正在进行的处理调用竞争。
+     */
+    constexpr int kMaxProcessors = 64;
+
+    // 原生采集模式下处理后数据队列的容量
+    constexpr int kCaptureQueueMs = 200;
+
+    constexpr uint64_t kLive = 1ull << 63;
+    constexpr uint64_t kAllocated = 1ull << 62;
+    constexpr int kGenerationShift = 32;
+    constexpr uint64_t kGenerationMask = (1ull << 30) - 1;
+    constexpr uint64_t kRefMask = 0xFFFFFFFFull;
+
+    // Slot::captureOwner 中表示原生采集占用采集端的值
+    constexpr int kNativeCapture = -1;
+
+    struct Slot {
+        std::atomic<uint64_t> state{0};
+        std::atomic<webrtc_apm::AudioProcessor*> processor{nullptr};
+
+        // 原生采集引擎，首次启动时创建，随处理器一起销毁
+        std::atomic<webrtc_apm::CaptureEngine*> capture{nullptr};
+
+        // 采集端的占用者：>= 0 为进行中的逐帧采集调用数，kNativeCapture 为原生采集。
+        // 两者都以 CAS 占用，保证音频回调线程运行期间它是唯一的采集线程
+        std::atomic<int> captureOwner{0};
+    };
+
+    Slot slots[kMaxProcessors];
+
+    uint64_t GenerationOf(uint64_t state) {
+        return (state >> kGenerationShift) & kGenerationMask;
+    }
+
+    jlong MakeHandle(int index, uint64_t generation) {
+        return static_cast<jlong>((generation << 16) | static_cast<uint64_t>(index + 1));
+    }
+
+    Slot* SlotFor(jlong handle, uint64_t* generation) {
+        uint64_t value = static_cast<uint64_t>(handle);
+        uint64_t index = value & 0xFFFF;
+        if (index == 0 || index > kMaxProcessors) return nullptr;
+        *generation = (value >> 16) & kGenerationMask;
+        return &slots[index - 1];
+    }
+
+    jlong RegisterProcessor(webrtc_apm::AudioProcessor* processor) {
+        for (int i = 0; i < kMaxProcessors; ++i) {
+            Slot& slot = slots[i];
+            uint64_t state = slot.state.load(std::memory_order_acquire);
+            if (state & kAllocated) continue;
+            if (!slot.state.compare_exchange_strong(state, state | kAllocated,
+                                                    std::memory_order_acq_rel)) {
+                continue;
+            }
+            slot.processor.store(processor, std::memory_order_relaxed);
+            slot.state.fetch_or(kLive, std::memory_order_release);
+            return MakeHandle(i, GenerationOf(state));
+        }
+        return 0;
+    }
 
-    webrtc_apm::AudioProcessor* GetProcessor(jlong handle) {
-        std::lock_guard<std::mutex> lock(processorsMutex);
-        auto it = processors.find(handle);
-        return (it != processors.end()) ? it->second : nullptr;
+    /**
+     * 作用域内持有处理器引用，析构时释放
+     */
+    class ProcessorRef {
+    public:
+        explicit ProcessorRef(jlong handle) {
+            uint64_t generation;
+            Slot* slot = SlotFor(handle, &generation);
+            if (!slot) return;
+
+            uint64_t state = slot->state.load(std::memory_order_acquire);
+            do {
+                if (!(state & kLive) || GenerationOf(state) != generation) return;
+            } while (!slot->state.compare_exchange_weak(state, state + 1,
+                                                        std::memory_order_acquire));
+            slot_ = slot;
+            processor_ = slot->processor.load(std::memory_order_relaxed);
+        }
+
+        ~ProcessorRef() {
+            if (slot_) slot_->state.fetch_sub(1, std::memory_order_release);
+        }
+
+        ProcessorRef(const ProcessorRef&) = delete;
+        ProcessorRef& operator=(const ProcessorRef&) = delete;
+
+        explicit operator bool() const { return processor_ != nullptr; }
+        webrtc_apm::AudioProcessor* operator->() const { return processor_; }
+
+        /**
+         * 该处理器的采集占用标记，见 Slot::captureOwner
+         */
+        std::atomic<int>* CaptureOwner() const {
+            return slot_ ? &slot_->captureOwner : nullptr;
+        }
+
+        /**
+         * 该处理器的采集引擎
+         * @param create 尚未创建时是否创建
+         */
+        webrtc_apm::CaptureEngine* Capture(bool create) const {
+            if (!slot_) return nullptr;
+            auto* engine = slot_->capture.load(std::memory_order_acquire);
+            if (engine || !create) return engine;
+
+            auto* created = new webrtc_apm::CaptureEngine(processor_);
+            if (slot_->capture.compare_exchange_strong(engine, created, std::memory_order_acq_rel)) {
+                return created;
+            }
+            delete created;
+            return engine;
+        }
+
+    private:
+        Slot* slot_ = nullptr;
+        webrtc_apm::AudioProcessor* processor_ = nullptr;
+    };
+
+    /**
+     * 作用域内以逐帧调用的身份占用处理器的采集端，析构时释放
+     *
+     * 原生采集已占用时失败：此时音频回调线程是唯一的采集线程，逐帧调用被拒绝
+     * （配置调用不受影响，在下一块生效）。反过来，有逐帧调用进行中时 nativeStartCapture
+     * 无法占用，启动失败，因此检查与处理之间不会有采集流插入
+     */
+    class FrameCaptureGuard {
+    public:
+        explicit FrameCaptureGuard(const ProcessorRef& processor) : owner_(processor.CaptureOwner()) {
+            if (!owner_) return;
+            int count = owner_->load(std::memory_order_relaxed);
+            do {
+                if (count == kNativeCapture) {
+                    owner_ = nullptr;
+                    return;
+                }
+            } while (!owner_->compare_exchange_weak(count, count + 1, std::memory_order_acquire));
+        }
+
+        ~FrameCaptureGuard() {
+            if (owner_) owner_->fetch_sub(1, std::memory_order_release);
+        }
+
+        FrameCaptureGuard(const FrameCaptureGuard&) = delete;
+        FrameCaptureGuard& operator=(const FrameCaptureGuard&) = delete;
+
+        explicit operator bool() const { return owner_ != nullptr; }
+
+    private:
+        std::atomic<int>* owner_;
+    };
+
+    /**
+     * 从句柄表移除并返回处理器，等待所有进行中的调用结束
+     * @param capture 返回该处理器的采集引擎（可能为空），需先于处理器释放
+     */
+    webrtc_apm::AudioProcessor* UnregisterProcessor(jlong handle, webrtc_apm::CaptureEngine** capture) {
+        *capture = nullptr;
+        uint64_t generation;
+        Slot* slot = SlotFor(handle, &generation);
+        if (!slot) return nullptr;
+
+        uint64_t state = slot->state.load(std::memory_order_acquire);
+        do {
+            if (!(state & kLive) || GenerationOf(state) != generation) return nullptr;
+        } while (!slot->state.compare_exchange_weak(state, state & ~kLive,
+                                                    std::memory_order_acq_rel));
+
+        // 销毁很少发生，让出时间片等待即可
+        while (slot->state.load(std::memory_order_acquire) & kRefMask) {
+            std::this_thread::yield();
+        }
+
+        auto* processor = slot->processor.exchange(nullptr, std::memory_order_relaxed);
+        *capture = slot->capture.exchange(nullptr, std::memory_order_relaxed);
+        slot->captureOwner.store(0, std::memory_order_relaxed);
+        uint64_t next = ((generation + 1) & kGenerationMask) << kGenerationShift;
+        slot->state.store(next, std::memory_order_release);
+        return processor;
     }
 }
 
@@ -37,9 +221,13 @@ Java_com_anthropic_webrtc_1apm_WebrtcAudioProcessor_nativeCreate(
         return 0;
     }
 
-    std::lock_guard<std::mutex> lock(processorsMutex);
-    jlong handle = nextHandle++;
-    processors[handle] = processor;
+    jlong handle = RegisterProcessor(processor);
+    if (handle == 0) {
+        LOGE("Too many processors (max %d)", kMaxProcessors);
+        processor->Destroy();
+        delete processor;
+        return 0;
+    }
 
     LOGD("Created processor with handle: %lld", (long long)handle);
     return handle;
@@ -52,12 +240,14 @@ Java_com_anthropic_webrtc_1apm_WebrtcAudioProcessor_nativeDestroy(
         jlong handle) {
     LOGD("nativeDestroy: handle=%lld", (long long)handle);
 
-    std::lock_guard<std::mutex> lock(processorsMutex);
-    auto it = processors.find(handle);
-    if (it != processors.end()) {
-        it->second->Destroy();
-        delete it->second;
-        processors.erase(it);
+    webrtc_apm::CaptureEngine* capture;
+    auto* processor = UnregisterProcessor(handle, &capture);
+
+    // 先停止采集：音频回调直接使用处理器，不经过句柄表引用计数
+    delete capture;
+    if (processor) {
+        processor->Destroy();
+        delete processor;
         LOGD("Destroyed processor");
     }
 }
@@ -68,7 +258,7 @@ Java_com_anthropic_webrtc_1apm_WebrtcAudioProcessor_nativeSetAecEnabled(
         jobject /* this */,
         jlong handle,
         jboolean enabled) {
-    auto* processor = GetProcessor(handle);
+    ProcessorRef processor(handle);
     if (!processor) return JNI_FALSE;
     return processor->SetAecEnabled(enabled) ? JNI_TRUE : JNI_FALSE;
 }
@@ -79,7 +269,7 @@ Java_com_anthropic_webrtc_1apm_WebrtcAudioProcessor_nativeSetAecSuppressionLevel
         jobject /* this */,
         jlong handle,
         jint level) {
-    auto* processor = GetProcessor(handle);
+    ProcessorRef processor(handle);
     if (!processor) return JNI_FALSE;
     return processor->SetAecSuppressionLevel(level) ? JNI_TRUE : JNI_FALSE;
 }
@@ -90,7 +280,7 @@ Java_com_anthropic_webrtc_1apm_WebrtcAudioProcessor_nativeSetNsEnabled(
         jobject /* this */,
         jlong handle,
         jboolean enabled) {
-    auto* processor = GetProcessor(handle);
+    ProcessorRef processor(handle);
     if (!processor) return JNI_FALSE;
     return processor->SetNsEnabled(enabled) ? JNI_TRUE : JNI_FALSE;
 }
@@ -101,7 +291,7 @@ Java_com_anthropic_webrtc_1apm_WebrtcAudioProcessor_nativeSetNsSuppressionLevel(
         jobject /* this */,
         jlong handle,
         jint level) {
-    auto* processor = GetProcessor(handle);
+    ProcessorRef processor(handle);
     if (!processor) return JNI_FALSE;
     return processor->SetNsSuppressionLevel(level) ? JNI_TRUE : JNI_FALSE;
 }
@@ -112,7 +302,7 @@ Java_com_anthropic_webrtc_1apm_WebrtcAudioProcessor_nativeSetAgcEnabled(
         jobject /* this */,
         jlong handle,
         jboolean enabled) {
-    auto* processor = GetProcessor(handle);
+    ProcessorRef processor(handle);
     if (!processor) return JNI_FALSE;
     return processor->SetAgcEnabled(enabled) ? JNI_TRUE : JNI_FALSE;
 }
@@ -123,7 +313,7 @@ Java_com_anthropic_webrtc_1apm_WebrtcAudioProcessor_nativeSetAgcMode(
         jobject /* this */,
         jlong handle,
         jint mode) {
-    auto* processor = GetProcessor(handle);
+    ProcessorRef processor(handle);
     if (!processor) return JNI_FALSE;
     return processor->SetAgcMode(mode) ? JNI_TRUE : JNI_FALSE;
 }
@@ -134,21 +324,61 @@ Java_com_anthropic_webrtc_1apm_WebrtcAudioProcessor_nativeSetAgcTargetLevel(
         jobject /* this */,
         jlong handle,
         jint targetLevelDbfs) {
-    auto* processor = GetProcessor(handle);
+    ProcessorRef processor(handle);
     if (!processor) return JNI_FALSE;
     return processor->SetAgcTargetLevel(targetLevelDbfs) ? JNI_TRUE : JNI_FALSE;
 }
 
+JNIEXPORT jboolean JNICALL
+Java_com_anthropic_webrtc_1apm_WebrtcAudioProcessor_nativeSetVadEnabled(
+        JNIEnv* env,
+        jobject /* this */,
+        jlong handle,
+        jboolean enabled) {
+    ProcessorRef processor(handle);
+    if (!processor) return JNI_FALSE;
+    return processor->SetVadEnabled(enabled) ? JNI_TRUE : JNI_FALSE;
+}
+
+JNIEXPORT jboolean JNICALL
+Java_com_anthropic_webrtc_1apm_WebrtcAudioProcessor_nativeSetDownmixEnabled(
+        JNIEnv* env,
+        jobject /* this */,
+        jlong handle,
+        jboolean enabled) {
+    ProcessorRef processor(handle);
+    if (!processor) return JNI_FALSE;
+    return processor->SetDownmixEnabled(enabled) ? JNI_TRUE : JNI_FALSE;
+}
+
+/**
+ * 上一次采集处理的输出中是否有语音，需在处理调用所在的线程上、处理之后调用
+ */
+JNIEXPORT jboolean JNICALL
+Java_com_anthropic_webrtc_1apm_WebrtcAudioProcessor_nativeLastCaptureSpeech(
+        JNIEnv* env,
+        jobject /* this */,
+        jlong handle) {
+    ProcessorRef processor(handle);
+    if (!processor) return JNI_TRUE;
+    return processor->LastCaptureSpeech() ? JNI_TRUE : JNI_FALSE;
+}
+
 JNIEXPORT jbyteArray JNICALL
 Java_com_anthropic_webrtc_1apm_WebrtcAudioProcessor_nativeProcessCaptureFrame(
         JNIEnv* env,
         jobject /* this */,
         jlong handle,
         jbyteArray audioData) {
-    auto* processor = GetProcessor(handle);
+    ProcessorRef processor(handle);
     if (!processor || !audioData) {
         return audioData;
     }
+    FrameCaptureGuard capturing(processor);
+    if (!capturing) {
+        LOGE_LIMITED("nativeProcessCaptureFrame: rejected while native capture is running");
+        return audioData;
+    }
 
     jsize length = env->GetArrayLength(audioData);
     if (length <= 0) {
@@ -184,13 +414,57 @@ Java_com_anthropic_webrtc_1apm_WebrtcAudioProcessor_nativeProcessCaptureFrame(
     return outputArray ? outputArray : audioData;
 }
 
+/**
+ * 零拷贝处理：直接在调用方持有的 direct ByteBuffer 上原地处理
+ *
+ * 不经过 Java 堆数组，每帧无复制、无分配
+ * @return 处理后的字节数，失败返回 -1（缓冲区内容保持不变）
+ */
+JNIEXPORT jint JNICALL
+Java_com_anthropic_webrtc_1apm_WebrtcAudioProcessor_nativeProcessCaptureFrameDirect(
+        JNIEnv* env,
+        jobject /* this */,
+        jlong handle,
+        jobject buffer,
+        jint offset,
+        jint length) {
+    ProcessorRef processor(handle);
+    if (!processor || !buffer || offset < 0 || length <= 0) {
+        return -1;
+    }
+    FrameCaptureGuard capturing(processor);
+    if (!capturing) {
+        LOGE_LIMITED("nativeProcessCaptureFrameDirect: rejected while native capture is running");
+        return -1;
+    }
+
+    auto* base = static_cast<uint8_t*>(env->GetDirectBufferAddress(buffer));
+    jlong capacity = env->GetDirectBufferCapacity(buffer);
+    if (!base || capacity < 0 || static_cast<jlong>(offset) + length > capacity) {
+        return -1;
+    }
+
+    // PCM16 格式：样本必须按 2 字节对齐
+    uint8_t* bytes = base + offset;
+    if (reinterpret_cast<uintptr_t>(bytes) % alignof(int16_t) != 0) {
+        LOGE_LIMITED("nativeProcessCaptureFrameDirect: unaligned buffer offset %d", offset);
+        return -1;
+    }
+
+    int sampleCount = length / 2;
+    auto* samples = reinterpret_cast<int16_t*>(bytes);
+    int processedCount = processor->ProcessCaptureFrame(samples, sampleCount, samples);
+
+    return processedCount * 2;
+}
+
 JNIEXPORT jboolean JNICALL
 Java_com_anthropic_webrtc_1apm_WebrtcAudioProcessor_nativeProcessRenderFrame(
         JNIEnv* env,
         jobject /* this */,
         jlong handle,
         jbyteArray audioData) {
-    auto* processor = GetProcessor(handle);
+    ProcessorRef processor(handle);
     if (!processor || !audioData) {
         return JNI_FALSE;
     }
@@ -219,4 +493,196 @@ Java_com_anthropic_webrtc_1apm_WebrtcAudioProcessor_nativeProcessRenderFrame(
     return result ? JNI_TRUE : JNI_FALSE;
 }
 
+/**
+ * 批量处理积压的采集音频（可附带对应的参考信号），整批只跨越一次 JNI
+ *
+ * 输入整体复制到 native 缓冲区后原地处理，不在处理期间持有 Java 数组。
+ * 批量在独立的处理状态上运行，原生采集进行中也可调用
+ * @return 处理后的数据，失败返回 null
+ */
+JNIEXPORT jbyteArray JNICALL
+Java_com_anthropic_webrtc_1apm_WebrtcAudioProcessor_nativeProcessCaptureBatch(
+        JNIEnv* env,
+        jobject /* this */,
+        jlong handle,
+        jbyteArray captureData,
+        jbyteArray renderData,
+        jint frameSamples) {
+    ProcessorRef processor(handle);
+    if (!processor || !captureData || frameSamples <= 0) {
+        return nullptr;
+    }
+
+    // PCM16 格式：每个样本 2 字节
+    int sampleCount = env->GetArrayLength(captureData) / 2;
+    if (sampleCount <= 0) {
+        return nullptr;
+    }
+    std::vector<int16_t> samples(sampleCount);
+    env->GetByteArrayRegion(captureData, 0, sampleCount * 2, reinterpret_cast<jbyte*>(samples.data()));
+
+    std::vector<int16_t> render;
+    if (renderData) {
+        int renderCount = env->GetArrayLength(renderData) / 2;
+        render.resize(renderCount);
+        env->GetByteArrayRegion(renderData, 0, renderCount * 2, reinterpret_cast<jbyte*>(render.data()));
+    }
+
+    int processedCount = processor->ProcessCaptureBatch(
+        samples.data(), sampleCount,
+        render.empty() ? nullptr : render.data(), static_cast<int>(render.size()),
+        frameSamples, samples.data());
+    if (processedCount <= 0) {
+        return nullptr;
+    }
+
+    jbyteArray outputArray = env->NewByteArray(processedCount * 2);
+    if (outputArray) {
+        env->SetByteArrayRegion(outputArray, 0, processedCount * 2,
+                                reinterpret_cast<const jbyte*>(samples.data()));
+    }
+    return outputArray;
+}
+
+/**
+ * 获取处理统计，按固定顺序打包为 long 数组（顺序与 WebrtcAudioProcessor.getStats 一致）：
+ *   captureBlocks, renderFrames, renderOverruns, inputClippedSamples, outputClippedSamples,
+ *   processingTimeUs, aecDelayMs, renderBufferedMs, speechBlocks,
+ *   然后 aec/ns/agc/vad/total 五个阶段各 4 项：blocks, p50Us, p99Us, maxUs
+ * @return 失败返回 null
+ */
+JNIEXPORT jlongArray JNICALL
+Java_com_anthropic_webrtc_1apm_WebrtcAudioProcessor_nativeGetStats(
+        JNIEnv* env,
+        jobject /* this */,
+        jlong handle) {
+    ProcessorRef processor(handle);
+    webrtc_apm::ProcessingStats stats;
+    if (!processor || !processor->GetStats(&stats)) {
+        return nullptr;
+    }
+
+    jlong values[9 + 5 * 4] = {
+        static_cast<jlong>(stats.captureBlocks),
+        static_cast<jlong>(stats.renderFrames),
+        static_cast<jlong>(stats.renderOverruns),
+        static_cast<jlong>(stats.inputClippedSamples),
+        static_cast<jlong>(stats.outputClippedSamples),
+        static_cast<jlong>(stats.processingTimeUs),
+        stats.aecDelayMs,
+        stats.renderBufferedMs,
+        static_cast<jlong>(stats.speechBlocks),
+    };
+    int index = 9;
+    for (const auto* stage : {&stats.aec, &stats.ns, &stats.agc, &stats.vad, &stats.total}) {
+        values[index++] = static_cast<jlong>(stage->blocks);
+        values[index++] = stage->p50Us;
+        values[index++] = stage->p99Us;
+        values[index++] = stage->maxUs;
+    }
+
+    jlongArray result = env->NewLongArray(index);
+    if (result) {
+        env->SetLongArrayRegion(result, 0, index, values);
+    }
+    return result;
+}
+
+JNIEXPORT void JNICALL
+Java_com_anthropic_webrtc_1apm_WebrtcAudioProcessor_nativeResetStats(
+        JNIEnv* /* env */,
+        jobject /* this */,
+        jlong handle) {
+    ProcessorRef processor(handle);
+    if (processor) {
+        processor->ResetStats();
+    }
+}
+
+JNIEXPORT jboolean JNICALL
+Java_com_anthropic_webrtc_1apm_WebrtcAudioProcessor_nativeIsCaptureSupported(
+        JNIEnv* env,
+        jobject /* this */) {
+    return webrtc_apm::CaptureEngine::IsSupported() ? JNI_TRUE : JNI_FALSE;
+}
+
+/**
+ * 启动原生采集：AAudio 回调线程上直接处理，结果经无锁队列由 nativeReadCapture 取出
+ *
+ * 先占用处理器的采集端，有逐帧采集调用进行中时返回失败；占用持续到 nativeStopCapture
+ * （音频流出错停止后同样需要调用），期间逐帧采集调用被拒绝
+ */
+JNIEXPORT jboolean JNICALL
+Java_com_anthropic_webrtc_1apm_WebrtcAudioProcessor_nativeStartCapture(
+        JNIEnv* env,
+        jobject /* this */,
+        jlong handle) {
+    ProcessorRef processor(handle);
+    if (!processor) return JNI_FALSE;
+
+    std::atomic<int>* owner = processor.CaptureOwner();
+    int expected = 0;
+    bool acquired = owner->compare_exchange_strong(expected, kNativeCapture, std::memory_order_acq_rel);
+    if (!acquired && expected != kNativeCapture) {
+        LOGE("nativeStartCapture: rejected while frame processing is in flight");
+        return JNI_FALSE;
+    }
+
+    auto* capture = processor.Capture(true);
+    bool started = capture->Start(processor->SampleRate(), processor->Channels(), kCaptureQueueMs);
+    if (!started && acquired) {
+        owner->store(0, std::memory_order_release);
+    }
+    LOGD("nativeStartCapture: handle=%lld, started=%d", (long long)handle, started);
+    return started ? JNI_TRUE : JNI_FALSE;
+}
+
+JNIEXPORT void JNICALL
+Java_com_anthropic_webrtc_1apm_WebrtcAudioProcessor_nativeStopCapture(
+        JNIEnv* env,
+        jobject /* this */,
+        jlong handle) {
+    ProcessorRef processor(handle);
+    if (!processor) return;
+
+    auto* capture = processor.Capture(false);
+    if (capture) capture->Stop();
+
+    // 流已关闭，不会再有回调：交还采集端
+    int expected = kNativeCapture;
+    processor.CaptureOwner()->compare_exchange_strong(expected, 0, std::memory_order_acq_rel);
+}
+
+/**
+ * 阻塞读取处理后的采集数据到 direct ByteBuffer（投递线程调用）
+ *
+ * 等待期间持有处理器引用，nativeDestroy 最多等待 timeoutMs
+ * @return 读取的字节数（恰好 length），超时返回 0，采集已停止或出错返回 -1
+ */
+JNIEXPORT jint JNICALL
+Java_com_anthropic_webrtc_1apm_WebrtcAudioProcessor_nativeReadCapture(
+        JNIEnv* env,
+        jobject /* this */,
+        jlong handle,
+        jobject buffer,
+        jint length,
+        jint timeoutMs) {
+    ProcessorRef processor(handle);
+    if (!processor || !buffer || length <= 0 || timeoutMs < 0) {
+        return -1;
+    }
+
+    auto* capture = processor.Capture(false);
+    if (!capture) return -1;
+
+    auto* bytes = static_cast<uint8_t*>(env->GetDirectBufferAddress(buffer));
+    jlong capacity = env->GetDirectBufferCapacity(buffer);
+    if (!bytes || capacity < length || reinterpret_cast<uintptr_t>(bytes) % alignof(int16_t) != 0) {
+        return -1;
+    }
+
+    int read = capture->Read(reinterpret_cast<int16_t*>(bytes), length / 2, timeoutMs, nullptr);
+    return read > 0 ? read * 2 : read;
+}
+
 } // extern "C"
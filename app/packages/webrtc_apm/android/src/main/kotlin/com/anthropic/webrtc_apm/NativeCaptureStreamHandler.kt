@@ -0,0 +1,97 @@
+package com.anthropic.webrtc_apm
+
+import android.os.Handler
+import android.os.Looper
+import android.os.Process
+import android.util.Log
+import io.flutter.plugin.common.EventChannel
+
+/**
+ * 原生采集事件流
+ *
+ * Dart 侧订阅时启动 native 采集（AAudio 回调线程内完成 AEC/NS/AGC），
+ * 投递线程从无锁队列按 10ms 帧取出处理后的 PCM16，切到主线程发给 EventSink；
+ * 取消订阅时停止采集。每帧只有一次到 ByteArray 的复制，不再经过 MethodChannel 往返。
+ */
+class NativeCaptureStreamHandler(
+    private val processorProvider: () -> WebrtcAudioProcessor?
+) : EventChannel.StreamHandler {
+
+    companion object {
+        private const val TAG = "NativeCapture"
+        private const val READ_TIMEOUT_MS = 100
+    }
+
+    private val mainHandler = Handler(Looper.getMainLooper())
+    private var processor: WebrtcAudioProcessor? = null
+    private var deliveryThread: Thread? = null
+    @Volatile private var eventSink: EventChannel.EventSink? = null
+
+    override fun onListen(arguments: Any?, events: EventChannel.EventSink) {
+        stop()
+
+        val processor = processorProvider()
+        if (processor == null) {
+            events.error("NOT_INITIALIZED", "Audio processor is not initialized", null)
+            return
+        }
+        if (!processor.isNativeCaptureSupported()) {
+            events.error("NOT_SUPPORTED", "Native capture requires AAudio (Android 8.0+)", null)
+            return
+        }
+        if (!processor.startNativeCapture()) {
+            events.error("CAPTURE_ERROR", "Failed to start native capture", null)
+            return
+        }
+
+        this.processor = processor
+        eventSink = events
+        val frameBytes = processor.frameSampleCount * 2
+        deliveryThread = Thread({ deliver(processor, frameBytes, events) }, "webrtc_apm_capture").apply {
+            start()
+        }
+        Log.d(TAG, "Native capture started, frameBytes=$frameBytes")
+    }
+
+    override fun onCancel(arguments: Any?) {
+        stop()
+    }
+
+    /**
+     * 停止采集并等待投递线程退出
+     */
+    fun stop() {
+        eventSink = null
+        processor?.stopNativeCapture()
+        processor = null
+        deliveryThread?.join()
+        deliveryThread = null
+    }
+
+    private fun deliver(processor: WebrtcAudioProcessor, frameBytes: Int, events: EventChannel.EventSink) {
+        Process.setThreadPriority(Process.THREAD_PRIORITY_URGENT_AUDIO)
+        val buffer = WebrtcAudioProcessor.allocateFrameBuffer(frameBytes / 2)
+
+        while (true) {
+            val read = processor.readNativeCapture(buffer, frameBytes, READ_TIMEOUT_MS)
+            if (read == 0) continue
+            if (read < 0) {
+                // 主动停止时 eventSink 已清空；否则是音频流出错（如设备断开）
+                mainHandler.post {
+                    if (eventSink === events) {
+                        eventSink = null
+                        events.error("CAPTURE_ERROR", "Native capture stream stopped", null)
+                    }
+                }
+                break
+            }
+
+            val frame = ByteArray(read)
+            buffer.rewind()
+            buffer.get(frame, 0, read)
+            mainHandler.post {
+                if (eventSink === events) events.success(frame)
+            }
+        }
+    }
+}
@@ -1,12 +1,17 @@
 package com.anthropic.webrtc_apm
 
+import android.os.Handler
+import android.os.Looper
 import android.util.Log
 import androidx.annotation.NonNull
 import io.flutter.embedding.engine.plugins.FlutterPlugin
+import io.flutter.plugin.common.EventChannel
 import io.flutter.plugin.common.MethodCall
 import io.flutter.plugin.common.MethodChannel
 import io.flutter.plugin.common.MethodChannel.MethodCallHandler
 import io.flutter.plugin.common.MethodChannel.Result
+import java.util.concurrent.ExecutorService
+import java.util.concurrent.Executors
 
 /**
  * WebRTC APM Flutter Plugin
@@ -15,20 +20,36 @@ import io.flutter.plugin.common.MethodChannel.Result
  */
 class WebrtcApmPlugin: FlutterPlugin, MethodCallHandler {
     private lateinit var channel: MethodChannel
+    private lateinit var captureChannel: EventChannel
+    private val captureHandler = NativeCaptureStreamHandler { audioProcessor }
     private var audioProcessor: WebrtcAudioProcessor? = null
 
+    // 批量处理耗时与数据量成正比，放到后台线程，避免阻塞平台线程。
+    // 单线程执行器保证批量调用之间串行；批量在 native 的独立状态上运行，不与平台线程上的实时处理竞争
+    private val batchExecutor: ExecutorService = Executors.newSingleThreadExecutor()
+    private val mainHandler = Handler(Looper.getMainLooper())
+
     companion object {
         private const val TAG = "WebrtcApmPlugin"
+
+        // 逐帧调用的方法不打调用日志：每秒数十次的 logcat 写入本身就是可观的开销
+        private val HOT_METHODS = setOf(
+            "processCaptureFrame", "processCaptureFrameWithVad", "processRenderFrame", "processCaptureBatch"
+        )
     }
 
     override fun onAttachedToEngine(@NonNull flutterPluginBinding: FlutterPlugin.FlutterPluginBinding) {
         channel = MethodChannel(flutterPluginBinding.binaryMessenger, "webrtc_apm")
         channel.setMethodCallHandler(this)
+        captureChannel = EventChannel(flutterPluginBinding.binaryMessenger, "webrtc_apm/capture")
+        captureChannel.setStreamHandler(captureHandler)
         Log.d(TAG, "Plugin attached to engine")
     }
 
     override fun onMethodCall(@NonNull call: MethodCall, @NonNull result: Result) {
-        Log.d(TAG, "Method called: ${call.method}")
+        if (call.method !in HOT_METHODS) {
+            Log.d(TAG, "Method called: ${call.method}")
+        }
 
         when (call.method) {
             "initialize" -> {
@@ -67,17 +88,45 @@ class WebrtcApmPlugin: FlutterPlugin, MethodCallHandler {
                 val targetLevelDbfs = call.argument<Int>("targetLevelDbfs") ?: 3
                 handleSetAgcTargetLevel(targetLevelDbfs, result)
             }
+            "setVadEnabled" -> {
+                val enabled = call.argument<Boolean>("enabled") ?: false
+                handleSetVadEnabled(enabled, result)
+            }
+            "setDownmixEnabled" -> {
+                val enabled = call.argument<Boolean>("enabled") ?: false
+                handleSetDownmixEnabled(enabled, result)
+            }
             "processCaptureFrame" -> {
                 val audioData = call.argument<ByteArray>("audioData")
                 handleProcessCaptureFrame(audioData, result)
             }
+            "processCaptureFrameWithVad" -> {
+                val audioData = call.argument<ByteArray>("audioData")
+                handleProcessCaptureFrameWithVad(audioData, result)
+            }
             "processRenderFrame" -> {
                 val audioData = call.argument<ByteArray>("audioData")
                 handleProcessRenderFrame(audioData, result)
             }
+            "processCaptureBatch" -> {
+                val audioData = call.argument<ByteArray>("audioData")
+                val renderData = call.argument<ByteArray>("renderData")
+                val frameSamples = call.argument<Int>("frameSamples") ?: 160
+                handleProcessCaptureBatch(audioData, renderData, frameSamples, result)
+            }
             "getStatus" -> {
                 handleGetStatus(result)
             }
+            "getStats" -> {
+                result.success(audioProcessor?.getStats())
+            }
+            "resetStats" -> {
+                audioProcessor?.resetStats()
+                result.success(null)
+            }
+            "isNativeCaptureSupported" -> {
+                result.success(audioProcessor?.isNativeCaptureSupported() ?: false)
+            }
             else -> {
                 result.notImplemented()
             }
@@ -88,6 +137,7 @@ class WebrtcApmPlugin: FlutterPlugin, MethodCallHandler {
         try {
             if (audioProcessor != null) {
                 Log.d(TAG, "Already initialized, disposing old instance")
+                captureHandler.stop()
                 audioProcessor?.dispose()
             }
 
@@ -104,6 +154,7 @@ class WebrtcApmPlugin: FlutterPlugin, MethodCallHandler {
 
     private fun handleDispose(result: Result) {
         try {
+            captureHandler.stop()
             audioProcessor?.dispose()
             audioProcessor = null
             Log.d(TAG, "Disposed")
@@ -206,6 +257,70 @@ class WebrtcApmPlugin: FlutterPlugin, MethodCallHandler {
         }
     }
 
+    private fun handleSetVadEnabled(enabled: Boolean, result: Result) {
+        try {
+            val success = audioProcessor?.setVadEnabled(enabled) ?: false
+            Log.d(TAG, "VAD enabled: $enabled, result: $success")
+            result.success(success)
+        } catch (e: Exception) {
+            Log.e(TAG, "setVadEnabled failed", e)
+            result.error("VAD_ERROR", e.message, null)
+        }
+    }
+
+    private fun handleSetDownmixEnabled(enabled: Boolean, result: Result) {
+        try {
+            val success = audioProcessor?.setDownmixEnabled(enabled) ?: false
+            Log.d(TAG, "Downmix enabled: $enabled, result: $success")
+            result.success(success)
+        } catch (e: Exception) {
+            Log.e(TAG, "setDownmixEnabled failed", e)
+            result.error("DOWNMIX_ERROR", e.message, null)
+        }
+    }
+
+    /**
+     * 处理一帧并附带语音判决，一次平台通道往返同时返回两者
+     */
+    private fun handleProcessCaptureFrameWithVad(audioData: ByteArray?, result: Result) {
+        if (audioData == null) {
+            result.error("INVALID_INPUT", "Audio data is null", null)
+            return
+        }
+
+        try {
+            val processor = audioProcessor
+            val processedData = processor?.processCaptureFrame(audioData) ?: audioData
+            val isSpeech = processor?.lastCaptureSpeech() ?: true
+            result.success(mapOf("audioData" to processedData, "isSpeech" to isSpeech))
+        } catch (e: Exception) {
+            Log.e(TAG, "processCaptureFrameWithVad failed", e)
+            result.error("PROCESS_ERROR", e.message, null)
+        }
+    }
+
+    private fun handleProcessCaptureBatch(audioData: ByteArray?, renderData: ByteArray?, frameSamples: Int, result: Result) {
+        if (audioData == null) {
+            result.error("INVALID_INPUT", "Audio data is null", null)
+            return
+        }
+        val processor = audioProcessor
+        if (processor == null) {
+            result.success(audioData)
+            return
+        }
+
+        batchExecutor.execute {
+            try {
+                val processedData = processor.processCaptureBatch(audioData, renderData, frameSamples)
+                mainHandler.post { result.success(processedData) }
+            } catch (e: Exception) {
+                Log.e(TAG, "processCaptureBatch failed", e)
+                mainHandler.post { result.error("PROCESS_ERROR", e.message, null) }
+            }
+        }
+    }
+
     private fun handleProcessRenderFrame(audioData: ByteArray?, result: Result) {
         if (audioData == null) {
             result.error("INVALID_INPUT", "Audio data is null", null)
@@ -235,6 +350,9 @@ class WebrtcApmPlugin: FlutterPlugin, MethodCallHandler {
 
     override fun onDetachedFromEngine(@NonNull binding: FlutterPlugin.FlutterPluginBinding) {
         channel.setMethodCallHandler(null)
+        captureChannel.setStreamHandler(null)
+        captureHandler.stop()
+        batchExecutor.shutdown()
         audioProcessor?.dispose()
         audioProcessor = null
         Log.d(TAG, "Plugin detached from engine")
@@ -1,6 +1,8 @@
 package com.anthropic.webrtc_apm
 
 import android.util.Log
+import java.nio.ByteBuffer
+import java.nio.ByteOrder
 
 /**
  * WebRTC 音频处理器
@@ -12,6 +14,16 @@ class WebrtcAudioProcessor {
     companion object {
         private const val TAG = "WebrtcAudioProcessor"
 
+        /**
+         * 分配可用于零拷贝处理的帧缓冲区
+         *
+         * @param sampleCount 每帧样本数（如 16kHz 单声道 10ms 为 160）
+         */
+        @JvmStatic
+        fun allocateFrameBuffer(sampleCount: Int): ByteBuffer {
+            return ByteBuffer.allocateDirect(sampleCount * 2).order(ByteOrder.nativeOrder())
+        }
+
         init {
             try {
                 System.loadLibrary("webrtc_apm_jni")
@@ -22,16 +34,27 @@ class WebrtcAudioProcessor {
         }
     }
 
-    private var nativeHandle: Long = 0
-    private var isInitialized = false
+    // 采集线程、渲染线程与配置调用并发读取；句柄带代号，销毁后旧句柄在 native 侧直接失效
+    @Volatile private var nativeHandle: Long = 0
+    @Volatile private var isInitialized = false
 
     private var aecEnabled = false
     private var nsEnabled = false
     private var agcEnabled = false
+    private var vadEnabled = false
+    private var downmixEnabled = false
     private var aecSuppressionLevel = 2
     private var nsSuppressionLevel = 2
     private var agcMode = 1
     private var agcTargetLevel = 3
+    private var sampleRate = 16000
+    private var channels = 1
+
+    /**
+     * 10ms 帧的样本数（按初始化时的采样率与声道数）
+     */
+    val frameSampleCount: Int
+        get() = sampleRate / 100 * channels
 
     /**
      * 初始化 APM
@@ -45,6 +68,8 @@ class WebrtcAudioProcessor {
         return try {
             nativeHandle = nativeCreate(sampleRate, channels)
             isInitialized = nativeHandle != 0L
+            this.sampleRate = sampleRate
+            this.channels = channels
             Log.d(TAG, "Initialize: handle=$nativeHandle, success=$isInitialized")
             isInitialized
         } catch (e: Exception) {
@@ -181,6 +206,38 @@ class WebrtcAudioProcessor {
         }
     }
 
+    /**
+     * 启用/禁用 VAD：非语音块跳过 AEC/NS/AGC，并可通过 [lastCaptureSpeech] 取得语音判决
+     */
+    fun setVadEnabled(enabled: Boolean): Boolean {
+        if (!isInitialized) return false
+
+        return try {
+            val result = nativeSetVadEnabled(nativeHandle, enabled)
+            if (result) vadEnabled = enabled
+            result
+        } catch (e: Exception) {
+            Log.e(TAG, "setVadEnabled failed", e)
+            false
+        }
+    }
+
+    /**
+     * 启用/禁用多声道混音：多声道采集混为单声道后只处理一路，输出复制到各声道
+     */
+    fun setDownmixEnabled(enabled: Boolean): Boolean {
+        if (!isInitialized) return false
+
+        return try {
+            val result = nativeSetDownmixEnabled(nativeHandle, enabled)
+            if (result) downmixEnabled = enabled
+            result
+        } catch (e: Exception) {
+            Log.e(TAG, "setDownmixEnabled failed", e)
+            false
+        }
+    }
+
     /**
      * 处理捕获的音频帧
      */
@@ -195,6 +252,61 @@ class WebrtcAudioProcessor {
         }
     }
 
+    /**
+     * 零拷贝处理捕获的音频帧
+     *
+     * 在 direct ByteBuffer 上原地处理 [position, limit) 区间的 PCM16 数据，
+     * 不产生额外的数组复制和分配。缓冲区可由 [allocateFrameBuffer] 创建并在每帧复用。
+     *
+     * @return 处理后的字节数；未初始化时原样保留数据并返回 remaining()，失败返回 -1
+     */
+    fun processCaptureFrame(buffer: ByteBuffer): Int {
+        require(buffer.isDirect) { "processCaptureFrame requires a direct ByteBuffer" }
+        if (!isInitialized) return buffer.remaining()
+
+        return try {
+            nativeProcessCaptureFrameDirect(nativeHandle, buffer, buffer.position(), buffer.remaining())
+        } catch (e: Exception) {
+            Log.e(TAG, "processCaptureFrame(direct) failed", e)
+            -1
+        }
+    }
+
+    /**
+     * 上一次 [processCaptureFrame] 的输出中是否有语音（含拖尾），VAD 关闭时恒为 true
+     *
+     * 需在处理调用所在的线程上、处理之后调用
+     */
+    fun lastCaptureSpeech(): Boolean {
+        if (!isInitialized) return true
+
+        return try {
+            nativeLastCaptureSpeech(nativeHandle)
+        } catch (e: Exception) {
+            Log.e(TAG, "lastCaptureSpeech failed", e)
+            true
+        }
+    }
+
+    /**
+     * 批量处理积压的采集音频（如 ASR 重连后补发）
+     *
+     * 整批一次 JNI 调用，native 内按 [frameSamples] 逐帧循环；
+     * [renderData] 为与采集逐样本对应的参考信号，可为 null
+     *
+     * @return 处理后的数据；未初始化时原样返回，失败返回 null
+     */
+    fun processCaptureBatch(captureData: ByteArray, renderData: ByteArray?, frameSamples: Int): ByteArray? {
+        if (!isInitialized) return captureData
+
+        return try {
+            nativeProcessCaptureBatch(nativeHandle, captureData, renderData, frameSamples)
+        } catch (e: Exception) {
+            Log.e(TAG, "processCaptureBatch failed", e)
+            null
+        }
+    }
+
     /**
      * 处理渲染的音频帧（TTS 参考信号）
      */
@@ -209,6 +321,118 @@ class WebrtcAudioProcessor {
         }
     }
 
+    /**
+     * 当前系统是否支持原生采集（需要 AAudio，Android 8.0+）
+     */
+    fun isNativeCaptureSupported(): Boolean {
+        return try {
+            nativeIsCaptureSupported()
+        } catch (e: UnsatisfiedLinkError) {
+            false
+        }
+    }
+
+    /**
+     * 启动原生采集：由 native 持有 AAudio 输入流并在音频回调线程上直接处理
+     *
+     * 处理后的数据通过 [readNativeCapture] 取出；需要已获得 RECORD_AUDIO 权限
+     */
+    fun startNativeCapture(): Boolean {
+        if (!isInitialized) return false
+
+        return try {
+            nativeStartCapture(nativeHandle)
+        } catch (e: Exception) {
+            Log.e(TAG, "startNativeCapture failed", e)
+            false
+        }
+    }
+
+    /**
+     * 停止原生采集，阻塞在 [readNativeCapture] 上的线程随即返回 -1
+     */
+    fun stopNativeCapture() {
+        if (!isInitialized) return
+
+        try {
+            nativeStopCapture(nativeHandle)
+        } catch (e: Exception) {
+            Log.e(TAG, "stopNativeCapture failed", e)
+        }
+    }
+
+    /**
+     * 阻塞读取处理后的采集数据，写满 direct ByteBuffer 的 [0, length) 区间
+     *
+     * @return 读取的字节数（恰好 length），超时返回 0，采集已停止或出错返回 -1
+     */
+    fun readNativeCapture(buffer: ByteBuffer, length: Int, timeoutMs: Int): Int {
+        require(buffer.isDirect) { "readNativeCapture requires a direct ByteBuffer" }
+        if (!isInitialized) return -1
+
+        return try {
+            nativeReadCapture(nativeHandle, buffer, length, timeoutMs)
+        } catch (e: Exception) {
+            Log.e(TAG, "readNativeCapture failed", e)
+            -1
+        }
+    }
+
+    /**
+     * 获取处理统计（各阶段每 10ms 块的耗时分位数、削波计数、AEC 延迟等）
+     *
+     * 可在处理进行时从任意线程调用；统计区间为初始化或上次 [resetStats] 之后
+     *
+     * @return 未初始化或失败时返回 null
+     */
+    fun getStats(): Map<String, Any>? {
+        if (!isInitialized) return null
+
+        val values = try {
+            nativeGetStats(nativeHandle)
+        } catch (e: Exception) {
+            Log.e(TAG, "getStats failed", e)
+            null
+        } ?: return null
+
+        // 与 native 侧 nativeGetStats 的打包顺序一致
+        fun stage(offset: Int): Map<String, Long> = mapOf(
+            "blocks" to values[offset],
+            "p50Us" to values[offset + 1],
+            "p99Us" to values[offset + 2],
+            "maxUs" to values[offset + 3]
+        )
+        return mapOf(
+            "captureBlocks" to values[0],
+            "renderFrames" to values[1],
+            "renderOverruns" to values[2],
+            "inputClippedSamples" to values[3],
+            "outputClippedSamples" to values[4],
+            "processingTimeUs" to values[5],
+            "aecDelayMs" to values[6],
+            "renderBufferedMs" to values[7],
+            "speechBlocks" to values[8],
+            "aec" to stage(9),
+            "ns" to stage(13),
+            "agc" to stage(17),
+            "vad" to stage(21),
+            "total" to stage(25)
+        )
+    }
+
+    /**
+     * 清空处理统计，从下一个采集块开始重新计数
+     */
+    fun resetStats() {
+        if (!isInitialized) return
+
+        try {
+            nativeResetStats(nativeHandle)
+        } catch (e: Exception) {
+            Log.e(TAG, "resetStats failed", e)
+        }
+    }
+
     /**
      * 获取状态
      */
@@ -218,6 +442,9 @@ class WebrtcAudioProcessor {
             "aecEnabled" to aecEnabled,
             "nsEnabled" to nsEnabled,
             "agcEnabled" to agcEnabled,
+            "vadEnabled" to vadEnabled,
+            "downmixEnabled" to downmixEnabled,
+            "channels" to channels,
             "aecSuppressionLevel" to aecSuppressionLevel,
             "nsSuppressionLevel" to nsSuppressionLevel,
             "agcMode" to agcMode,
@@ -235,6 +462,17 @@ class WebrtcAudioProcessor {
     private external fun nativeSetAgcEnabled(handle: Long, enabled: Boolean): Boolean
     private external fun nativeSetAgcMode(handle: Long, mode: Int): Boolean
     private external fun nativeSetAgcTargetLevel(handle: Long, targetLevelDbfs: Int): Boolean
+    private external fun nativeSetVadEnabled(handle: Long, enabled: Boolean): Boolean
+    private external fun nativeSetDownmixEnabled(handle: Long, enabled: Boolean): Boolean
+    private external fun nativeLastCaptureSpeech(handle: Long): Boolean
     private external fun nativeProcessCaptureFrame(handle: Long, audioData: ByteArray): ByteArray?
+    private external fun nativeProcessCaptureFrameDirect(handle: Long, buffer: ByteBuffer, offset: Int, length: Int): Int
     private external fun nativeProcessRenderFrame(handle: Long, audioData: ByteArray): Boolean
+    private external fun nativeProcessCaptureBatch(handle: Long, captureData: ByteArray, renderData: ByteArray?, frameSamples: Int): ByteArray?
+    private external fun nativeGetStats(handle: Long): LongArray?
+    private external fun nativeResetStats(handle: Long)
+    private external fun nativeIsCaptureSupported(): Boolean
+    private external fun nativeStartCapture(handle: Long): Boolean
+    private external fun nativeStopCapture(handle: Long)
+    private external fun nativeReadCapture(handle: Long, buffer: ByteBuffer, length: Int, timeoutMs: Int): Int
 }
@@ -0,0 +1,63 @@
+#import <AVFoundation/AVFoundation.h>
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/// 共享 C++ 处理核心（packages/webrtc_apm/src）的 Objective-C 桥接，供 Swift 调用
+///
+/// 与 Android 使用同一份 AudioProcessor。采集与渲染可以在两个线程上并发调用，
+/// 配置调用可与处理调用并发，在下一个 10ms 采集块开始时生效
+@interface WebrtcApmBridge : NSObject
+
+/// 初始化失败时返回 nil
+- (nullable instancetype)initWithSampleRate:(NSInteger)sampleRate channels:(NSInteger)channels;
+- (instancetype)init NS_UNAVAILABLE;
+
+@property(nonatomic, readonly) NSInteger sampleRate;
+@property(nonatomic, readonly) NSInteger channels;
+
+- (BOOL)setAecEnabled:(BOOL)enabled;
+- (BOOL)setAecSuppressionLevel:(NSInteger)level;
+- (BOOL)setNsEnabled:(BOOL)enabled;
+- (BOOL)setNsSuppressionLevel:(NSInteger)level;
+- (BOOL)setAgcEnabled:(BOOL)enabled;
+- (BOOL)setAgcMode:(NSInteger)mode;
+- (BOOL)setAgcTargetLevel:(NSInteger)targetLevelDbfs;
+- (BOOL)setVadEnabled:(BOOL)enabled;
+- (BOOL)setDownmixEnabled:(BOOL)enabled;
+
+/// 原地处理 count 个交织的 PCM16 样本
+/// @return 处理后的样本数
+- (NSInteger)processCapture:(int16_t *)samples count:(NSInteger)count;
+
+/// 上一次采集处理的输出中是否有语音（含拖尾），VAD 关闭时恒为 YES
+@property(nonatomic, readonly) BOOL lastCaptureSpeech;
+
+/// 输入 count 个交织的 PCM16 参考信号样本
+- (BOOL)processRender:(const int16_t *)samples count:(NSInteger)count;
+
+/// 批量处理积压的采集音频（原地），语义同 AudioProcessor::ProcessCaptureBatch
+/// @return 处理的样本数
+- (NSInteger)processCaptureBatch:(int16_t *)capture
+                           count:(NSInteger)count
+                          render:(nullable const int16_t *)render
+                     renderCount:(NSInteger)renderCount
+                    frameSamples:(NSInteger)frameSamples;
+
+/// 原地处理 AVAudioPCMBuffer 的 [0, frameLength) 区间
+///
+/// PCM16 交织或单声道的缓冲区直接在其内存上处理（零拷贝）；
+/// Float32 与非交织多声道经内部复用的缓冲区换算，稳定后不再分配内存。
+/// 采样率与声道数须与初始化时一致，否则返回 NO
+- (BOOL)processCaptureBuffer:(AVAudioPCMBuffer *)buffer;
+
+/// 输入 AVAudioPCMBuffer 作为参考信号，格式要求同 processCaptureBuffer:
+- (BOOL)processRenderBuffer:(AVAudioPCMBuffer *)buffer;
+
+/// 处理统计，键与 Android 的 getStats 一致
+- (NSDictionary<NSString *, id> *)stats;
+- (void)resetStats;
+
+@end
+
+NS_ASSUME_NONNULL_END
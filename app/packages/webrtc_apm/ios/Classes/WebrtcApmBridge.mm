@@ -0,0 +1,252 @@
+#import "WebrtcApmBridge.h"
+
+#include "../../src/include/audio_processor.h"
+#include "../../src/audio_kernels.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace {
+    using webrtc_apm::AudioProcessor;
+    namespace dsp = webrtc_apm::dsp;
+
+    // PCM16 满幅
+    constexpr float kInt16Scale = 32768.0f;
+
+    /**
+     * 取得缓冲区的交织 PCM16 样本
+     *
+     * PCM16 交织或单声道时直接返回缓冲区内存；其他格式换算到 scratch
+     * @return 不支持的格式时返回 nullptr
+     */
+    int16_t* GatherSamples(AVAudioPCMBuffer* buffer, int channels, std::vector<int16_t>* scratch) {
+        AVAudioFrameCount frames = buffer.frameLength;
+        size_t count = static_cast<size_t>(frames) * channels;
+        bool interleaved = buffer.format.isInterleaved || channels == 1;
+
+        switch (buffer.format.commonFormat) {
+            case AVAudioPCMFormatInt16: {
+                int16_t* const* data = buffer.int16ChannelData;
+                if (interleaved) return data[0];
+                if (scratch->size() < count) scratch->resize(count);
+                for (int c = 0; c < channels; ++c) {
+                    for (AVAudioFrameCount i = 0; i < frames; ++i) {
+                        (*scratch)[i * channels + c] = data[c][i];
+                    }
+                }
+                return scratch->data();
+            }
+            case AVAudioPCMFormatFloat32: {
+                float* const* data = buffer.floatChannelData;
+                if (interleaved) {
+                    if (scratch->size() < count) scratch->resize(count);
+                    dsp::FloatToInt16(data[0], scratch->data(), static_cast<int>(count), kInt16Scale);
+                    return scratch->data();
+                }
+
+                // 非交织：逐声道换算到后半段，再交织到前半段
+                if (scratch->size() < count * 2) scratch->resize(count * 2);
+                int16_t* packed = scratch->data();
+                int16_t* planar = scratch->data() + count;
+                for (int c = 0; c < channels; ++c) {
+                    dsp::FloatToInt16(data[c], planar + static_cast<size_t>(c) * frames,
+                                      static_cast<int>(frames), kInt16Scale);
+                }
+                for (int c = 0; c < channels; ++c) {
+                    for (AVAudioFrameCount i = 0; i < frames; ++i) {
+                        packed[i * channels + c] = planar[static_cast<size_t>(c) * frames + i];
+                    }
+                }
+                return packed;
+            }
+            default:
+                return nullptr;
+        }
+    }
+
+    /**
+     * 把处理后的交织样本写回缓冲区（零拷贝时 samples 即缓冲区内存，无需写回）
+     */
+    void ScatterSamples(AVAudioPCMBuffer* buffer, int channels, const int16_t* samples) {
+        AVAudioFrameCount frames = buffer.frameLength;
+        size_t count = static_cast<size_t>(frames) * channels;
+        bool interleaved = buffer.format.isInterleaved || channels == 1;
+
+        if (buffer.format.commonFormat == AVAudioPCMFormatInt16) {
+            int16_t* const* data = buffer.int16ChannelData;
+            if (interleaved) return;
+            for (int c = 0; c < channels; ++c) {
+                for (AVAudioFrameCount i = 0; i < frames; ++i) {
+                    data[c][i] = samples[i * channels + c];
+                }
+            }
+            return;
+        }
+
+        float* const* data = buffer.floatChannelData;
+        if (interleaved) {
+            dsp::Int16ToFloat(samples, data[0], static_cast<int>(count), 1.0f / kInt16Scale);
+            return;
+        }
+        for (int c = 0; c < channels; ++c) {
+            for (AVAudioFrameCount i = 0; i < frames; ++i) {
+                data[c][i] = samples[i * channels + c] / kInt16Scale;
+            }
+        }
+    }
+
+    NSDictionary<NSString*, NSNumber*>* StageToDictionary(const webrtc_apm::StageLatency& stage) {
+        return @{
+            @"blocks" : @(stage.blocks),
+            @"p50Us" : @(stage.p50Us),
+            @"p99Us" : @(stage.p99Us),
+            @"maxUs" : @(stage.maxUs),
+        };
+    }
+}
+
+@implementation WebrtcApmBridge {
+    AudioProcessor _processor;
+
+    // 格式换算缓冲区：采集与渲染可能在不同线程上，各用一块
+    std::vector<int16_t> _captureScratch;
+    std::vector<int16_t> _renderScratch;
+}
+
+- (nullable instancetype)initWithSampleRate:(NSInteger)sampleRate channels:(NSInteger)channels {
+    self = [super init];
+    if (!self) return nil;
+    if (!_processor.Initialize(static_cast<int>(sampleRate), static_cast<int>(channels))) {
+        return nil;
+    }
+    return self;
+}
+
+- (void)dealloc {
+    _processor.Destroy();
+}
+
+- (NSInteger)sampleRate {
+    return _processor.SampleRate();
+}
+
+- (NSInteger)channels {
+    return _processor.Channels();
+}
+
+- (BOOL)setAecEnabled:(BOOL)enabled {
+    return _processor.SetAecEnabled(enabled);
+}
+
+- (BOOL)setAecSuppressionLevel:(NSInteger)level {
+    return _processor.SetAecSuppressionLevel(static_cast<int>(level));
+}
+
+- (BOOL)setNsEnabled:(BOOL)enabled {
+    return _processor.SetNsEnabled(enabled);
+}
+
+- (BOOL)setNsSuppressionLevel:(NSInteger)level {
+    return _processor.SetNsSuppressionLevel(static_cast<int>(level));
+}
+
+- (BOOL)setAgcEnabled:(BOOL)enabled {
+    return _processor.SetAgcEnabled(enabled);
+}
+
+- (BOOL)setAgcMode:(NSInteger)mode {
+    return _processor.SetAgcMode(static_cast<int>(mode));
+}
+
+- (BOOL)setAgcTargetLevel:(NSInteger)targetLevelDbfs {
+    return _processor.SetAgcTargetLevel(static_cast<int>(targetLevelDbfs));
+}
+
+- (BOOL)setVadEnabled:(BOOL)enabled {
+    return _processor.SetVadEnabled(enabled);
+}
+
+- (BOOL)setDownmixEnabled:(BOOL)enabled {
+    return _processor.SetDownmixEnabled(enabled);
+}
+
+- (BOOL)lastCaptureSpeech {
+    return _processor.LastCaptureSpeech();
+}
+
+- (NSInteger)processCapture:(int16_t*)samples count:(NSInteger)count {
+    if (!samples || count <= 0) return 0;
+    return _processor.ProcessCaptureFrame(samples, static_cast<int>(count), samples);
+}
+
+- (BOOL)processRender:(const int16_t*)samples count:(NSInteger)count {
+    if (!samples || count <= 0) return NO;
+    return _processor.ProcessRenderFrame(samples, static_cast<int>(count));
+}
+
+- (NSInteger)processCaptureBatch:(int16_t*)capture
+                           count:(NSInteger)count
+                          render:(nullable const int16_t*)render
+                     renderCount:(NSInteger)renderCount
+                    frameSamples:(NSInteger)frameSamples {
+    return _processor.ProcessCaptureBatch(capture, static_cast<int>(count),
+                                          render, render ? static_cast<int>(renderCount) : 0,
+                                          static_cast<int>(frameSamples), capture);
+}
+
+- (BOOL)matchesFormat:(AVAudioPCMBuffer*)buffer {
+    return static_cast<int>(buffer.format.sampleRate) == _processor.SampleRate() &&
+           static_cast<int>(buffer.format.channelCount) == _processor.Channels();
+}
+
+- (BOOL)processCaptureBuffer:(AVAudioPCMBuffer*)buffer {
+    if (![self matchesFormat:buffer]) return NO;
+    if (buffer.frameLength == 0) return YES;
+
+    int channels = _processor.Channels();
+    int16_t* samples = GatherSamples(buffer, channels, &_captureScratch);
+    if (!samples) return NO;
+
+    int count = static_cast<int>(buffer.frameLength) * channels;
+    _processor.ProcessCaptureFrame(samples, count, samples);
+    ScatterSamples(buffer, channels, samples);
+    return YES;
+}
+
+- (BOOL)processRenderBuffer:(AVAudioPCMBuffer*)buffer {
+    if (![self matchesFormat:buffer]) return NO;
+    if (buffer.frameLength == 0) return YES;
+
+    int channels = _processor.Channels();
+    int16_t* samples = GatherSamples(buffer, channels, &_renderScratch);
+    if (!samples) return NO;
+
+    return _processor.ProcessRenderFrame(samples, static_cast<int>(buffer.frameLength) * channels);
+}
+
+- (NSDictionary<NSString*, id>*)stats {
+    webrtc_apm::ProcessingStats stats;
+    if (!_processor.GetStats(&stats)) return @{};
+    return @{
+        @"captureBlocks" : @(stats.captureBlocks),
+        @"renderFrames" : @(stats.renderFrames),
+        @"renderOverruns" : @(stats.renderOverruns),
+        @"inputClippedSamples" : @(stats.inputClippedSamples),
+        @"outputClippedSamples" : @(stats.outputClippedSamples),
+        @"processingTimeUs" : @(stats.processingTimeUs),
+        @"aecDelayMs" : @(stats.aecDelayMs),
+        @"renderBufferedMs" : @(stats.renderBufferedMs),
+        @"speechBlocks" : @(stats.speechBlocks),
+        @"aec" : StageToDictionary(stats.aec),
+        @"ns" : StageToDictionary(stats.ns),
+        @"agc" : StageToDictionary(stats.agc),
+        @"vad" : StageToDictionary(stats.vad),
+        @"total" : StageToDictionary(stats.total),
+    };
+}
+
+- (void)resetStats {
+    _processor.ResetStats();
+}
+
+@end
@@ -6,6 +6,15 @@ import AVFoundation
 public class WebrtcApmPlugin: NSObject, FlutterPlugin {
     private var audioProcessor: WebrtcAudioProcessor?
 
+    // 批量处理在后台串行执行，避免阻塞平台线程；
+    // 批量在独立的处理状态上运行，不与平台线程上的实时处理竞争
+    private let batchQueue = DispatchQueue(label: "webrtc_apm.batch")
+
+    // 音频帧级调用过于频繁，不逐次打印日志
+    private static let hotMethods: Set<String> = [
+        "processCaptureFrame", "processCaptureFrameWithVad", "processRenderFrame", "processCaptureBatch"
+    ]
+
     public static func register(with registrar: FlutterPluginRegistrar) {
         let channel = FlutterMethodChannel(name: "webrtc_apm", binaryMessenger: registrar.messenger())
         let instance = WebrtcApmPlugin()
@@ -14,7 +23,9 @@ public class WebrtcApmPlugin: NSObject, FlutterPlugin {
     }
 
     public func handle(_ call: FlutterMethodCall, result: @escaping FlutterResult) {
-        NSLog("[WebrtcApmPlugin] Method called: \(call.method)")
+        if !WebrtcApmPlugin.hotMethods.contains(call.method) {
+            NSLog("[WebrtcApmPlugin] Method called: \(call.method)")
+        }
 
         switch call.method {
         case "initialize":
@@ -35,12 +46,28 @@ public class WebrtcApmPlugin: NSObject, FlutterPlugin {
             handleSetAgcMode(call, result: result)
         case "setAgcTargetLevel":
             handleSetAgcTargetLevel(call, result: result)
+        case "setVadEnabled":
+            handleSetVadEnabled(call, result: result)
+        case "setDownmixEnabled":
+            handleSetDownmixEnabled(call, result: result)
         case "processCaptureFrame":
             handleProcessCaptureFrame(call, result: result)
+        case "processCaptureFrameWithVad":
+            handleProcessCaptureFrameWithVad(call, result: result)
         case "processRenderFrame":
             handleProcessRenderFrame(call, result: result)
+        case "processCaptureBatch":
+            handleProcessCaptureBatch(call, result: result)
         case "getStatus":
             handleGetStatus(result: result)
+        case "getStats":
+            result(audioProcessor?.getStats())
+        case "resetStats":
+            audioProcessor?.resetStats()
+            result(nil)
+        case "isNativeCaptureSupported":
+            // iOS 暂无原生采集通路，由 Dart 侧录音后调用 processAudio
+            result(false)
         default:
             result(FlutterMethodNotImplemented)
         }
@@ -165,6 +192,65 @@ public class WebrtcApmPlugin: NSObject, FlutterPlugin {
         }
     }
 
+    private func handleSetVadEnabled(_ call: FlutterMethodCall, result: @escaping FlutterResult) {
+        guard let args = call.arguments as? [String: Any],
+              let enabled = args["enabled"] as? Bool else {
+            result(false)
+            return
+        }
+
+        let success = audioProcessor?.setVadEnabled(enabled) ?? false
+        result(success)
+    }
+
+    private func handleSetDownmixEnabled(_ call: FlutterMethodCall, result: @escaping FlutterResult) {
+        guard let args = call.arguments as? [String: Any],
+              let enabled = args["enabled"] as? Bool else {
+            result(false)
+            return
+        }
+
+        let success = audioProcessor?.setDownmixEnabled(enabled) ?? false
+        result(success)
+    }
+
+    /// 处理一帧并附带语音判决，一次平台通道往返同时返回两者
+    private func handleProcessCaptureFrameWithVad(_ call: FlutterMethodCall, result: @escaping FlutterResult) {
+        guard let args = call.arguments as? [String: Any],
+              let audioData = args["audioData"] as? FlutterStandardTypedData else {
+            result(FlutterError(code: "INVALID_INPUT", message: "Audio data is null", details: nil))
+            return
+        }
+
+        let processedData = audioProcessor?.processCaptureFrame(audioData.data)
+        result([
+            "audioData": processedData.map { FlutterStandardTypedData(bytes: $0) } ?? audioData,
+            "isSpeech": audioProcessor?.lastCaptureSpeech ?? true
+        ])
+    }
+
+    private func handleProcessCaptureBatch(_ call: FlutterMethodCall, result: @escaping FlutterResult) {
+        guard let args = call.arguments as? [String: Any],
+              let audioData = args["audioData"] as? FlutterStandardTypedData else {
+            result(FlutterError(code: "INVALID_INPUT", message: "Audio data is null", details: nil))
+            return
+        }
+        guard let processor = audioProcessor else {
+            result(audioData)
+            return
+        }
+
+        let renderData = (args["renderData"] as? FlutterStandardTypedData)?.data
+        let frameSamples = args["frameSamples"] as? Int ?? 160
+
+        batchQueue.async {
+            let processedData = processor.processCaptureBatch(audioData.data, renderData: renderData, frameSamples: frameSamples)
+            DispatchQueue.main.async {
+                result(processedData.map { FlutterStandardTypedData(bytes: $0) } ?? audioData)
+            }
+        }
+    }
+
     private func handleProcessRenderFrame(_ call: FlutterMethodCall, result: @escaping FlutterResult) {
         guard let args = call.arguments as? [String: Any],
               let audioData = args["audioData"] as? FlutterStandardTypedData else {
@@ -1,12 +1,12 @@
 import Foundation
 import AVFoundation
-import Accelerate
 
 /// WebRTC 音频处理器 (iOS)
 ///
-/// 提供软件级的 AEC/NS/AGC 处理
+/// 通过 WebrtcApmBridge 调用与 Android 共用的 C++ 处理核心（packages/webrtc_apm/src），
+/// 两个平台的 AEC/NS/AGC 行为与性能优化保持一致
 class WebrtcAudioProcessor {
-    private var isInitialized = false
+    private var bridge: WebrtcApmBridge?
     private var sampleRate: Int = 16000
     private var channels: Int = 1
 
@@ -14,14 +14,14 @@ class WebrtcAudioProcessor {
     private var aecEnabled = false
     private var nsEnabled = false
     private var agcEnabled = false
+    private var vadEnabled = false
+    private var downmixEnabled = false
     private var aecSuppressionLevel = 2
     private var nsSuppressionLevel = 2
     private var agcMode = 1
     private var agcTargetLevel = 3
 
-    // 参考信号缓冲区（用于 AEC）
-    private var renderBuffer: [Int16] = []
-    private var renderBufferSize: Int = 0
+    private var isInitialized: Bool { bridge != nil }
 
     init() {}
 
@@ -31,130 +31,190 @@ class WebrtcAudioProcessor {
             return true
         }
 
+        guard let bridge = WebrtcApmBridge(sampleRate: sampleRate, channels: channels) else {
+            NSLog("[WebrtcAudioProcessor] Failed to initialize: sampleRate=\(sampleRate), channels=\(channels)")
+            return false
+        }
+        self.bridge = bridge
         self.sampleRate = sampleRate
         self.channels = channels
 
-        // 初始化参考信号缓冲区（存储约 100ms 的音频）
-        let bufferSize = sampleRate / 10 * channels
-        renderBuffer = [Int16](repeating: 0, count: bufferSize)
-        renderBufferSize = 0
+        // 重新初始化后沿用之前的配置
+        _ = bridge.setAecSuppressionLevel(aecSuppressionLevel)
+        _ = bridge.setNsSuppressionLevel(nsSuppressionLevel)
+        _ = bridge.setAgcMode(agcMode)
+        _ = bridge.setAgcTargetLevel(agcTargetLevel)
+        _ = bridge.setAecEnabled(aecEnabled)
+        _ = bridge.setNsEnabled(nsEnabled)
+        _ = bridge.setAgcEnabled(agcEnabled)
+        _ = bridge.setVadEnabled(vadEnabled)
+        _ = bridge.setDownmixEnabled(downmixEnabled)
 
-        isInitialized = true
         NSLog("[WebrtcAudioProcessor] Initialized: sampleRate=\(sampleRate), channels=\(channels)")
         return true
     }
 
     func dispose() {
-        renderBuffer = []
-        renderBufferSize = 0
-        isInitialized = false
+        bridge = nil
         NSLog("[WebrtcAudioProcessor] Disposed")
     }
 
     func setAecEnabled(_ enabled: Bool) -> Bool {
+        guard let bridge = bridge, bridge.setAecEnabled(enabled) else { return false }
         aecEnabled = enabled
         NSLog("[WebrtcAudioProcessor] AEC enabled: \(enabled)")
         return true
     }
 
     func setAecSuppressionLevel(_ level: Int) -> Bool {
+        guard let bridge = bridge, bridge.setAecSuppressionLevel(level) else { return false }
         aecSuppressionLevel = min(max(level, 0), 2)
         NSLog("[WebrtcAudioProcessor] AEC suppression level: \(aecSuppressionLevel)")
         return true
     }
 
     func setNsEnabled(_ enabled: Bool) -> Bool {
+        guard let bridge = bridge, bridge.setNsEnabled(enabled) else { return false }
         nsEnabled = enabled
         NSLog("[WebrtcAudioProcessor] NS enabled: \(enabled)")
         return true
     }
 
     func setNsSuppressionLevel(_ level: Int) -> Bool {
+        guard let bridge = bridge, bridge.setNsSuppressionLevel(level) else { return false }
         nsSuppressionLevel = min(max(level, 0), 3)
         NSLog("[WebrtcAudioProcessor] NS suppression level: \(nsSuppressionLevel)")
         return true
     }
 
     func setAgcEnabled(_ enabled: Bool) -> Bool {
+        guard let bridge = bridge, bridge.setAgcEnabled(enabled) else { return false }
         agcEnabled = enabled
         NSLog("[WebrtcAudioProcessor] AGC enabled: \(enabled)")
         return true
     }
 
     func setAgcMode(_ mode: Int) -> Bool {
+        guard let bridge = bridge, bridge.setAgcMode(mode) else { return false }
         agcMode = min(max(mode, 0), 2)
         NSLog("[WebrtcAudioProcessor] AGC mode: \(agcMode)")
         return true
     }
 
     func setAgcTargetLevel(_ targetLevelDbfs: Int) -> Bool {
+        guard let bridge = bridge, bridge.setAgcTargetLevel(targetLevelDbfs) else { return false }
         agcTargetLevel = min(max(targetLevelDbfs, 0), 31)
         NSLog("[WebrtcAudioProcessor] AGC target level: \(agcTargetLevel)")
         return true
     }
 
+    func setVadEnabled(_ enabled: Bool) -> Bool {
+        guard let bridge = bridge, bridge.setVadEnabled(enabled) else { return false }
+        vadEnabled = enabled
+        NSLog("[WebrtcAudioProcessor] VAD enabled: \(enabled)")
+        return true
+    }
+
+    /// 多声道采集混为单声道后只处理一路，输出复制到各声道
+    func setDownmixEnabled(_ enabled: Bool) -> Bool {
+        guard let bridge = bridge, bridge.setDownmixEnabled(enabled) else { return false }
+        downmixEnabled = enabled
+        NSLog("[WebrtcAudioProcessor] Downmix enabled: \(enabled)")
+        return true
+    }
+
+    /// 上一次采集处理的输出中是否有语音，VAD 关闭或未初始化时恒为 true
+    var lastCaptureSpeech: Bool {
+        return bridge?.lastCaptureSpeech ?? true
+    }
+
+    /// 处理 PCM16 字节数据，返回处理后的新数据
+    ///
+    /// 平台通道传入的数据不可修改，这里复制一次后原地处理
     func processCaptureFrame(_ audioData: Data) -> Data? {
-        guard isInitialized else { return audioData }
+        guard let bridge = bridge else { return audioData }
 
-        // 将 Data 转换为 Int16 数组
-        var samples = audioData.withUnsafeBytes { (buffer: UnsafeRawBufferPointer) -> [Int16] in
-            let int16Buffer = buffer.bindMemory(to: Int16.self)
-            return Array(int16Buffer)
+        let count = audioData.count / MemoryLayout<Int16>.size
+        if count == 0 { return audioData }
+
+        var output = Data(count: audioData.count)
+        output.withUnsafeMutableBytes { (raw: UnsafeMutableRawBufferPointer) in
+            guard let base = raw.baseAddress else { return }
+            audioData.copyBytes(to: raw.bindMemory(to: UInt8.self))
+            _ = bridge.processCapture(base.assumingMemoryBound(to: Int16.self), count: count)
         }
+        return output
+    }
 
-        if samples.isEmpty { return audioData }
+    /// 原地处理录音回调中的 AVAudioPCMBuffer
+    ///
+    /// PCM16 交织或单声道缓冲区零拷贝；采样率与声道数须与 [initialize] 一致
+    func processCaptureBuffer(_ buffer: AVAudioPCMBuffer) -> Bool {
+        return bridge?.processCaptureBuffer(buffer) ?? false
+    }
 
-        // 应用 AEC
-        if aecEnabled && renderBufferSize > 0 {
-            applyEchoCancellation(&samples)
-        }
+    /// 批量处理积压的采集音频，[renderData] 为与采集逐样本对应的参考信号
+    func processCaptureBatch(_ captureData: Data, renderData: Data?, frameSamples: Int) -> Data? {
+        guard let bridge = bridge else { return captureData }
 
-        // 应用 NS
-        if nsEnabled {
-            applyNoiseSuppression(&samples)
-        }
+        let count = captureData.count / MemoryLayout<Int16>.size
+        if count == 0 { return captureData }
 
-        // 应用 AGC
-        if agcEnabled {
-            applyGainControl(&samples)
+        // 参考信号复制到对齐的数组；平台通道的字节数据不保证 2 字节对齐
+        var render: [Int16] = []
+        if let renderData = renderData {
+            render = [Int16](repeating: 0, count: renderData.count / MemoryLayout<Int16>.size)
+            render.withUnsafeMutableBytes { raw in
+                _ = renderData.copyBytes(to: raw.bindMemory(to: UInt8.self))
+            }
         }
 
-        // 转换回 Data
-        return samples.withUnsafeBufferPointer { buffer in
-            Data(buffer: buffer)
+        var output = Data(count: count * MemoryLayout<Int16>.size)
+        var processed = 0
+        output.withUnsafeMutableBytes { (raw: UnsafeMutableRawBufferPointer) in
+            guard let base = raw.baseAddress else { return }
+            captureData.copyBytes(to: raw.bindMemory(to: UInt8.self), count: raw.count)
+            render.withUnsafeBufferPointer { renderBuffer in
+                processed = bridge.processCaptureBatch(base.assumingMemoryBound(to: Int16.self),
+                                                       count: count,
+                                                       render: renderBuffer.baseAddress,
+                                                       renderCount: renderBuffer.count,
+                                                       frameSamples: frameSamples)
+            }
         }
+        return processed > 0 ? output : nil
     }
 
     func processRenderFrame(_ audioData: Data) -> Bool {
-        guard isInitialized else { return false }
+        guard let bridge = bridge else { return false }
 
-        // 将 Data 转换为 Int16 数组
-        let samples = audioData.withUnsafeBytes { (buffer: UnsafeRawBufferPointer) -> [Int16] in
-            let int16Buffer = buffer.bindMemory(to: Int16.self)
-            return Array(int16Buffer)
-        }
+        let count = audioData.count / MemoryLayout<Int16>.size
+        if count == 0 { return false }
 
-        if samples.isEmpty { return false }
-
-        // 更新参考信号缓冲区（循环缓冲）
-        let copySize = min(samples.count, renderBuffer.count)
-        if copySize > 0 {
-            // 移动旧数据
-            let shiftSize = renderBuffer.count - copySize
-            if shiftSize > 0 {
-                for i in 0..<shiftSize {
-                    renderBuffer[i] = renderBuffer[i + copySize]
-                }
-            }
-            // 复制新数据
-            let sourceOffset = samples.count - copySize
-            for i in 0..<copySize {
-                renderBuffer[shiftSize + i] = samples[sourceOffset + i]
+        return audioData.withUnsafeBytes { (raw: UnsafeRawBufferPointer) -> Bool in
+            guard let base = raw.baseAddress else { return false }
+            if Int(bitPattern: base) % MemoryLayout<Int16>.alignment == 0 {
+                return bridge.processRender(base.assumingMemoryBound(to: Int16.self), count: count)
             }
-            renderBufferSize = min(renderBufferSize + samples.count, renderBuffer.count)
+            // 未对齐时复制一份
+            var samples = [Int16](repeating: 0, count: count)
+            samples.withUnsafeMutableBytes { $0.copyMemory(from: UnsafeRawBufferPointer(rebasing: raw[0..<count * 2])) }
+            return bridge.processRender(samples, count: count)
         }
+    }
 
-        return true
+    /// 输入播放中的 AVAudioPCMBuffer 作为 AEC 参考信号
+    func processRenderBuffer(_ buffer: AVAudioPCMBuffer) -> Bool {
+        return bridge?.processRenderBuffer(buffer) ?? false
+    }
+
+    /// 处理统计，未初始化时返回 nil
+    func getStats() -> [String: Any]? {
+        return bridge?.stats()
+    }
+
+    func resetStats() {
+        bridge?.resetStats()
     }
 
     func getStatus() -> [String: Any] {
@@ -163,142 +223,13 @@ class WebrtcAudioProcessor {
             "aecEnabled": aecEnabled,
             "nsEnabled": nsEnabled,
             "agcEnabled": agcEnabled,
+            "vadEnabled": vadEnabled,
+            "downmixEnabled": downmixEnabled,
+            "channels": channels,
             "aecSuppressionLevel": aecSuppressionLevel,
             "nsSuppressionLevel": nsSuppressionLevel,
             "agcMode": agcMode,
             "agcTargetLevel": agcTargetLevel
         ]
     }
-
-    // MARK: - Private Methods
-
-    /// 简化的回声消除
-    private func applyEchoCancellation(_ samples: inout [Int16]) {
-        guard renderBufferSize > 0 else { return }
-
-        // 计算相关性
-        let correlation = calculateCorrelation(samples)
-
-        // 根据抑制级别和相关性决定衰减系数
-        let suppressionFactors: [Float] = [0.7, 0.5, 0.3] // low, moderate, high
-        let suppressionFactor = suppressionFactors[aecSuppressionLevel]
-
-        // 如果相关性高，应用衰减
-        if correlation > 0.5 {
-            let attenuation = max(1.0 - (correlation * suppressionFactor), 0.1)
-
-            for i in 0..<samples.count {
-                samples[i] = Int16(Float(samples[i]) * attenuation)
-            }
-
-            NSLog("[WebrtcAudioProcessor] AEC: correlation=\(String(format: "%.2f", correlation)), attenuation=\(String(format: "%.2f", attenuation))")
-        }
-    }
-
-    /// 计算与参考信号的相关性
-    private func calculateCorrelation(_ samples: [Int16]) -> Float {
-        guard renderBufferSize > 0, !samples.isEmpty else { return 0.0 }
-
-        let compareSize = min(samples.count, renderBufferSize)
-        let startOffset = renderBuffer.count - renderBufferSize
-
-        var sumXY: Float = 0.0
-        var sumX2: Float = 0.0
-        var sumY2: Float = 0.0
-
-        for i in 0..<compareSize {
-            let x = Float(samples[i])
-            let y = Float(renderBuffer[startOffset + i])
-            sumXY += x * y
-            sumX2 += x * x
-            sumY2 += y * y
-        }
-
-        if sumX2 < 1.0 || sumY2 < 1.0 { return 0.0 }
-
-        return abs(sumXY) / sqrt(sumX2 * sumY2)
-    }
-
-    /// 简化的噪声抑制
-    /// 注意：对于小声信号，减少抑制强度以保留语音
-    private func applyNoiseSuppression(_ samples: inout [Int16]) {
-        guard samples.count >= 3 else { return }
-
-        // 先计算信号强度
-        var sumSquares: Int64 = 0
-        for sample in samples {
-            sumSquares += Int64(sample) * Int64(sample)
-        }
-        let rms = sqrt(Float(sumSquares) / Float(samples.count))
-
-        // 如果信号较弱（可能是小声说话），减少噪声抑制强度
-        var effectiveLevel = nsSuppressionLevel
-        if rms < 500.0 && rms > 20.0 {
-            effectiveLevel = max(0, effectiveLevel - 1)
-        }
-
-        // 根据抑制级别决定滤波器大小（减小滤波器尺寸）
-        let filterSizes = [3, 3, 5, 7]
-        let filterSize = filterSizes[effectiveLevel]
-        let halfFilter = filterSize / 2
-
-        var filtered = [Int16](repeating: 0, count: samples.count)
-
-        for i in 0..<samples.count {
-            var sum: Int32 = 0
-            var count: Int32 = 0
-
-            for j in -halfFilter...halfFilter {
-                let idx = i + j
-                if idx >= 0 && idx < samples.count {
-                    sum += Int32(samples[idx])
-                    count += 1
-                }
-            }
-
-            filtered[i] = Int16(sum / count)
-        }
-
-        // 混合原始信号和滤波信号
-        // 提高原始信号比例，保留更多语音细节
-        let mixFactors: [Float] = [0.9, 0.8, 0.7, 0.6]
-        let mix = mixFactors[effectiveLevel]
-
-        for i in 0..<samples.count {
-            samples[i] = Int16(Float(samples[i]) * mix + Float(filtered[i]) * (1.0 - mix))
-        }
-    }
-
-    /// 简化的自动增益控制
-    private func applyGainControl(_ samples: inout [Int16]) {
-        guard !samples.isEmpty else { return }
-
-        // 计算当前音量
-        var sumSquares: Int64 = 0
-        for sample in samples {
-            sumSquares += Int64(sample) * Int64(sample)
-        }
-        let rms = sqrt(Float(sumSquares) / Float(samples.count))
-
-        // 目标 RMS
-        let targetRms = 32768.0 * pow(10.0, Float(-agcTargetLevel) / 20.0)
-
-        // 降低阈值到 20，允许处理更小的声音
-        if rms < 20.0 {
-            // 信号太弱（基本是静音），跳过
-            return
-        }
-
-        // 计算增益
-        var gain = targetRms / rms
-
-        // 扩大增益范围，允许更大的放大倍数（0.5x - 10x）
-        gain = min(max(gain, 0.5), 10.0)
-
-        // 应用增益
-        for i in 0..<samples.count {
-            let sample = Int32(Float(samples[i]) * gain)
-            samples[i] = Int16(min(max(sample, -32768), 32767))
-        }
-    }
 }
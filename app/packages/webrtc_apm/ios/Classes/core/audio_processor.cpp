@@ -0,0 +1,2 @@
+// 共享处理核心的转发编译单元：CocoaPods 不能引用 pod 目录之外的源文件
+#include "../../../src/audio_processor.cpp"
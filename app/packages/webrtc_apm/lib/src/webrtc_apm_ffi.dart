@@ -0,0 +1,253 @@
+import 'dart:ffi';
+import 'dart:io';
+import 'dart:typed_data';
+
+import 'package:ffi/ffi.dart';
+
+import 'webrtc_apm_platform_interface.dart';
+
+/// 原生处理器（C ABI 中的不透明类型）
+final class _WebrtcApm extends Opaque {}
+
+typedef _CreateNative = Pointer<_WebrtcApm> Function(Int32 sampleRate, Int32 channels);
+typedef _Create = Pointer<_WebrtcApm> Function(int sampleRate, int channels);
+typedef _DestroyNative = Void Function(Pointer<_WebrtcApm> apm);
+typedef _Destroy = void Function(Pointer<_WebrtcApm> apm);
+typedef _SetIntNative = Int32 Function(Pointer<_WebrtcApm> apm, Int32 value);
+typedef _SetInt = int Function(Pointer<_WebrtcApm> apm, int value);
+typedef _GetIntNative = Int32 Function(Pointer<_WebrtcApm> apm);
+typedef _GetInt = int Function(Pointer<_WebrtcApm> apm);
+typedef _ProcessCaptureNative = Int32 Function(
+    Pointer<_WebrtcApm> apm, Pointer<Int16> input, Int32 sampleCount, Pointer<Int16> output);
+typedef _ProcessCapture = int Function(
+    Pointer<_WebrtcApm> apm, Pointer<Int16> input, int sampleCount, Pointer<Int16> output);
+typedef _ProcessRenderNative = Int32 Function(
+    Pointer<_WebrtcApm> apm, Pointer<Int16> data, Int32 sampleCount);
+typedef _ProcessRender = int Function(Pointer<_WebrtcApm> apm, Pointer<Int16> data, int sampleCount);
+typedef _ProcessBatchNative = Int32 Function(Pointer<_WebrtcApm> apm, Pointer<Int16> capture,
+    Int32 sampleCount, Pointer<Int16> render, Int32 renderCount, Int32 frameSamples, Pointer<Int16> output);
+typedef _ProcessBatch = int Function(Pointer<_WebrtcApm> apm, Pointer<Int16> capture, int sampleCount,
+    Pointer<Int16> render, int renderCount, int frameSamples, Pointer<Int16> output);
+
+/// `webrtc_apm_c.h` 的符号绑定
+class _Bindings {
+  _Bindings(DynamicLibrary library)
+      : create = library.lookupFunction<_CreateNative, _Create>('webrtc_apm_create'),
+        destroy = library.lookupFunction<_DestroyNative, _Destroy>('webrtc_apm_destroy'),
+        setAecEnabled = library.lookupFunction<_SetIntNative, _SetInt>('webrtc_apm_set_aec_enabled'),
+        setAecSuppressionLevel =
+            library.lookupFunction<_SetIntNative, _SetInt>('webrtc_apm_set_aec_suppression_level'),
+        setNsEnabled = library.lookupFunction<_SetIntNative, _SetInt>('webrtc_apm_set_ns_enabled'),
+        setNsSuppressionLevel =
+            library.lookupFunction<_SetIntNative, _SetInt>('webrtc_apm_set_ns_suppression_level'),
+        setAgcEnabled = library.lookupFunction<_SetIntNative, _SetInt>('webrtc_apm_set_agc_enabled'),
+        setAgcMode = library.lookupFunction<_SetIntNative, _SetInt>('webrtc_apm_set_agc_mode'),
+        setAgcTargetLevel = library.lookupFunction<_SetIntNative, _SetInt>('webrtc_apm_set_agc_target_level'),
+        setVadEnabled = library.lookupFunction<_SetIntNative, _SetInt>('webrtc_apm_set_vad_enabled'),
+        setDownmixEnabled =
+            library.lookupFunction<_SetIntNative, _SetInt>('webrtc_apm_set_downmix_enabled'),
+        lastCaptureSpeech =
+            library.lookupFunction<_GetIntNative, _GetInt>('webrtc_apm_last_capture_speech'),
+        processCapture =
+            library.lookupFunction<_ProcessCaptureNative, _ProcessCapture>('webrtc_apm_process_capture'),
+        processRender =
+            library.lookupFunction<_ProcessRenderNative, _ProcessRender>('webrtc_apm_process_render'),
+        processBatch =
+            library.lookupFunction<_ProcessBatchNative, _ProcessBatch>('webrtc_apm_process_capture_batch');
+
+  final _Create create;
+  final _Destroy destroy;
+  final _SetInt setAecEnabled;
+  final _SetInt setAecSuppressionLevel;
+  final _SetInt setNsEnabled;
+  final _SetInt setNsSuppressionLevel;
+  final _SetInt setAgcEnabled;
+  final _SetInt setAgcMode;
+  final _SetInt setAgcTargetLevel;
+  final _SetInt setVadEnabled;
+  final _SetInt setDownmixEnabled;
+  final _GetInt lastCaptureSpeech;
+  final _ProcessCapture processCapture;
+  final _ProcessRender processRender;
+  final _ProcessBatch processBatch;
+
+  static _Bindings? _instance;
+
+  /// 按需加载原生库，当前平台不支持时返回 null
+  static _Bindings? load() {
+    if (_instance != null) return _instance;
+    if (!Platform.isAndroid) return null;
+    try {
+      _instance = _Bindings(DynamicLibrary.open('libwebrtc_apm_jni.so'));
+    } on ArgumentError {
+      return null;
+    }
+    return _instance;
+  }
+}
+
+/// 通过 dart:ffi 同步调用的音频处理器
+///
+/// 直接调用 C ABI，不经过 MethodChannel：没有平台线程切换，也没有编解码和复制。
+/// 采集缓冲区在创建时分配一次，原地处理：
+/// ```dart
+/// final apm = WebrtcApmFfi.create(maxFrameSamples: 1600)!;
+/// apm.captureBuffer.setRange(0, pcm.length, pcm);
+/// apm.processCapture(pcm.length);
+/// // apm.captureBuffer 中为处理后的数据
+/// apm.dispose();
+/// ```
+/// 与 [WebrtcApmPlatform] 创建的处理器相互独立，各自持有配置。
+/// 处理是同步的，应在录音回调所在的 isolate 上调用，避免阻塞 UI isolate 的长帧。
+/// 原生资源不随 GC 回收，用完必须调用 [dispose]。
+class WebrtcApmFfi {
+  WebrtcApmFfi._(this._bindings, this._apm, this._capture, this._render, this.maxFrameSamples)
+      : captureBuffer = _capture.asTypedList(maxFrameSamples),
+        renderBuffer = _render.asTypedList(maxFrameSamples);
+
+  final _Bindings _bindings;
+  final Pointer<_WebrtcApm> _apm;
+  final Pointer<Int16> _capture;
+  final Pointer<Int16> _render;
+  bool _disposed = false;
+
+  /// 单次处理的最大样本数
+  final int maxFrameSamples;
+
+  /// 采集缓冲区（原生内存），[processCapture] 在其上原地处理
+  final Int16List captureBuffer;
+
+  /// 参考信号缓冲区（原生内存），供 [processRender] 使用
+  final Int16List renderBuffer;
+
+  /// 当前平台是否可用（目前仅 Android）
+  static bool get isSupported => _Bindings.load() != null;
+
+  /// 创建处理器，当前平台不支持或初始化失败时返回 null
+  ///
+  /// [maxFrameSamples] 单次处理的最大样本数，默认 16kHz 单声道 100ms
+  static WebrtcApmFfi? create({
+    int sampleRate = 16000,
+    int channels = 1,
+    int maxFrameSamples = 1600,
+  }) {
+    final bindings = _Bindings.load();
+    if (bindings == null || maxFrameSamples <= 0) return null;
+
+    final apm = bindings.create(sampleRate, channels);
+    if (apm == nullptr) return null;
+
+    final capture = malloc<Int16>(maxFrameSamples);
+    final render = malloc<Int16>(maxFrameSamples);
+    return WebrtcApmFfi._(bindings, apm, capture, render, maxFrameSamples);
+  }
+
+  /// 原地处理 [captureBuffer] 的前 [sampleCount] 个样本
+  ///
+  /// 返回处理后的样本数，失败返回 -1
+  int processCapture(int sampleCount) {
+    _checkAlive();
+    RangeError.checkValueInInterval(sampleCount, 0, maxFrameSamples, 'sampleCount');
+    return _bindings.processCapture(_apm, _capture, sampleCount, _capture);
+  }
+
+  /// 处理一段 PCM16 字节数据，返回处理后的新数组
+  ///
+  /// 便于替换 [WebrtcApmPlatform.processCaptureFrame]；长度超过 [maxFrameSamples] 时分段处理
+  Uint8List processCaptureBytes(Uint8List audioData) {
+    _checkAlive();
+    // Int16List 视图要求 2 字节对齐，奇数偏移时先复制
+    final aligned = audioData.offsetInBytes.isEven ? audioData : Uint8List.fromList(audioData);
+    final samples = aligned.buffer.asInt16List(aligned.offsetInBytes, aligned.lengthInBytes ~/ 2);
+    final result = Uint8List(samples.length * 2);
+    final output = result.buffer.asInt16List();
+
+    for (var offset = 0; offset < samples.length; offset += maxFrameSamples) {
+      final end = offset + maxFrameSamples < samples.length ? offset + maxFrameSamples : samples.length;
+      captureBuffer.setRange(0, end - offset, samples, offset);
+      _bindings.processCapture(_apm, _capture, end - offset, _capture);
+      output.setRange(offset, end, captureBuffer);
+    }
+    return result;
+  }
+
+  /// 批量处理积压的采集音频，可附带同一时段的参考信号
+  ///
+  /// 整批复制到一次性分配的原生缓冲区，在一次调用内按 [frameSamples] 逐帧处理
+  Int16List processCaptureBatch(Int16List capture, {Int16List? render, int frameSamples = 160}) {
+    _checkAlive();
+    final output = Int16List(capture.length);
+    if (capture.isEmpty) return output;
+
+    final renderLength = render?.length ?? 0;
+    final native = malloc<Int16>(capture.length);
+    final nativeRender = renderLength > 0 ? malloc<Int16>(renderLength) : nullptr.cast<Int16>();
+    try {
+      native.asTypedList(capture.length).setAll(0, capture);
+      if (renderLength > 0) nativeRender.asTypedList(renderLength).setAll(0, render!);
+
+      final processed = _bindings.processBatch(
+          _apm, native, capture.length, nativeRender, renderLength, frameSamples, native);
+      if (processed < 0) throw ArgumentError.value(frameSamples, 'frameSamples');
+      output.setAll(0, native.asTypedList(processed));
+    } finally {
+      malloc.free(native);
+      if (renderLength > 0) malloc.free(nativeRender);
+    }
+    return output;
+  }
+
+  /// 输入 [renderBuffer] 的前 [sampleCount] 个样本作为 AEC 参考信号
+  bool processRender(int sampleCount) {
+    _checkAlive();
+    RangeError.checkValueInInterval(sampleCount, 0, maxFrameSamples, 'sampleCount');
+    return _bindings.processRender(_apm, _render, sampleCount) != 0;
+  }
+
+  bool setAecEnabled(bool enabled) => _set(_bindings.setAecEnabled, enabled ? 1 : 0);
+
+  bool setAecSuppressionLevel(AecSuppressionLevel level) =>
+      _set(_bindings.setAecSuppressionLevel, level.index);
+
+  bool setNsEnabled(bool enabled) => _set(_bindings.setNsEnabled, enabled ? 1 : 0);
+
+  bool setNsSuppressionLevel(NsSuppressionLevel level) =>
+      _set(_bindings.setNsSuppressionLevel, level.index);
+
+  bool setAgcEnabled(bool enabled) => _set(_bindings.setAgcEnabled, enabled ? 1 : 0);
+
+  bool setAgcMode(AgcMode mode) => _set(_bindings.setAgcMode, mode.index);
+
+  /// [targetLevelDbfs] 目标电平，范围 0-31
+  bool setAgcTargetLevel(int targetLevelDbfs) => _set(_bindings.setAgcTargetLevel, targetLevelDbfs);
+
+  /// 启用后非语音块跳过 AEC/NS/AGC，默认关闭
+  bool setVadEnabled(bool enabled) => _set(_bindings.setVadEnabled, enabled ? 1 : 0);
+
+  /// 多声道采集混为单声道后只处理一路，输出复制到各声道；单声道时无效
+  bool setDownmixEnabled(bool enabled) => _set(_bindings.setDownmixEnabled, enabled ? 1 : 0);
+
+  /// 上一次 [processCapture] 的输出中是否有语音（含拖尾），VAD 关闭时恒为 true
+  bool get lastCaptureSpeech {
+    _checkAlive();
+    return _bindings.lastCaptureSpeech(_apm) != 0;
+  }
+
+  /// 释放原生处理器与缓冲区，之后不可再调用
+  void dispose() {
+    if (_disposed) return;
+    _disposed = true;
+    _bindings.destroy(_apm);
+    malloc.free(_capture);
+    malloc.free(_render);
+  }
+
+  bool _set(_SetInt function, int value) {
+    _checkAlive();
+    return function(_apm, value) != 0;
+  }
+
+  void _checkAlive() {
+    if (_disposed) throw StateError('WebrtcApmFfi 已释放');
+  }
+}
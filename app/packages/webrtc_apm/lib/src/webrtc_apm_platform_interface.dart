@@ -24,9 +24,156 @@ enum AgcMode {
   fixedDigital,     // 2 - 固定数字增益
 }
 
+/// 单个处理阶段每个 10ms 块的耗时分布（微秒）
+class ApmStageLatency {
+  const ApmStageLatency({
+    this.blocks = 0,
+    this.p50Us = 0,
+    this.p99Us = 0,
+    this.maxUs = 0,
+  });
+
+  factory ApmStageLatency.fromMap(Map<dynamic, dynamic>? map) {
+    if (map == null) return const ApmStageLatency();
+    return ApmStageLatency(
+      blocks: map['blocks'] as int? ?? 0,
+      p50Us: map['p50Us'] as int? ?? 0,
+      p99Us: map['p99Us'] as int? ?? 0,
+      maxUs: map['maxUs'] as int? ?? 0,
+    );
+  }
+
+  /// 该阶段处理过的块数（阶段关闭时为 0）
+  final int blocks;
+  final int p50Us;
+  final int p99Us;
+  final int maxUs;
+
+  Map<String, dynamic> toMap() => {
+        'blocks': blocks,
+        'p50Us': p50Us,
+        'p99Us': p99Us,
+        'maxUs': maxUs,
+      };
+
+  @override
+  String toString() => 'p50=${p50Us}us p99=${p99Us}us max=${maxUs}us ($blocks blocks)';
+}
+
+/// 带语音判决的采集处理结果
+class ApmCaptureResult {
+  const ApmCaptureResult({required this.audioData, required this.isSpeech});
+
+  /// 处理后的 PCM16 数据
+  final Uint8List audioData;
+
+  /// 本帧输出中是否有语音（含拖尾），VAD 关闭时恒为 true
+  final bool isSpeech;
+}
+
+/// 原生处理统计，统计区间为初始化或上次 [WebrtcApmPlatform.resetStats] 之后
+class ApmStats {
+  const ApmStats({
+    required this.captureBlocks,
+    required this.renderFrames,
+    required this.renderOverruns,
+    required this.inputClippedSamples,
+    required this.outputClippedSamples,
+    required this.processingTimeUs,
+    required this.aecDelayMs,
+    required this.renderBufferedMs,
+    this.speechBlocks = 0,
+    required this.aec,
+    required this.ns,
+    required this.agc,
+    this.vad = const ApmStageLatency(),
+    required this.total,
+  });
+
+  factory ApmStats.fromMap(Map<dynamic, dynamic> map) {
+    return ApmStats(
+      captureBlocks: map['captureBlocks'] as int? ?? 0,
+      renderFrames: map['renderFrames'] as int? ?? 0,
+      renderOverruns: map['renderOverruns'] as int? ?? 0,
+      inputClippedSamples: map['inputClippedSamples'] as int? ?? 0,
+      outputClippedSamples: map['outputClippedSamples'] as int? ?? 0,
+      processingTimeUs: map['processingTimeUs'] as int? ?? 0,
+      aecDelayMs: map['aecDelayMs'] as int? ?? -1,
+      renderBufferedMs: map['renderBufferedMs'] as int? ?? 0,
+      speechBlocks: map['speechBlocks'] as int? ?? map['captureBlocks'] as int? ?? 0,
+      aec: ApmStageLatency.fromMap(map['aec'] as Map?),
+      ns: ApmStageLatency.fromMap(map['ns'] as Map?),
+      agc: ApmStageLatency.fromMap(map['agc'] as Map?),
+      vad: ApmStageLatency.fromMap(map['vad'] as Map?),
+      total: ApmStageLatency.fromMap(map['total'] as Map?),
+    );
+  }
+
+  /// 已处理的 10ms 采集块数
+  final int captureBlocks;
+
+  /// 送入的参考信号帧数
+  final int renderFrames;
+
+  /// 参考信号缓冲区满而丢弃的帧数
+  final int renderOverruns;
+
+  /// 输入中满幅（削波）的样本数
+  final int inputClippedSamples;
+
+  /// 输出中满幅的样本数，持续增长通常说明 AGC 目标电平过高
+  final int outputClippedSamples;
+
+  /// 累计处理耗时（微秒）
+  final int processingTimeUs;
+
+  /// AEC 估计的渲染到采集延迟，AEC 未运行时为 -1
+  final int aecDelayMs;
+
+  /// 参考信号缓冲区中尚未消费的时长
+  final int renderBufferedMs;
+
+  /// 按语音完整处理的块数，VAD 关闭时等于 [captureBlocks]
+  final int speechBlocks;
+
+  final ApmStageLatency aec;
+  final ApmStageLatency ns;
+  final ApmStageLatency agc;
+
+  /// 语音检测本身的耗时（VAD 关闭时为空）
+  final ApmStageLatency vad;
+
+  /// 整个处理链
+  final ApmStageLatency total;
+
+  /// 实时负载：处理耗时占音频时长的比例，接近 1 说明设备跟不上实时处理
+  double get realtimeLoad => captureBlocks == 0 ? 0 : processingTimeUs / (captureBlocks * 10000);
+
+  /// 语音块占比，其余块跳过了 AEC/NS/AGC
+  double get speechRatio => captureBlocks == 0 ? 1 : speechBlocks / captureBlocks;
+
+  Map<String, dynamic> toMap() => {
+        'captureBlocks': captureBlocks,
+        'renderFrames': renderFrames,
+        'renderOverruns': renderOverruns,
+        'inputClippedSamples': inputClippedSamples,
+        'outputClippedSamples': outputClippedSamples,
+        'processingTimeUs': processingTimeUs,
+        'aecDelayMs': aecDelayMs,
+        'renderBufferedMs': renderBufferedMs,
+        'speechBlocks': speechBlocks,
+        'aec': aec.toMap(),
+        'ns': ns.toMap(),
+        'agc': agc.toMap(),
+        'vad': vad.toMap(),
+        'total': total.toMap(),
+      };
+}
+
 /// WebRTC APM 平台接口
 class WebrtcApmPlatform {
   static const MethodChannel _channel = MethodChannel('webrtc_apm');
+  static const EventChannel _captureChannel = EventChannel('webrtc_apm/capture');
 
   /// 初始化 APM
   ///
@@ -106,6 +253,27 @@ class WebrtcApmPlatform {
     return result ?? false;
   }
 
+  /// 启用/禁用 VAD（语音活动检测）
+  ///
+  /// 启用后非语音块跳过 AEC/NS/AGC，只按 NS 的增益下限衰减，默认关闭
+  static Future<bool> setVadEnabled(bool enabled) async {
+    final result = await _channel.invokeMethod<bool>('setVadEnabled', {
+      'enabled': enabled,
+    });
+    return result ?? false;
+  }
+
+  /// 启用/禁用多声道混音
+  ///
+  /// 启用后多声道采集混为单声道，只运行一路 AEC/NS/AGC，输出复制到各声道；
+  /// 单声道时无效，默认关闭
+  static Future<bool> setDownmixEnabled(bool enabled) async {
+    final result = await _channel.invokeMethod<bool>('setDownmixEnabled', {
+      'enabled': enabled,
+    });
+    return result ?? false;
+  }
+
   /// 处理捕获的音频帧（麦克风输入）
   ///
   /// [audioData] PCM16 格式的音频数据
@@ -117,6 +285,18 @@ class WebrtcApmPlatform {
     return result;
   }
 
+  /// 处理捕获的音频帧，同时返回 VAD 判决（一次平台通道往返）
+  static Future<ApmCaptureResult?> processCaptureFrameWithVad(Uint8List audioData) async {
+    final result = await _channel.invokeMethod<Map>('processCaptureFrameWithVad', {
+      'audioData': audioData,
+    });
+    if (result == null) return null;
+    return ApmCaptureResult(
+      audioData: result['audioData'] as Uint8List? ?? audioData,
+      isSpeech: result['isSpeech'] as bool? ?? true,
+    );
+  }
+
   /// 处理渲染的音频帧（扬声器输出/TTS参考信号）
   ///
   /// [audioData] PCM16 格式的音频数据
@@ -128,6 +308,49 @@ class WebrtcApmPlatform {
     return result ?? false;
   }
 
+  /// 批量处理积压的采集音频（如 ASR 重连后补发）
+  ///
+  /// [audioData] PCM16 采集数据，原生层按 [frameSamples] 逐帧处理，整批只经过一次平台通道
+  /// [renderData] 与采集逐样本对应的参考信号（可选）
+  /// 返回处理后的音频数据
+  static Future<Uint8List?> processCaptureBatch(
+    Uint8List audioData, {
+    Uint8List? renderData,
+    int frameSamples = 160,
+  }) async {
+    final result = await _channel.invokeMethod<Uint8List>('processCaptureBatch', {
+      'audioData': audioData,
+      'renderData': renderData,
+      'frameSamples': frameSamples,
+    });
+    return result;
+  }
+
+  /// 当前设备是否支持原生采集（Android 8.0+ 的 AAudio，需先 [initialize]）
+  static Future<bool> isNativeCaptureSupported() async {
+    final result = await _channel.invokeMethod<bool>('isNativeCaptureSupported');
+    return result ?? false;
+  }
+
+  /// 原生采集流：订阅时由原生层打开麦克风并在音频线程上完成 AEC/NS/AGC
+  ///
+  /// 每个事件是一帧 10ms 的处理后 PCM16 数据，取消订阅即停止采集。
+  /// 不支持、未初始化或音频流出错时以 [PlatformException] 结束
+  static Stream<Uint8List> nativeCaptureStream() {
+    return _captureChannel.receiveBroadcastStream().map((event) => event as Uint8List);
+  }
+
+  /// 获取原生处理统计（各阶段耗时分位数、削波计数、AEC 延迟等），未初始化时返回 null
+  static Future<ApmStats?> getStats() async {
+    final result = await _channel.invokeMethod<Map>('getStats');
+    return result == null ? null : ApmStats.fromMap(result);
+  }
+
+  /// 清空原生处理统计
+  static Future<void> resetStats() async {
+    await _channel.invokeMethod<void>('resetStats');
+  }
+
   /// 获取当前配置状态
   static Future<Map<String, dynamic>> getStatus() async {
     final result = await _channel.invokeMethod<Map>('getStatus');
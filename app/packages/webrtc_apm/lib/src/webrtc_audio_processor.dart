@@ -35,17 +35,21 @@ class WebrtcAudioProcessor {
 
   /// 初始化处理器
   ///
-  /// [sampleRate] 采样率，默认 16000（与 ASR 一致）
+  /// [sampleRate] 采样率，默认 16000（与 ASR 一致）；44.1/48kHz 在原生层降到 16kHz 处理
   /// [channels] 声道数，默认 1（单声道）
   /// [enableAec] 是否启用 AEC，默认 true
   /// [enableNs] 是否启用 NS，默认 true
   /// [enableAgc] 是否启用 AGC，默认 true
+  /// [enableVad] 是否启用 VAD，默认 false（见 [setVadEnabled]）
+  /// [downmix] 多声道时是否混为单声道处理，默认 true（见 [setDownmixEnabled]）
   Future<bool> initialize({
     int sampleRate = 16000,
     int channels = 1,
     bool enableAec = true,
     bool enableNs = true,
     bool enableAgc = true,
+    bool enableVad = false,
+    bool downmix = true,
   }) async {
     if (_isInitialized) {
       debugPrint('[WebrtcAudioProcessor] 已初始化，跳过');
@@ -92,6 +96,17 @@ class WebrtcAudioProcessor {
         debugPrint('[WebrtcAudioProcessor] AGC 已启用 (adaptiveDigital, -12dBFS)');
       }
 
+      // 多声道麦克风只需要一路语音送 ASR，混音后处理耗时与单声道相同
+      if (channels > 1 && downmix) {
+        await WebrtcApmPlatform.setDownmixEnabled(true);
+        debugPrint('[WebrtcAudioProcessor] 多声道混音已启用 ($channels 声道)');
+      }
+
+      if (enableVad) {
+        await WebrtcApmPlatform.setVadEnabled(true);
+        debugPrint('[WebrtcAudioProcessor] VAD 已启用');
+      }
+
       _isInitialized = true;
       debugPrint('[WebrtcAudioProcessor] 初始化完成');
       return true;
@@ -125,7 +140,7 @@ class WebrtcAudioProcessor {
 
   /// 处理麦克风捕获的音频
   ///
-  /// [audioData] PCM16 格式的音频数据
+  /// [audioData] PCM16 格式的音频数据，长度任意（原生层按 10ms 分帧，输出固定延迟约 10ms）
   /// 返回处理后的干净音频，或 null 如果处理失败
   Future<Uint8List?> processAudio(Uint8List audioData) async {
     if (!_isInitialized) {
@@ -142,6 +157,80 @@ class WebrtcAudioProcessor {
     }
   }
 
+  /// 处理麦克风音频并返回 VAD 判决
+  ///
+  /// 与 [processAudio] 相同，另附本帧是否有语音（含约 300ms 拖尾）；
+  /// 未启用 VAD、未初始化或处理失败时 isSpeech 为 true。
+  /// 判决有一帧左右的起音延迟，按判决丢弃静音帧的调用方应在 Dart 侧保留一小段预录
+  Future<ApmCaptureResult> processAudioWithVad(Uint8List audioData) async {
+    if (!_isInitialized) {
+      return ApmCaptureResult(audioData: audioData, isSpeech: true);
+    }
+
+    try {
+      final result = await WebrtcApmPlatform.processCaptureFrameWithVad(audioData);
+      return result ?? ApmCaptureResult(audioData: audioData, isSpeech: true);
+    } catch (e) {
+      debugPrint('[WebrtcAudioProcessor] 处理音频异常: $e');
+      return ApmCaptureResult(audioData: audioData, isSpeech: true);
+    }
+  }
+
+  /// 批量处理积压的麦克风音频（如 ASR 重连后补发缓存的数秒录音）
+  ///
+  /// [audioData] PCM16 格式的音频数据，可包含任意多帧
+  /// [renderData] 同一时段的 TTS 参考信号（可选），与采集逐样本对应
+  /// [frameSamples] 每帧样本数，默认 16kHz 单声道 10ms
+  /// 原生层在一次调用内逐帧处理，远快于逐帧调用 [processAudio]；失败时返回原始数据。
+  /// 在独立的处理状态上运行（复制当前配置，每批从初始状态开始），可与 [processAudio] 并行；
+  /// 输出与输入逐帧对齐。[frameSamples] 须为声道数的整数倍
+  Future<Uint8List> processAudioBatch(
+    Uint8List audioData, {
+    Uint8List? renderData,
+    int frameSamples = 160,
+  }) async {
+    if (!_isInitialized) {
+      debugPrint('[WebrtcAudioProcessor] 未初始化，返回原始数据');
+      return audioData;
+    }
+
+    try {
+      final result = await WebrtcApmPlatform.processCaptureBatch(
+        audioData,
+        renderData: renderData,
+        frameSamples: frameSamples,
+      );
+      return result ?? audioData;
+    } catch (e) {
+      debugPrint('[WebrtcAudioProcessor] 批量处理音频异常: $e');
+      return audioData;
+    }
+  }
+
+  /// 当前设备是否支持原生采集模式
+  Future<bool> isNativeCaptureSupported() async {
+    if (!_isInitialized) return false;
+    try {
+      return await WebrtcApmPlatform.isNativeCaptureSupported();
+    } catch (e) {
+      debugPrint('[WebrtcAudioProcessor] 查询原生采集支持异常: $e');
+      return false;
+    }
+  }
+
+  /// 原生采集模式
+  ///
+  /// 由原生层持有麦克风并在实时音频线程上直接处理，只把处理后的 10ms 帧推给 Dart，
+  /// 省去每帧经 MethodChannel 往返 [processAudio] 的线程切换与复制。
+  /// 订阅即开始录音、取消订阅即停止；使用前需已获得录音权限，
+  /// 不支持时（见 [isNativeCaptureSupported]）应回退到自行录音 + [processAudio]
+  Stream<Uint8List> nativeCaptureStream() {
+    if (!_isInitialized) {
+      return Stream<Uint8List>.error(StateError('WebrtcAudioProcessor 未初始化'));
+    }
+    return WebrtcApmPlatform.nativeCaptureStream();
+  }
+
   /// 输入 TTS/扬声器播放的音频（AEC 参考信号）
   ///
   /// [audioData] PCM16 格式的音频数据
@@ -174,6 +263,35 @@ class WebrtcAudioProcessor {
     await WebrtcApmPlatform.setAgcEnabled(enabled);
   }
 
+  /// 启用/禁用多声道混音，关闭时逐声道独立处理（耗时随声道数增加）
+  Future<void> setDownmixEnabled(bool enabled) async {
+    if (!_isInitialized) return;
+    await WebrtcApmPlatform.setDownmixEnabled(enabled);
+  }
+
+  /// 启用/禁用 VAD
+  ///
+  /// 启用后静音块跳过 AEC/NS/AGC，在长时间静音的录音中显著降低耗时
+  Future<void> setVadEnabled(bool enabled) async {
+    if (!_isInitialized) return;
+    await WebrtcApmPlatform.setVadEnabled(enabled);
+  }
+
+  /// 获取处理统计，用于采集各设备上的 p50/p99 处理耗时
+  ///
+  /// 可在处理进行时调用；配合 [resetStats] 按固定周期采样，
+  /// 如 `total.p99Us` 持续接近 10000 时可降低 NS 抑制级别或关闭部分模块
+  Future<ApmStats?> getStats() async {
+    if (!_isInitialized) return null;
+    return WebrtcApmPlatform.getStats();
+  }
+
+  /// 清空处理统计
+  Future<void> resetStats() async {
+    if (!_isInitialized) return;
+    await WebrtcApmPlatform.resetStats();
+  }
+
   /// 获取状态信息（用于调试）
   Future<Map<String, dynamic>> getStatus() async {
     if (!_isInitialized) {
@@ -6,5 +6,6 @@
 /// - AGC (Automatic Gain Control) - 自动增益控制
 library webrtc_apm;
 
+export 'src/webrtc_apm_ffi.dart';
 export 'src/webrtc_apm_platform_interface.dart';
 export 'src/webrtc_audio_processor.dart';
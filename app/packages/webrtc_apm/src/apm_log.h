@@ -0,0 +1,110 @@
+#ifndef APM_LOG_H
+#define APM_LOG_H
+
+/**
+ * webrtc_apm 的日志设施
+ *
+ * 使用前先定义 LOG_TAG：
+ *   #define LOG_TAG "WebRTC_APM"
+ *   #include "apm_log.h"
+ *
+ * - LOGD 只在调试构建中输出；release 构建（定义了 NDEBUG）中整条语句被编译掉，
+ *   参数仍做类型检查但不求值。可用 -DWEBRTC_APM_DEBUG_LOG=0/1 强制关闭或打开
+ * - LOGE 始终输出，只用于配置与初始化等非逐帧路径
+ * - LOGE_LIMITED 用于可能逐帧重复的错误，每个调用点只输出前几次
+ * - 音频热路径上不直接打日志，用 LogCounter 聚合计数，每个统计周期最多输出一行
+ *
+ * Android 上写入 logcat，主机构建（基准测试）写到 stderr
+ */
+
+#include <atomic>
+
+#ifdef __ANDROID__
+#include <android/log.h>
+#define APM_LOG_PRINT(priority, ...) __android_log_print(ANDROID_LOG_##priority, LOG_TAG, __VA_ARGS__)
+#else
+#include <cstdarg>
+#include <cstdio>
+
+namespace webrtc_apm {
+__attribute__((format(printf, 3, 4)))
+inline void HostLogPrint(char priority, const char* tag, const char* format, ...) {
+    std::fprintf(stderr, "%c/%s: ", priority, tag);
+    va_list args;
+    va_start(args, format);
+    std::vfprintf(stderr, format, args);
+    va_end(args);
+    std::fputc('\n', stderr);
+}
+} // namespace webrtc_apm
+
+#define APM_LOG_PRINT(priority, ...) webrtc_apm::HostLogPrint(#priority[0], LOG_TAG, __VA_ARGS__)
+#endif
+
+#ifndef LOG_TAG
+#error "Define LOG_TAG before including apm_log.h"
+#endif
+
+#ifndef WEBRTC_APM_DEBUG_LOG
+#ifdef NDEBUG
+#define WEBRTC_APM_DEBUG_LOG 0
+#else
+#define WEBRTC_APM_DEBUG_LOG 1
+#endif
+#endif
+
+#if WEBRTC_APM_DEBUG_LOG
+#define LOGD(...) APM_LOG_PRINT(DEBUG, __VA_ARGS__)
+#else
+#define LOGD(...) do { if (false) APM_LOG_PRINT(DEBUG, __VA_ARGS__); } while (0)
+#endif
+
+#define LOGE(...) APM_LOG_PRINT(ERROR, __VA_ARGS__)
+
+#define LOGE_LIMITED(...)                                                          \
+    do {                                                                           \
+        static std::atomic<int> apmLogCount{0};                                    \
+        if (apmLogCount.fetch_add(1, std::memory_order_relaxed) <                  \
+            webrtc_apm::kMaxRepeatedErrorLogs) {                                   \
+            LOGE(__VA_ARGS__);                                                     \
+        }                                                                          \
+    } while (0)
+
+namespace webrtc_apm {
+
+constexpr int kMaxRepeatedErrorLogs = 8;
+
+/**
+ * 热路径聚合计数器（单线程使用）
+ *
+ * 每帧调用 Add 记录一次事件是否发生，满 period 次后返回 true 并给出本周期的计数，
+ * 调用方据此输出一行如 "AEC engaged 87/100 blocks" 的统计。
+ * 调试日志关闭时 Add 恒返回 false，计数与日志一起被编译器消除
+ */
+class LogCounter {
+public:
+    explicit LogCounter(int period) : period_(period) {}
+
+#if WEBRTC_APM_DEBUG_LOG
+    bool Add(bool hit, int* hits, int* total) {
+        hits_ += hit ? 1 : 0;
+        if (++total_ < period_) return false;
+        *hits = hits_;
+        *total = total_;
+        hits_ = 0;
+        total_ = 0;
+        return true;
+    }
+#else
+    bool Add(bool /* hit */, int* /* hits */, int* /* total */) { return false; }
+#endif
+
+private:
+    [[maybe_unused]] int period_;
+    [[maybe_unused]] int hits_ = 0;
+    [[maybe_unused]] int total_ = 0;
+};
+
+} // namespace webrtc_apm
+
+#endif // APM_LOG_H
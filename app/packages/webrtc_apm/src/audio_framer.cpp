@@ -0,0 +1,82 @@
+#include "audio_framer.h"
+#include <algorithm>
+#include <cstring>
+
+namespace webrtc_apm {
+
+namespace {
+    // 把 [read, size) 移到缓冲区开头，并保证还能再写入 extra 个样本
+    void Compact(std::vector<int16_t>& buffer, int& read, int& size, int extra) {
+        if (read > 0) {
+            std::memmove(buffer.data(), buffer.data() + read, (size - read) * sizeof(int16_t));
+            size -= read;
+            read = 0;
+        }
+        if (static_cast<int>(buffer.size()) < size + extra) {
+            buffer.resize(size + extra);
+        }
+    }
+}
+
+bool AudioFramer::Initialize(int sampleRate, int processingRate, int channels) {
+    if (sampleRate <= 0 || processingRate <= 0 || channels <= 0) return false;
+    if (!downsampler_.Initialize(sampleRate, processingRate, channels)) return false;
+    if (!upsampler_.Initialize(processingRate, sampleRate, channels)) return false;
+
+    channels_ = channels;
+    blockFrames_ = processingRate * kBlockMs / 1000;
+    if (blockFrames_ <= 0) return false;
+
+    // 一块折算到输入采样率（向上取整）：输入侧最多滞留不足一块的样本
+    latencyFrames_ = static_cast<int>(
+        (static_cast<int64_t>(blockFrames_) * sampleRate + processingRate - 1) / processingRate);
+
+    pending_.assign(2 * BlockSamples(), 0);
+    output_.assign(2 * latencyFrames_ * channels_, 0);
+    Reset();
+    return true;
+}
+
+void AudioFramer::Reset() {
+    downsampler_.Reset();
+    upsampler_.Reset();
+    pendingRead_ = 0;
+    pendingSize_ = 0;
+
+    // 预填静音作为固定延迟
+    outputRead_ = 0;
+    outputSize_ = latencyFrames_ * channels_;
+    std::fill(output_.begin(), output_.begin() + outputSize_, 0);
+}
+
+void AudioFramer::Write(const int16_t* data, int frames) {
+    if (frames <= 0) return;
+    Compact(pending_, pendingRead_, pendingSize_, downsampler_.MaxOutputFrames(frames) * channels_);
+    int produced = downsampler_.Process(data, frames, pending_.data() + pendingSize_);
+    pendingSize_ += produced * channels_;
+}
+
+const int16_t* AudioFramer::ReadBlock() {
+    if (pendingSize_ - pendingRead_ < BlockSamples()) return nullptr;
+    const int16_t* block = pending_.data() + pendingRead_;
+    pendingRead_ += BlockSamples();
+    return block;
+}
+
+void AudioFramer::WriteBlock(const int16_t* block) {
+    Compact(output_, outputRead_, outputSize_, upsampler_.MaxOutputFrames(blockFrames_) * channels_);
+    int produced = upsampler_.Process(block, blockFrames_, output_.data() + outputSize_);
+    outputSize_ += produced * channels_;
+}
+
+void AudioFramer::Read(int16_t* data, int frames) {
+    int wanted = frames * channels_;
+    int n = std::min(wanted, outputSize_ - outputRead_);
+    std::memcpy(data, output_.data() + outputRead_, n * sizeof(int16_t));
+    outputRead_ += n;
+    if (n < wanted) {
+        std::fill(data + n, data + wanted, 0);
+    }
+}
+
+} // namespace webrtc_apm
@@ -0,0 +1,83 @@
+#ifndef AUDIO_FRAMER_H
+#define AUDIO_FRAMER_H
+
+#include "resampler.h"
+#include <cstdint>
+#include <vector>
+
+namespace webrtc_apm {
+
+/**
+ * 采集分帧器：把任意长度的交织输入整理成处理采样率下固定 10ms 的块
+ *
+ * 输入先重采样到处理采样率并缓存，凑满一块即交给调用方处理；
+ * 处理后的块再重采样回输入采样率，放入输出队列按输入的长度取出。
+ * 输出队列预先填入一块（按输入采样率折算）的静音，
+ * 保证任何输入长度下每次都能取满，代价是固定约 10ms 的额外延迟（另加重采样滤波器的群延迟）。
+ *
+ * 缓冲区随输入长度按需扩容，稳定后不再分配。
+ */
+class AudioFramer {
+public:
+    static constexpr int kBlockMs = 10;
+
+    /**
+     * @param sampleRate 调用方（输入/输出）的采样率
+     * @param processingRate 处理模块运行的采样率
+     */
+    bool Initialize(int sampleRate, int processingRate, int channels);
+    void Reset();
+
+    /**
+     * 一个处理块的交织样本数
+     */
+    int BlockSamples() const { return blockFrames_ * channels_; }
+
+    /**
+     * 输入到输出的固定延迟（输入采样率下的帧数，不含重采样群延迟）
+     */
+    int LatencyFrames() const { return latencyFrames_; }
+
+    /**
+     * 写入 frames 帧交织输入
+     */
+    void Write(const int16_t* data, int frames);
+
+    /**
+     * 取出一个待处理块，不足一块时返回 nullptr
+     *
+     * 返回的指针在下一次 Write 之前有效
+     */
+    const int16_t* ReadBlock();
+
+    /**
+     * 写回一个处理完的块（BlockSamples() 个样本）
+     */
+    void WriteBlock(const int16_t* block);
+
+    /**
+     * 取出 frames 帧输出，队列不足时以静音补齐
+     */
+    void Read(int16_t* data, int frames);
+
+private:
+    Resampler downsampler_;
+    Resampler upsampler_;
+    int channels_ = 1;
+    int blockFrames_ = 0;
+    int latencyFrames_ = 0;
+
+    // 处理采样率下待处理的样本：[pendingRead_, pendingSize_)
+    std::vector<int16_t> pending_;
+    int pendingRead_ = 0;
+    int pendingSize_ = 0;
+
+    // 输入采样率下待输出的样本：[outputRead_, outputSize_)
+    std::vector<int16_t> output_;
+    int outputRead_ = 0;
+    int outputSize_ = 0;
+};
+
+} // namespace webrtc_apm
+
+#endif // AUDIO_FRAMER_H
@@ -0,0 +1,365 @@
+#include "audio_kernels.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define APM_KERNELS_NEON 1
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define APM_KERNELS_SSE2 1
+#endif
+
+namespace webrtc_apm {
+namespace dsp {
+
+namespace {
+    // 增益上限 2^kMaxShift
+    constexpr int kMaxShift = 7;
+
+    // 斜坡增益每段的样本数
+    constexpr int kRampSegment = 8;
+
+    inline int16_t Saturate(int32_t v) {
+        return static_cast<int16_t>(std::clamp(v, -32768, 32767));
+    }
+
+    inline int16_t SaturateFloat(float v) {
+        return static_cast<int16_t>(std::clamp(v, -32768.0f, 32767.0f));
+    }
+
+#ifdef APM_KERNELS_SSE2
+    // 将 4 个 int32 符号扩展为两组 int64 并累加
+    inline __m128i AddSigned32To64(__m128i acc, __m128i v) {
+        __m128i sign = _mm_srai_epi32(v, 31);
+        acc = _mm_add_epi64(acc, _mm_unpacklo_epi32(v, sign));
+        return _mm_add_epi64(acc, _mm_unpackhi_epi32(v, sign));
+    }
+
+    inline int64_t HorizontalSum64(__m128i v) {
+        alignas(16) int64_t lanes[2];
+        _mm_store_si128(reinterpret_cast<__m128i*>(lanes), v);
+        return lanes[0] + lanes[1];
+    }
+#endif
+}
+
+int64_t Dot(const int16_t* a, const int16_t* b, int count) {
+    int64_t sum = 0;
+    int i = 0;
+#if defined(APM_KERNELS_NEON)
+    int64x2_t acc = vdupq_n_s64(0);
+    for (; i + 8 <= count; i += 8) {
+        int16x8_t va = vld1q_s16(a + i);
+        int16x8_t vb = vld1q_s16(b + i);
+        acc = vpadalq_s32(acc, vmull_s16(vget_low_s16(va), vget_low_s16(vb)));
+        acc = vpadalq_s32(acc, vmull_s16(vget_high_s16(va), vget_high_s16(vb)));
+    }
+    sum = vgetq_lane_s64(acc, 0) + vgetq_lane_s64(acc, 1);
+#elif defined(APM_KERNELS_SSE2)
+    // 每对乘积和至多 2^31，仅当两对均为 -32768 时溢出，PCM 中可忽略
+    __m128i acc = _mm_setzero_si128();
+    for (; i + 8 <= count; i += 8) {
+        __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+        __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+        acc = AddSigned32To64(acc, _mm_madd_epi16(va, vb));
+    }
+    sum = HorizontalSum64(acc);
+#endif
+    for (; i < count; ++i) {
+        sum += static_cast<int32_t>(a[i]) * b[i];
+    }
+    return sum;
+}
+
+int64_t SumSquares(const int16_t* x, int count) {
+    int64_t sum = 0;
+    int i = 0;
+#if defined(APM_KERNELS_NEON)
+    int64x2_t acc = vdupq_n_s64(0);
+    for (; i + 8 <= count; i += 8) {
+        int16x8_t v = vld1q_s16(x + i);
+        acc = vpadalq_s32(acc, vmull_s16(vget_low_s16(v), vget_low_s16(v)));
+        acc = vpadalq_s32(acc, vmull_s16(vget_high_s16(v), vget_high_s16(v)));
+    }
+    sum = vgetq_lane_s64(acc, 0) + vgetq_lane_s64(acc, 1);
+#elif defined(APM_KERNELS_SSE2)
+    // 平方和非负，按无符号扩展（最大 2^31 不会溢出 uint32）
+    __m128i acc = _mm_setzero_si128();
+    __m128i zero = _mm_setzero_si128();
+    for (; i + 8 <= count; i += 8) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(x + i));
+        __m128i s = _mm_madd_epi16(v, v);
+        acc = _mm_add_epi64(acc, _mm_unpacklo_epi32(s, zero));
+        acc = _mm_add_epi64(acc, _mm_unpackhi_epi32(s, zero));
+    }
+    sum = HorizontalSum64(acc);
+#endif
+    for (; i < count; ++i) {
+        sum += static_cast<int32_t>(x[i]) * x[i];
+    }
+    return sum;
+}
+
+FrameStats ComputeStats(const int16_t* x, int count) {
+    FrameStats stats;
+    int i = 0;
+    int maxValue = 0, minValue = 0;
+#if defined(APM_KERNELS_NEON)
+    int64x2_t acc = vdupq_n_s64(0);
+    int16x8_t vmax = vdupq_n_s16(0);
+    int16x8_t vmin = vdupq_n_s16(0);
+    for (; i + 8 <= count; i += 8) {
+        int16x8_t v = vld1q_s16(x + i);
+        acc = vpadalq_s32(acc, vmull_s16(vget_low_s16(v), vget_low_s16(v)));
+        acc = vpadalq_s32(acc, vmull_s16(vget_high_s16(v), vget_high_s16(v)));
+        vmax = vmaxq_s16(vmax, v);
+        vmin = vminq_s16(vmin, v);
+    }
+    stats.energy = vgetq_lane_s64(acc, 0) + vgetq_lane_s64(acc, 1);
+    int16_t lanes[8];
+    vst1q_s16(lanes, vmax);
+    for (int16_t lane : lanes) maxValue = std::max(maxValue, static_cast<int>(lane));
+    vst1q_s16(lanes, vmin);
+    for (int16_t lane : lanes) minValue = std::min(minValue, static_cast<int>(lane));
+#elif defined(APM_KERNELS_SSE2)
+    __m128i acc = _mm_setzero_si128();
+    __m128i zero = _mm_setzero_si128();
+    __m128i vmax = _mm_setzero_si128();
+    __m128i vmin = _mm_setzero_si128();
+    for (; i + 8 <= count; i += 8) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(x + i));
+        __m128i s = _mm_madd_epi16(v, v);
+        acc = _mm_add_epi64(acc, _mm_unpacklo_epi32(s, zero));
+        acc = _mm_add_epi64(acc, _mm_unpackhi_epi32(s, zero));
+        vmax = _mm_max_epi16(vmax, v);
+        vmin = _mm_min_epi16(vmin, v);
+    }
+    stats.energy = HorizontalSum64(acc);
+    alignas(16) int16_t lanes[8];
+    _mm_store_si128(reinterpret_cast<__m128i*>(lanes), vmax);
+    for (int16_t lane : lanes) maxValue = std::max(maxValue, static_cast<int>(lane));
+    _mm_store_si128(reinterpret_cast<__m128i*>(lanes), vmin);
+    for (int16_t lane : lanes) minValue = std::min(minValue, static_cast<int>(lane));
+#endif
+    for (; i < count; ++i) {
+        stats.energy += static_cast<int32_t>(x[i]) * x[i];
+        maxValue = std::max(maxValue, static_cast<int>(x[i]));
+        minValue = std::min(minValue, static_cast<int>(x[i]));
+    }
+    stats.peak = std::max(maxValue, -minValue);
+    return stats;
+}
+
+void SplitGain(float gain, int16_t* mantissa, int* shift) {
+    int s = 0;
+    gain = std::max(gain, 0.0f);
+    while (gain >= 1.0f && s < kMaxShift) {
+        gain *= 0.5f;
+        ++s;
+    }
+    *mantissa = static_cast<int16_t>(std::min(std::lround(gain * 32768.0f), 32767L));
+    *shift = s;
+}
+
+void ScaleSaturate(const int16_t* in, int16_t* out, int count, int16_t mantissa, int shift) {
+    int i = 0;
+#if defined(APM_KERNELS_NEON)
+    int16x8_t m = vdupq_n_s16(mantissa);
+    int16x8_t s = vdupq_n_s16(static_cast<int16_t>(shift));
+    for (; i + 16 <= count; i += 16) {
+        int16x8_t a = vld1q_s16(in + i);
+        int16x8_t b = vld1q_s16(in + i + 8);
+        a = vqshlq_s16(vqrdmulhq_s16(a, m), s);
+        b = vqshlq_s16(vqrdmulhq_s16(b, m), s);
+        vst1q_s16(out + i, a);
+        vst1q_s16(out + i + 8, b);
+    }
+    for (; i + 8 <= count; i += 8) {
+        vst1q_s16(out + i, vqshlq_s16(vqrdmulhq_s16(vld1q_s16(in + i), m), s));
+    }
+#elif defined(APM_KERNELS_SSE2)
+    // SSE2 没有 pmulhrsw：在 32 位中计算 (x * m + 2^14) >> 15，左移后由 packs 饱和
+    __m128i m = _mm_set1_epi16(mantissa);
+    __m128i round = _mm_set1_epi32(1 << 14);
+    __m128i count32 = _mm_cvtsi32_si128(shift);
+    for (; i + 8 <= count; i += 8) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+        __m128i lo = _mm_mullo_epi16(v, m);
+        __m128i hi = _mm_mulhi_epi16(v, m);
+        __m128i p0 = _mm_srai_epi32(_mm_add_epi32(_mm_unpacklo_epi16(lo, hi), round), 15);
+        __m128i p1 = _mm_srai_epi32(_mm_add_epi32(_mm_unpackhi_epi16(lo, hi), round), 15);
+        p0 = _mm_sll_epi32(p0, count32);
+        p1 = _mm_sll_epi32(p1, count32);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_packs_epi32(p0, p1));
+    }
+#endif
+    for (; i < count; ++i) {
+        // vqrdmulh: sat((2 * a * b + 2^15) >> 16)
+        int32_t product = (2 * static_cast<int32_t>(in[i]) * mantissa + (1 << 15)) >> 16;
+        int32_t scaled = Saturate(product) * (1 << shift);
+        out[i] = Saturate(scaled);
+    }
+}
+
+void ApplyGainRamp(const int16_t* in, int16_t* out, int count, float fromGain, float toGain) {
+    if (count <= 0) return;
+
+    int16_t mantissa;
+    int shift;
+    if (fromGain == toGain) {
+        SplitGain(toGain, &mantissa, &shift);
+        ScaleSaturate(in, out, count, mantissa, shift);
+        return;
+    }
+
+    float step = (toGain - fromGain) / count;
+    for (int i = 0; i < count; i += kRampSegment) {
+        int n = std::min(kRampSegment, count - i);
+        SplitGain(fromGain + step * (i + n), &mantissa, &shift);
+        ScaleSaturate(in + i, out + i, n, mantissa, shift);
+    }
+}
+
+void Blend(const int16_t* a, const int16_t* b, int16_t* out, int count, int weight) {
+    weight = std::clamp(weight, 0, 32768);
+    int i = 0;
+#if defined(APM_KERNELS_NEON)
+    int32x4_t w = vdupq_n_s32(weight);
+    for (; i + 8 <= count; i += 8) {
+        int16x8_t va = vld1q_s16(a + i);
+        int16x8_t vb = vld1q_s16(b + i);
+        int32x4_t d0 = vsubl_s16(vget_low_s16(vb), vget_low_s16(va));
+        int32x4_t d1 = vsubl_s16(vget_high_s16(vb), vget_high_s16(va));
+        int32x4_t r0 = vaddw_s16(vrshrq_n_s32(vmulq_s32(d0, w), 15), vget_low_s16(va));
+        int32x4_t r1 = vaddw_s16(vrshrq_n_s32(vmulq_s32(d1, w), 15), vget_high_s16(va));
+        vst1q_s16(out + i, vcombine_s16(vqmovn_s32(r0), vqmovn_s32(r1)));
+    }
+#elif defined(APM_KERNELS_SSE2)
+    // a * (32768 - w) + b * w 用 pmaddwd 计算，端点权重（0 或 32768）无法用 int16 表示，交给标量
+    if (weight > 0 && weight < 32768) {
+        __m128i weights = _mm_set1_epi32((weight << 16) | (32768 - weight));
+        __m128i round = _mm_set1_epi32(1 << 14);
+        for (; i + 8 <= count; i += 8) {
+            __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+            __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+            __m128i r0 = _mm_madd_epi16(_mm_unpacklo_epi16(va, vb), weights);
+            __m128i r1 = _mm_madd_epi16(_mm_unpackhi_epi16(va, vb), weights);
+            r0 = _mm_srai_epi32(_mm_add_epi32(r0, round), 15);
+            r1 = _mm_srai_epi32(_mm_add_epi32(r1, round), 15);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_packs_epi32(r0, r1));
+        }
+    }
+#endif
+    for (; i < count; ++i) {
+        int32_t diff = static_cast<int32_t>(b[i]) - a[i];
+        out[i] = Saturate(a[i] + ((diff * weight + (1 << 14)) >> 15));
+    }
+}
+
+void Downmix(const int16_t* in, int16_t* out, int frames, int channels) {
+    int i = 0;
+    if (channels == 2) {
+        // 立体声：成对相加后算术右移一位，与标量的向下取整一致
+#if defined(APM_KERNELS_NEON)
+        for (; i + 8 <= frames; i += 8) {
+            int16x8x2_t v = vld2q_s16(in + 2 * i);
+            vst1q_s16(out + i, vhaddq_s16(v.val[0], v.val[1]));
+        }
+#elif defined(APM_KERNELS_SSE2)
+        __m128i ones = _mm_set1_epi16(1);
+        for (; i + 8 <= frames; i += 8) {
+            __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + 2 * i));
+            __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + 2 * i + 8));
+            __m128i sa = _mm_srai_epi32(_mm_madd_epi16(a, ones), 1);
+            __m128i sb = _mm_srai_epi32(_mm_madd_epi16(b, ones), 1);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_packs_epi32(sa, sb));
+        }
+#endif
+        for (; i < frames; ++i) {
+            out[i] = static_cast<int16_t>((in[2 * i] + in[2 * i + 1]) >> 1);
+        }
+        return;
+    }
+
+    for (; i < frames; ++i) {
+        int32_t sum = 0;
+        for (int c = 0; c < channels; ++c) sum += in[i * channels + c];
+        // 负数向下取整，与立体声路径一致
+        out[i] = static_cast<int16_t>((sum >= 0 ? sum : sum - channels + 1) / channels);
+    }
+}
+
+void Upmix(const int16_t* in, int16_t* out, int frames, int channels) {
+    for (int i = 0; i < frames; ++i) {
+        for (int c = 0; c < channels; ++c) out[i * channels + c] = in[i];
+    }
+}
+
+void Deinterleave(const int16_t* in, int16_t* out, int frames, int channels) {
+    for (int c = 0; c < channels; ++c) {
+        int16_t* plane = out + static_cast<size_t>(c) * frames;
+        for (int i = 0; i < frames; ++i) plane[i] = in[i * channels + c];
+    }
+}
+
+void Interleave(const int16_t* in, int16_t* out, int frames, int channels) {
+    for (int c = 0; c < channels; ++c) {
+        const int16_t* plane = in + static_cast<size_t>(c) * frames;
+        for (int i = 0; i < frames; ++i) out[i * channels + c] = plane[i];
+    }
+}
+
+void Int16ToFloat(const int16_t* in, float* out, int count, float scale) {
+    int i = 0;
+#if defined(APM_KERNELS_NEON)
+    for (; i + 8 <= count; i += 8) {
+        int16x8_t v = vld1q_s16(in + i);
+        vst1q_f32(out + i, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(v))), scale));
+        vst1q_f32(out + i + 4, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(v))), scale));
+    }
+#elif defined(APM_KERNELS_SSE2)
+    __m128 s = _mm_set1_ps(scale);
+    for (; i + 8 <= count; i += 8) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+        // 符号扩展：高 16 位放入样本，再算术右移
+        __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16);
+        __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16);
+        _mm_storeu_ps(out + i, _mm_mul_ps(_mm_cvtepi32_ps(lo), s));
+        _mm_storeu_ps(out + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(hi), s));
+    }
+#endif
+    for (; i < count; ++i) {
+        out[i] = in[i] * scale;
+    }
+}
+
+void FloatToInt16(const float* in, int16_t* out, int count, float scale) {
+    int i = 0;
+#if defined(APM_KERNELS_NEON)
+    float32x4_t lo = vdupq_n_f32(-32768.0f);
+    float32x4_t hi = vdupq_n_f32(32767.0f);
+    for (; i + 8 <= count; i += 8) {
+        float32x4_t a = vminq_f32(vmaxq_f32(vmulq_n_f32(vld1q_f32(in + i), scale), lo), hi);
+        float32x4_t b = vminq_f32(vmaxq_f32(vmulq_n_f32(vld1q_f32(in + i + 4), scale), lo), hi);
+        vst1q_s16(out + i, vcombine_s16(vmovn_s32(vcvtq_s32_f32(a)), vmovn_s32(vcvtq_s32_f32(b))));
+    }
+#elif defined(APM_KERNELS_SSE2)
+    __m128 s = _mm_set1_ps(scale);
+    __m128 lo = _mm_set1_ps(-32768.0f);
+    __m128 hi = _mm_set1_ps(32767.0f);
+    for (; i + 8 <= count; i += 8) {
+        __m128 a = _mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(in + i), s), lo), hi);
+        __m128 b = _mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(in + i + 4), s), lo), hi);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i),
+                         _mm_packs_epi32(_mm_cvttps_epi32(a), _mm_cvttps_epi32(b)));
+    }
+#endif
+    for (; i < count; ++i) {
+        out[i] = SaturateFloat(in[i] * scale);
+    }
+}
+
+} // namespace dsp
+} // namespace webrtc_apm
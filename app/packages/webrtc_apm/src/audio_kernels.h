@@ -0,0 +1,103 @@
+#ifndef AUDIO_KERNELS_H
+#define AUDIO_KERNELS_H
+
+#include <cstdint>
+
+namespace webrtc_apm {
+namespace dsp {
+
+/**
+ * PCM16 定点运算内核
+ *
+ * ARM 上使用 NEON，x86 上使用 SSE2，其他平台为标量实现。
+ * 定点内核在各实现间结果逐位一致；浮点转换均为先饱和再向零截断。
+ */
+
+/**
+ * 帧统计：样本平方和与最大绝对值
+ */
+struct FrameStats {
+    int64_t energy = 0;
+    int peak = 0;
+
+    void Add(const FrameStats& other) {
+        energy += other.energy;
+        if (other.peak > peak) peak = other.peak;
+    }
+};
+
+/**
+ * sum(a[i] * b[i])
+ */
+int64_t Dot(const int16_t* a, const int16_t* b, int count);
+
+/**
+ * sum(x[i] * x[i])
+ */
+int64_t SumSquares(const int16_t* x, int count);
+
+/**
+ * 一次遍历同时计算平方和与峰值
+ */
+FrameStats ComputeStats(const int16_t* x, int count);
+
+/**
+ * 将增益拆分为 Q15 尾数与左移位数：gain ≈ mantissa / 32768 * 2^shift
+ */
+void SplitGain(float gain, int16_t* mantissa, int* shift);
+
+/**
+ * 饱和定点增益：out = sat((in * mantissa) >> 15 << shift)
+ *
+ * 乘法为带舍入的倍乘取高半（vqrdmulh 语义），再做饱和左移。out 可与 in 相同
+ */
+void ScaleSaturate(const int16_t* in, int16_t* out, int count, int16_t mantissa, int shift);
+
+/**
+ * 在 count 个样本内将增益从 fromGain 线性过渡到 toGain（每 8 个样本一段），饱和输出
+ *
+ * out 可与 in 相同
+ */
+void ApplyGainRamp(const int16_t* in, int16_t* out, int count, float fromGain, float toGain);
+
+/**
+ * 混合：out = a + round((b - a) * weight / 32768)，weight 为 Q15（0..32768）
+ *
+ * out 可与 a 或 b 相同
+ */
+void Blend(const int16_t* a, const int16_t* b, int16_t* out, int count, int weight);
+
+/**
+ * 交织多声道混为单声道：out[i] = floor(sum(in[i * channels + c]) / channels)
+ */
+void Downmix(const int16_t* in, int16_t* out, int frames, int channels);
+
+/**
+ * 单声道复制到每个声道，得到交织输出
+ */
+void Upmix(const int16_t* in, int16_t* out, int frames, int channels);
+
+/**
+ * 交织转平面：声道 c 写到 out + c * frames
+ */
+void Deinterleave(const int16_t* in, int16_t* out, int frames, int channels);
+
+/**
+ * 平面转交织，Deinterleave 的逆操作
+ */
+void Interleave(const int16_t* in, int16_t* out, int frames, int channels);
+
+/**
+ * out[i] = in[i] * scale
+ */
+void Int16ToFloat(const int16_t* in, float* out, int count, float scale);
+
+/**
+ * out[i] = sat(in[i] * scale)，向零截断
+ */
+void FloatToInt16(const float* in, int16_t* out, int count, float scale);
+
+} // namespace dsp
+} // namespace webrtc_apm
+
+#endif // AUDIO_KERNELS_H
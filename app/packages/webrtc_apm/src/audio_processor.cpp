@@ -0,0 +1,872 @@
+#include "include/audio_processor.h"
+#include "audio_framer.h"
+#include "audio_kernels.h"
+#include "echo_canceller.h"
+#include "gain_controller.h"
+#include "latency_histogram.h"
+#include "noise_suppressor.h"
+#include "render_ring.h"
+#include "resampler.h"
+#include "voice_detector.h"
+#include <cstring>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+
+#define LOG_TAG "WebRTC_APM"
+#include "apm_log.h"
+
+namespace webrtc_apm {
+
+namespace {
+    // 参考信号环形缓冲区容量（毫秒），可远大于 AEC 比对窗口
+    constexpr int kRenderHistoryMs = 500;
+
+    // 参考信号最长滞留时间：超出的视为过期丢弃，剩余延迟由 AEC 的延迟估计覆盖（最大 250ms）
+    constexpr int64_t kEchoWindowNs = 100 * 1000000LL;
+
+    // 调试统计周期：500 个 10ms 块，即每 5 秒一行
+    constexpr int kStatsPeriodBlocks = 500;
+
+    // 处理模块的最高运行采样率：更高的输入（如 44.1/48kHz）先降采样再处理
+    constexpr int kMaxProcessingRate = 16000;
+
+    // 实时采集/渲染在这段时间内有调用即视为仍在进行，批量处理时提示一次
+    constexpr int64_t kLiveActivityNs = 1000 * 1000000LL;
+
+    int64_t MonotonicNowNs() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    /**
+     * 满幅（削波）样本数
+     */
+    int CountClipped(const int16_t* x, int count) {
+        int clipped = 0;
+        for (int i = 0; i < count; ++i) {
+            clipped += (x[i] == INT16_MAX) | (x[i] == INT16_MIN);
+        }
+        return clipped;
+    }
+
+    /**
+     * 记录从 sinceNs 到当前的阶段耗时，返回当前时间作为下一阶段的起点
+     */
+    int64_t RecordStage(LatencyHistogram* histogram, int64_t sinceNs) {
+        int64_t now = MonotonicNowNs();
+        histogram->Record(now - sinceNs);
+        return now;
+    }
+
+    void FillStage(const LatencyHistogram& histogram, StageLatency* stage) {
+        stage->blocks = histogram.Count();
+        stage->p50Us = histogram.PercentileUs(0.5);
+        stage->p99Us = histogram.PercentileUs(0.99);
+        stage->maxUs = histogram.MaxUs();
+    }
+}
+
+/**
+ * AudioProcessor 内部实现
+ *
+ * 注意：这是一个简化实现，提供基本的音频处理功能
+ * 完整的 WebRTC APM 需要链接 libwebrtc_audio_processing.so
+ */
+class AudioProcessor::Impl {
+public:
+    Impl() : sampleRate_(16000), processingRate_(16000), channels_(1) {
+        renderRing_.Reset(processingRate_ * kRenderHistoryMs / 1000, processingRate_);
+    }
+
+    ~Impl() = default;
+
+    bool Initialize(int sampleRate, int channels) {
+        if (sampleRate <= 0 || channels <= 0) {
+            LOGE("Invalid format: sampleRate=%d, channels=%d", sampleRate, channels);
+            return false;
+        }
+        sampleRate_ = sampleRate;
+        processingRate_ = std::min(sampleRate, kMaxProcessingRate);
+        channels_ = channels;
+
+        // 采集按固定 10ms 块处理，参考信号同样换算到处理采样率
+        if (!framer_.Initialize(sampleRate_, processingRate_, channels_) ||
+            !renderResampler_.Initialize(sampleRate_, processingRate_, channels_)) {
+            LOGE("Failed to initialize framer: sampleRate=%d, processingRate=%d", sampleRate_, processingRate_);
+            return false;
+        }
+        block_.assign(framer_.BlockSamples(), 0);
+        planar_.assign(channels_ > 1 ? framer_.BlockSamples() : 0, 0);
+
+        // 参考信号混为单声道后缓存，所有采集声道的 AEC 共用
+        renderRing_.Reset(processingRate_ * kRenderHistoryMs / 1000, processingRate_);
+
+        echoCancellers_.resize(channels_);
+        for (auto& aec : echoCancellers_) {
+            if (!aec.Initialize(processingRate_)) {
+                LOGE("Failed to initialize echo canceller: sampleRate=%d", processingRate_);
+                return false;
+            }
+        }
+
+        noiseSuppressors_.resize(channels_);
+        for (auto& ns : noiseSuppressors_) {
+            if (!ns.Initialize(processingRate_)) {
+                LOGE("Failed to initialize noise suppressor: sampleRate=%d", processingRate_);
+                return false;
+            }
+        }
+
+        if (!gainController_.Initialize(processingRate_)) {
+            LOGE("Failed to initialize gain controller: sampleRate=%d", processingRate_);
+            return false;
+        }
+
+        if (!voiceDetector_.Initialize(processingRate_)) {
+            LOGE("Failed to initialize voice detector: sampleRate=%d", processingRate_);
+            return false;
+        }
+        lastSpeech_.store(true, std::memory_order_relaxed);
+        bypassGain_ = 1.0f;
+        ApplyConfig(true);
+        ResetCaptureStats();
+        renderFrames_.store(0, std::memory_order_relaxed);
+        renderFramesBase_.store(0, std::memory_order_relaxed);
+        renderOverrunsBase_.store(0, std::memory_order_relaxed);
+        statsResetRequested_.store(false, std::memory_order_relaxed);
+        LOGD("Initialized: sampleRate=%d, processingRate=%d, channels=%d, latency=%d frames",
+             sampleRate, processingRate_, channels, framer_.LatencyFrames());
+        return true;
+    }
+
+    /**
+     * 复制另一实例待生效的配置，在 Initialize 之前调用时由其一并应用
+     */
+    void CopyConfig(const Impl& other) {
+        pendingAec_.store(other.pendingAec_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        pendingNs_.store(other.pendingNs_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        pendingAgc_.store(other.pendingAgc_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        pendingVad_.store(other.pendingVad_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        pendingDownmix_.store(other.pendingDownmix_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        pendingAecLevel_.store(other.pendingAecLevel_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        pendingNsLevel_.store(other.pendingNsLevel_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        pendingAgcMode_.store(other.pendingAgcMode_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        pendingAgcTarget_.store(other.pendingAgcTarget_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        PublishConfig();
+    }
+
+    void Destroy() {
+        renderRing_.Clear();
+        renderScratch_.clear();
+        renderResampled_.clear();
+        block_.clear();
+        planar_.clear();
+        batchIn_.clear();
+        batchOut_.clear();
+        echoCancellers_.clear();
+        noiseSuppressors_.clear();
+        LOGD("Destroyed");
+    }
+
+    bool SetAecEnabled(bool enabled) {
+        pendingAec_.store(enabled, std::memory_order_relaxed);
+        PublishConfig();
+        LOGD("AEC enabled: %d", enabled);
+        return true;
+    }
+
+    bool SetAecSuppressionLevel(int level) {
+        level = std::clamp(level, 0, 2);
+        pendingAecLevel_.store(level, std::memory_order_relaxed);
+        PublishConfig();
+        LOGD("AEC suppression level: %d", level);
+        return true;
+    }
+
+    bool SetNsEnabled(bool enabled) {
+        pendingNs_.store(enabled, std::memory_order_relaxed);
+        PublishConfig();
+        LOGD("NS enabled: %d", enabled);
+        return true;
+    }
+
+    bool SetNsSuppressionLevel(int level) {
+        level = std::clamp(level, 0, 3);
+        pendingNsLevel_.store(level, std::memory_order_relaxed);
+        PublishConfig();
+        LOGD("NS suppression level: %d", level);
+        return true;
+    }
+
+    bool SetAgcEnabled(bool enabled) {
+        pendingAgc_.store(enabled, std::memory_order_relaxed);
+        PublishConfig();
+        LOGD("AGC enabled: %d", enabled);
+        return true;
+    }
+
+    bool SetAgcMode(int mode) {
+        mode = std::clamp(mode, 0, 2);
+        pendingAgcMode_.store(mode, std::memory_order_relaxed);
+        PublishConfig();
+        LOGD("AGC mode: %d", mode);
+        return true;
+    }
+
+    bool SetAgcTargetLevel(int targetLevelDbfs) {
+        targetLevelDbfs = std::clamp(targetLevelDbfs, 0, 31);
+        pendingAgcTarget_.store(targetLevelDbfs, std::memory_order_relaxed);
+        PublishConfig();
+        LOGD("AGC target level: %d", targetLevelDbfs);
+        return true;
+    }
+
+    bool SetVadEnabled(bool enabled) {
+        pendingVad_.store(enabled, std::memory_order_relaxed);
+        PublishConfig();
+        if (!enabled) lastSpeech_.store(true, std::memory_order_relaxed);
+        LOGD("VAD enabled: %d", enabled);
+        return true;
+    }
+
+    bool SetDownmixEnabled(bool enabled) {
+        pendingDownmix_.store(enabled, std::memory_order_relaxed);
+        PublishConfig();
+        LOGD("Downmix enabled: %d (channels=%d)", enabled, channels_);
+        return true;
+    }
+
+    int ProcessCaptureFrame(const int16_t* audioData, int sampleCount, int16_t* outputData) {
+        if (!audioData || !outputData || sampleCount <= 0) {
+            return 0;
+        }
+
+        // 只处理完整的帧，末尾不足一帧的样本原样输出
+        int frames = sampleCount / channels_;
+        int tail = sampleCount - frames * channels_;
+
+        if (statsResetRequested_.exchange(false, std::memory_order_acquire)) {
+            ResetCaptureStats();
+        }
+        AddRelaxed(&inputClipped_, CountClipped(audioData, frames * channels_));
+
+        // 输入写入分帧器后即可覆盖（支持原地处理）
+        framer_.Write(audioData, frames);
+
+        int blockSamples = framer_.BlockSamples();
+        int blockFrames = blockSamples / channels_;
+        bool processed = false;
+        bool speech = false;
+        while (const int16_t* block = framer_.ReadBlock()) {
+            // 配置在块边界生效，按当前开关组合分派到对应的特化处理链
+            ApplyConfig(false);
+            int chainIndex = chainIndex_;
+            CaptureChain chain = kCaptureChains[chainIndex];
+
+            // 多声道按平面布局逐声道处理；混音模式下只处理一路单声道，输出复制到各声道。
+            // 全部模块关闭时直接在交织数据上复制，不转换布局
+            bool multichannel = channels_ > 1 && chainIndex != 0;
+            bool downmix = multichannel && applied_.downmix;
+            int planes = multichannel && !downmix ? channels_ : 1;
+
+            // 取出与本块对应的参考信号（即使 AEC 关闭也要消费，避免缓冲区堆满）
+            int renderCount = ConsumeRender(blockFrames);
+            int64_t startNs = MonotonicNowNs();
+            lastActivityNs_.store(startNs, std::memory_order_relaxed);
+            int64_t stageStart = startNs;
+
+            // 语音检测在所有模块之前，非语音块跳过整条处理链
+            bool blockSpeech = true;
+            if (applied_.vad) {
+                blockSpeech = voiceDetector_.Process(block, blockFrames, channels_);
+                stageStart = RecordStage(&vadLatency_, stageStart);
+            }
+
+            const int16_t* in = block;
+            int16_t* out = block_.data();
+            if (multichannel) {
+                if (downmix) {
+                    dsp::Downmix(block, planar_.data(), blockFrames, channels_);
+                } else {
+                    dsp::Deinterleave(block, planar_.data(), blockFrames, channels_);
+                }
+                in = out = planar_.data();
+            }
+
+            int frames = multichannel ? blockFrames : blockSamples;
+            int64_t endNs = blockSpeech
+                ? (this->*chain)(in, out, frames, planes, renderCount, stageStart)
+                : BypassCapture(in, out, frames * planes, (chainIndex & 2) != 0);
+
+            if (multichannel) {
+                if (downmix) {
+                    dsp::Upmix(planar_.data(), block_.data(), blockFrames, channels_);
+                } else {
+                    dsp::Interleave(planar_.data(), block_.data(), blockFrames, channels_);
+                }
+                endNs = MonotonicNowNs();
+            }
+            totalLatency_.Record(endNs - startNs);
+            AddRelaxed(&speechBlocks_, blockSpeech ? 1 : 0);
+
+            processed = true;
+            speech |= blockSpeech;
+            framer_.WriteBlock(block_.data());
+            LogBlockStats(renderCount > 0);
+        }
+        if (processed) lastSpeech_.store(speech, std::memory_order_relaxed);
+
+        framer_.Read(outputData, frames);
+        AddRelaxed(&outputClipped_, CountClipped(outputData, frames * channels_));
+        if (tail > 0 && outputData != audioData) {
+            std::memcpy(outputData + frames * channels_, audioData + frames * channels_, tail * sizeof(int16_t));
+        }
+        return sampleCount;
+    }
+
+    bool ProcessRenderFrame(const int16_t* audioData, int sampleCount) {
+        if (!audioData || sampleCount <= 0) {
+            return false;
+        }
+
+        // 换算到处理采样率（同采样率时直接写入）
+        const int16_t* data = audioData;
+        int count = sampleCount;
+        if (!renderResampler_.IsPassthrough()) {
+            int frames = sampleCount / channels_;
+            size_t capacity = static_cast<size_t>(renderResampler_.MaxOutputFrames(frames)) * channels_;
+            if (renderResampled_.size() < capacity) renderResampled_.resize(capacity);
+            count = renderResampler_.Process(audioData, frames, renderResampled_.data()) * channels_;
+            data = renderResampled_.data();
+        }
+
+        // 多声道参考信号混为单声道（重采样后原地混音）
+        if (channels_ > 1) {
+            int frames = count / channels_;
+            if (static_cast<int>(renderResampled_.size()) < frames) renderResampled_.resize(frames);
+            dsp::Downmix(data, renderResampled_.data(), frames, channels_);
+            data = renderResampled_.data();
+            count = frames;
+        }
+
+        // 追加到参考信号环形缓冲区（渲染线程是唯一的生产者）
+        // 缓冲区满时丢弃本帧，采集线程会按时间戳清理过旧的数据
+        int64_t now = MonotonicNowNs();
+        renderRing_.Write(data, count, now);
+        lastActivityNs_.store(now, std::memory_order_relaxed);
+        AddRelaxed(&renderFrames_, 1);
+        return true;
+    }
+
+    void GetStats(ProcessingStats* stats) const {
+        *stats = ProcessingStats();
+        stats->captureBlocks = totalLatency_.Count();
+        stats->renderFrames = renderFrames_.load(std::memory_order_relaxed) -
+                              renderFramesBase_.load(std::memory_order_relaxed);
+        stats->renderOverruns = renderRing_.Overruns() - renderOverrunsBase_.load(std::memory_order_relaxed);
+        stats->inputClippedSamples = inputClipped_.load(std::memory_order_relaxed);
+        stats->outputClippedSamples = outputClipped_.load(std::memory_order_relaxed);
+        stats->processingTimeUs = totalLatency_.TotalUs();
+        stats->speechBlocks = speechBlocks_.load(std::memory_order_relaxed);
+
+        int delay = aecDelaySamples_.load(std::memory_order_relaxed);
+        stats->aecDelayMs = delay < 0 ? -1 : delay * 1000 / processingRate_;
+        stats->renderBufferedMs = std::max(renderRing_.Available(), 0) * 1000 / processingRate_;
+
+        FillStage(aecLatency_, &stats->aec);
+        FillStage(nsLatency_, &stats->ns);
+        FillStage(agcLatency_, &stats->agc);
+        FillStage(vadLatency_, &stats->vad);
+        FillStage(totalLatency_, &stats->total);
+    }
+
+    bool LastCaptureSpeech() const {
+        return lastSpeech_.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * 最近 kLiveActivityNs 内是否处理过采集块或参考信号；只在第一次为 true 时返回 true
+     */
+    bool ClaimLiveOverlapLog() const {
+        int64_t last = lastActivityNs_.load(std::memory_order_relaxed);
+        if (last == kNoActivity || MonotonicNowNs() - last >= kLiveActivityNs) return false;
+        return !liveOverlapLogged_.exchange(true, std::memory_order_relaxed);
+    }
+
+    /**
+     * 整批处理，只用于批量专用实例，调用前已重新初始化
+     *
+     * 分帧器的固定延迟在这里抵消：丢弃输出开头 LatencyFrames() 帧预填的静音，
+     * 输入之后再补同样长度的静音把滞留的样本冲出，输出与输入逐帧对齐，
+     * 只剩重采样滤波器的群延迟（处理采样率与输入相同时为 0）。
+     * 末尾不足一帧的样本原样输出
+     */
+    int ProcessBatch(const int16_t* capture, int sampleCount, const int16_t* render, int renderCount,
+                     int frameSamples, int16_t* outputData) {
+        int usable = sampleCount - sampleCount % channels_;
+        int skip = framer_.LatencyFrames() * channels_;
+        int total = usable + skip;
+        batchIn_.resize(frameSamples);
+        batchOut_.resize(frameSamples);
+
+        int written = 0;
+        for (int offset = 0; offset < total; offset += frameSamples) {
+            int count = std::min(frameSamples, total - offset);
+            int rendered = render ? std::clamp(renderCount - offset, 0, count) : 0;
+            if (rendered > 0) {
+                ProcessRenderFrame(render + offset, rendered);
+            }
+
+            // 跨过输入末尾的帧拼上补齐的静音
+            int fromInput = std::clamp(usable - offset, 0, count);
+            const int16_t* in = capture + offset;
+            if (fromInput < count) {
+                std::memcpy(batchIn_.data(), capture + offset, fromInput * sizeof(int16_t));
+                std::fill(batchIn_.begin() + fromInput, batchIn_.begin() + count, 0);
+                in = batchIn_.data();
+            }
+            ProcessCaptureFrame(in, count, batchOut_.data());
+
+            // 输出写在已读过的输入之前，原地处理同样安全
+            int drop = std::min(skip, count);
+            skip -= drop;
+            std::memcpy(outputData + written, batchOut_.data() + drop, (count - drop) * sizeof(int16_t));
+            written += count - drop;
+        }
+        if (usable < sampleCount && outputData != capture) {
+            std::memcpy(outputData + usable, capture + usable, (sampleCount - usable) * sizeof(int16_t));
+        }
+        return sampleCount;
+    }
+
+    void ResetStats() {
+        // 渲染侧计数记下基准值；采集侧的直方图只能由采集线程清空，留到下一块处理前
+        renderFramesBase_.store(renderFrames_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        renderOverrunsBase_.store(renderRing_.Overruns(), std::memory_order_relaxed);
+        statsResetRequested_.store(true, std::memory_order_release);
+    }
+
+private:
+    using CaptureChain = int64_t (Impl::*)(const int16_t*, int16_t*, int, int, int, int64_t);
+
+    /**
+     * 采集处理链，编译期按开关组合特化
+     *
+     * in/out 为平面布局：planes 个声道，声道 c 的 frames 个样本位于 c * frames 处。
+     * 第一个启用的模块从 in 读、向 out 写，后续模块在 out 上原地处理，
+     * 省去入口的整帧复制；只有全部关闭时才复制。
+     * AEC 与 NS 每个声道各自维护状态，AGC 各声道联动同一增益。
+     * NS 与 AGC 同时启用时 AGC 复用 NS 输出时顺带统计的能量。
+     * 每个启用的阶段结束时读一次时钟，计入该阶段的耗时直方图
+     * @return 处理结束的时刻
+     */
+    template <bool kAec, bool kNs, bool kAgc>
+    int64_t RunCapture(const int16_t* in, int16_t* out, int frames, int planes, int renderCount, int64_t startNs) {
+        const int16_t* src = in;
+        int64_t stageStart = startNs;
+        int sampleCount = frames * planes;
+
+        // 应用 AEC：延迟估计 + 频域自适应滤波 + 残余回声抑制
+        // 无参考信号时仍需送入，保持固定的处理延迟与参考信号历史
+        if constexpr (kAec) {
+            for (int c = 0; c < planes; ++c) {
+                size_t offset = static_cast<size_t>(c) * frames;
+                echoCancellers_[c].Process(src + offset, out + offset, frames, renderScratch_.data(), renderCount);
+            }
+            src = out;
+            stageStart = RecordStage(&aecLatency_, stageStart);
+            aecDelaySamples_.store(echoCancellers_[0].DelaySamples(), std::memory_order_relaxed);
+        } else {
+            aecDelaySamples_.store(-1, std::memory_order_relaxed);
+        }
+
+        // 应用 NS（STFT 频谱降噪），同时统计输出能量
+        dsp::FrameStats stats;
+        if constexpr (kNs) {
+            for (int c = 0; c < planes; ++c) {
+                size_t offset = static_cast<size_t>(c) * frames;
+                noiseSuppressors_[c].Process(src + offset, out + offset, frames, 1, kAgc ? &stats : nullptr);
+            }
+            src = out;
+            stageStart = RecordStage(&nsLatency_, stageStart);
+        }
+
+        // 应用 AGC（自动增益控制）
+        if constexpr (kAgc) {
+            if constexpr (!kNs) stats = dsp::ComputeStats(src, sampleCount);
+            gainController_.Process(src, out, frames, planes, stats.energy, stats.peak);
+            stageStart = RecordStage(&agcLatency_, stageStart);
+        }
+
+        if constexpr (!kAec && !kNs && !kAgc) {
+            if (out != in) std::memcpy(out, in, sampleCount * sizeof(int16_t));
+            stageStart = MonotonicNowNs();
+        }
+        bypassGain_ = 1.0f;
+        return stageStart;
+    }
+
+    /**
+     * 非语音块：跳过处理链，按 NS 的增益下限衰减（NS 关闭时原样输出），增益变化在块内过渡
+     *
+     * 跳过的块不进入 AEC/NS/AGC 的状态。可闻的回声本身会被判为语音，
+     * 因此跳过的段落里几乎没有需要对齐的参考信号，恢复处理后滤波器与延迟估计仍然有效
+     * @return 处理结束的时刻
+     */
+    int64_t BypassCapture(const int16_t* in, int16_t* out, int sampleCount, bool ns) {
+        float gain = ns ? noiseSuppressors_[0].MinGain() : 1.0f;
+        if (gain == 1.0f && bypassGain_ == 1.0f) {
+            if (out != in) std::memcpy(out, in, sampleCount * sizeof(int16_t));
+        } else {
+            dsp::ApplyGainRamp(in, out, sampleCount, bypassGain_, gain);
+        }
+        bypassGain_ = gain;
+        return MonotonicNowNs();
+    }
+
+    // 下标为 aec << 2 | ns << 1 | agc
+    static constexpr CaptureChain kCaptureChains[8] = {
+        &Impl::RunCapture<false, false, false>,
+        &Impl::RunCapture<false, false, true>,
+        &Impl::RunCapture<false, true, false>,
+        &Impl::RunCapture<false, true, true>,
+        &Impl::RunCapture<true, false, false>,
+        &Impl::RunCapture<true, false, true>,
+        &Impl::RunCapture<true, true, false>,
+        &Impl::RunCapture<true, true, true>,
+    };
+
+    /**
+     * 一组处理配置
+     */
+    struct CaptureConfig {
+        bool aec = false;
+        bool ns = false;
+        bool agc = false;
+        bool vad = false;
+        bool downmix = false;
+        int aecLevel = 2;
+        int nsLevel = 2;
+        int agcMode = 1;
+        int agcTarget = 3;
+    };
+
+    /**
+     * 设置调用写入的配置已全部存入，递增版本号通知采集线程
+     */
+    void PublishConfig() {
+        configVersion_.fetch_add(1, std::memory_order_release);
+    }
+
+    /**
+     * 在块边界应用设置调用发布的配置（只在采集线程或 Initialize 中调用）
+     *
+     * 各模块的状态只由采集线程修改：抑制级别、AGC 模式与目标电平在这里写入模块，
+     * 模块由关到开时先 Reset，避免沿用关闭前的旧状态。
+     * 版本号未变时只有一次原子读
+     * @param initialize 模块刚初始化，全部参数重新写入并重置状态
+     */
+    void ApplyConfig(bool initialize) {
+        uint32_t version = configVersion_.load(std::memory_order_acquire);
+        if (!initialize && version == appliedVersion_) return;
+        appliedVersion_ = version;
+
+        CaptureConfig next;
+        next.aec = pendingAec_.load(std::memory_order_relaxed);
+        next.ns = pendingNs_.load(std::memory_order_relaxed);
+        next.agc = pendingAgc_.load(std::memory_order_relaxed);
+        next.vad = pendingVad_.load(std::memory_order_relaxed);
+        next.downmix = pendingDownmix_.load(std::memory_order_relaxed);
+        next.aecLevel = pendingAecLevel_.load(std::memory_order_relaxed);
+        next.nsLevel = pendingNsLevel_.load(std::memory_order_relaxed);
+        next.agcMode = pendingAgcMode_.load(std::memory_order_relaxed);
+        next.agcTarget = pendingAgcTarget_.load(std::memory_order_relaxed);
+
+        if (initialize || next.aecLevel != applied_.aecLevel) {
+            for (auto& aec : echoCancellers_) aec.SetSuppressionLevel(next.aecLevel);
+        }
+        if (initialize || (next.aec && !applied_.aec)) {
+            for (auto& aec : echoCancellers_) aec.Reset();
+        }
+
+        if (initialize || next.nsLevel != applied_.nsLevel) {
+            for (auto& ns : noiseSuppressors_) ns.SetLevel(next.nsLevel);
+        }
+        if (initialize || (next.ns && !applied_.ns)) {
+            for (auto& ns : noiseSuppressors_) ns.Reset();
+        }
+
+        if (initialize || next.agcMode != applied_.agcMode) {
+            gainController_.SetMode(next.agcMode);
+        }
+        if (initialize || next.agcTarget != applied_.agcTarget) {
+            gainController_.SetTargetLevel(next.agcTarget);
+        }
+        if (initialize || (next.agc && !applied_.agc)) {
+            gainController_.Reset();
+        }
+
+        if (initialize || (next.vad && !applied_.vad)) {
+            voiceDetector_.Reset();
+        }
+        if (!next.vad) lastSpeech_.store(true, std::memory_order_relaxed);
+
+        applied_ = next;
+        chainIndex_ = (next.aec ? 4 : 0) | (next.ns ? 2 : 0) | (next.agc ? 1 : 0);
+    }
+
+    /**
+     * 从参考信号环形缓冲区取出一帧（采集线程是唯一的消费者）
+     *
+     * 先丢弃比对窗口之外的旧数据，再取窗口内最早的样本。
+     * 参考信号与采集按相同速率消费，两者间的剩余延迟由 AEC 的延迟估计补偿
+     * @param sampleCount 单声道样本数（参考信号写入时已混为单声道）
+     * @return 取到的样本数
+     */
+    int ConsumeRender(int sampleCount) {
+        renderRing_.DiscardOlderThan(MonotonicNowNs() - kEchoWindowNs);
+        if (renderRing_.Available() == 0) return 0;
+
+        if (static_cast<int>(renderScratch_.size()) < sampleCount) {
+            renderScratch_.resize(sampleCount);
+        }
+        return renderRing_.Read(renderScratch_.data(), sampleCount, nullptr);
+    }
+
+    /**
+     * 清空采集侧统计，只在采集线程（或不与处理并发的 Initialize）中调用
+     */
+    void ResetCaptureStats() {
+        aecLatency_.Reset();
+        nsLatency_.Reset();
+        agcLatency_.Reset();
+        vadLatency_.Reset();
+        totalLatency_.Reset();
+        speechBlocks_.store(0, std::memory_order_relaxed);
+        inputClipped_.store(0, std::memory_order_relaxed);
+        outputClipped_.store(0, std::memory_order_relaxed);
+    }
+
+    /**
+     * 单写者计数：relaxed 的 load + store，不需要原子读改写
+     */
+    static void AddRelaxed(std::atomic<uint64_t>* counter, uint64_t value) {
+        if (value == 0) return;
+        counter->store(counter->load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+    }
+
+    /**
+     * 逐块统计，每 kStatsPeriodBlocks 块输出一行汇总（release 构建中整段被消除）
+     */
+    void LogBlockStats(bool renderAvailable) {
+        int hits = 0;
+        int total = 0;
+        if (!blockStats_.Add(renderAvailable, &hits, &total)) return;
+        LOGD("Capture stats: render %d/%d blocks, aec=%d delay=%d, agc=%d gain=%.1fdB, render overruns=%llu",
+             hits, total, applied_.aec, echoCancellers_[0].DelaySamples(), applied_.agc,
+             20.0f * std::log10(std::max(gainController_.Gain(), 1e-6f)),
+             static_cast<unsigned long long>(renderRing_.Overruns()));
+    }
+
+    int sampleRate_;
+    int processingRate_;
+    int channels_;
+
+    // 设置调用写入的配置，可在任意线程上与处理并发；写完后递增 configVersion_
+    std::atomic<bool> pendingAec_{false};
+    std::atomic<bool> pendingNs_{false};
+    std::atomic<bool> pendingAgc_{false};
+    std::atomic<bool> pendingVad_{false};
+    std::atomic<bool> pendingDownmix_{false};
+    std::atomic<int> pendingAecLevel_{2};
+    std::atomic<int> pendingNsLevel_{2};
+    std::atomic<int> pendingAgcMode_{1};
+    std::atomic<int> pendingAgcTarget_{3};
+    std::atomic<uint32_t> configVersion_{0};
+
+    // 采集线程当前生效的配置，以及对应的处理链在 kCaptureChains 中的下标
+    CaptureConfig applied_;
+    uint32_t appliedVersion_ = 0;
+    int chainIndex_ = 0;
+
+    // 采集分帧与重采样，处理模块只看到处理采样率下的 10ms 块
+    AudioFramer framer_;
+    std::vector<int16_t> block_;
+
+    // 多声道时的平面布局工作区（混音模式下只用第一个声道）
+    std::vector<int16_t> planar_;
+
+    // 参考信号环形缓冲区（用于 AEC，处理采样率、单声道），渲染线程写入、采集线程读取
+    RenderRing renderRing_;
+
+    // 参考信号重采样（仅渲染线程使用）
+    Resampler renderResampler_;
+    std::vector<int16_t> renderResampled_;
+
+    // 每个声道一个回声消除器与降噪器
+    std::vector<EchoCanceller> echoCancellers_;
+    std::vector<NoiseSuppressor> noiseSuppressors_;
+
+    GainController gainController_;
+
+    VoiceDetector voiceDetector_;
+
+    // 上一次采集调用的语音判决，以及非语音块当前的衰减增益（仅采集线程写入）
+    std::atomic<bool> lastSpeech_{true};
+    float bypassGain_ = 1.0f;
+
+    // 采集线程取出的当前帧参考信号
+    std::vector<int16_t> renderScratch_;
+
+    // 处理统计：采集线程写入，GetStats 可在任意线程读取
+    LatencyHistogram aecLatency_;
+    LatencyHistogram nsLatency_;
+    LatencyHistogram agcLatency_;
+    LatencyHistogram vadLatency_;
+    LatencyHistogram totalLatency_;
+    std::atomic<uint64_t> inputClipped_{0};
+    std::atomic<uint64_t> outputClipped_{0};
+    std::atomic<uint64_t> speechBlocks_{0};
+    std::atomic<int> aecDelaySamples_{-1};
+    std::atomic<bool> statsResetRequested_{false};
+
+    // 参考信号计数由渲染线程写入；ResetStats 只记基准值，不与写入竞争
+    std::atomic<uint64_t> renderFrames_{0};
+    std::atomic<uint64_t> renderFramesBase_{0};
+    std::atomic<uint64_t> renderOverrunsBase_{0};
+
+    // 热路径日志聚合（仅采集线程使用）
+    LogCounter blockStats_{kStatsPeriodBlocks};
+
+    // 最近一次采集块或参考信号的时刻，以及是否已提示过批量与实时处理交叠
+    static constexpr int64_t kNoActivity = INT64_MIN;
+    std::atomic<int64_t> lastActivityNs_{kNoActivity};
+    mutable std::atomic<bool> liveOverlapLogged_{false};
+
+    // 批量处理的输入补齐与输出工作区（仅批量专用实例使用）
+    std::vector<int16_t> batchIn_;
+    std::vector<int16_t> batchOut_;
+};
+
+// AudioProcessor 实现
+AudioProcessor::AudioProcessor()
+    : impl_(std::make_unique<Impl>()), initialized_(false), sampleRate_(16000), channels_(1) {}
+
+AudioProcessor::~AudioProcessor() {
+    Destroy();
+}
+
+bool AudioProcessor::Initialize(int sampleRate, int channels) {
+    if (initialized_) return true;
+
+    sampleRate_ = sampleRate;
+    channels_ = channels;
+
+    if (impl_->Initialize(sampleRate, channels)) {
+        initialized_ = true;
+        return true;
+    }
+    return false;
+}
+
+void AudioProcessor::Destroy() {
+    if (!initialized_) return;
+    impl_->Destroy();
+    batchImpl_.reset();
+    initialized_ = false;
+}
+
+bool AudioProcessor::SetAecEnabled(bool enabled) {
+    return initialized_ && impl_->SetAecEnabled(enabled);
+}
+
+bool AudioProcessor::SetAecSuppressionLevel(int level) {
+    return initialized_ && impl_->SetAecSuppressionLevel(level);
+}
+
+bool AudioProcessor::SetNsEnabled(bool enabled) {
+    return initialized_ && impl_->SetNsEnabled(enabled);
+}
+
+bool AudioProcessor::SetNsSuppressionLevel(int level) {
+    return initialized_ && impl_->SetNsSuppressionLevel(level);
+}
+
+bool AudioProcessor::SetAgcEnabled(bool enabled) {
+    return initialized_ && impl_->SetAgcEnabled(enabled);
+}
+
+bool AudioProcessor::SetAgcMode(int mode) {
+    return initialized_ && impl_->SetAgcMode(mode);
+}
+
+bool AudioProcessor::SetAgcTargetLevel(int targetLevelDbfs) {
+    return initialized_ && impl_->SetAgcTargetLevel(targetLevelDbfs);
+}
+
+bool AudioProcessor::SetVadEnabled(bool enabled) {
+    return initialized_ && impl_->SetVadEnabled(enabled);
+}
+
+bool AudioProcessor::SetDownmixEnabled(bool enabled) {
+    return initialized_ && impl_->SetDownmixEnabled(enabled);
+}
+
+int AudioProcessor::ProcessCaptureFrame(const int16_t* audioData, int size, int16_t* outputData) {
+    if (!initialized_) {
+        if (outputData != audioData) {
+            std::memcpy(outputData, audioData, size * sizeof(int16_t));
+        }
+        return size;
+    }
+    return impl_->ProcessCaptureFrame(audioData, size, outputData);
+}
+
+bool AudioProcessor::LastCaptureSpeech() const {
+    return !initialized_ || impl_->LastCaptureSpeech();
+}
+
+bool AudioProcessor::ProcessRenderFrame(const int16_t* audioData, int size) {
+    return initialized_ && impl_->ProcessRenderFrame(audioData, size);
+}
+
+bool AudioProcessor::GetStats(ProcessingStats* stats) const {
+    if (!initialized_ || !stats) return false;
+    impl_->GetStats(stats);
+    return true;
+}
+
+void AudioProcessor::ResetStats() {
+    if (initialized_) impl_->ResetStats();
+}
+
+int AudioProcessor::ProcessCaptureBatch(const int16_t* capture, int sampleCount,
+                                        const int16_t* render, int renderCount,
+                                        int frameSamples, int16_t* outputData) {
+    // 每帧须含整数个交织帧，否则第一帧之后的声道全部错位
+    if (!capture || !outputData || sampleCount <= 0 || frameSamples <= 0 ||
+        frameSamples % channels_ != 0) {
+        return 0;
+    }
+    if (!initialized_) {
+        return ProcessCaptureFrame(capture, sampleCount, outputData);
+    }
+
+    if (impl_->ClaimLiveOverlapLog()) {
+        LOGE("ProcessCaptureBatch: live capture/render is active; the batch runs on separate state "
+             "and does not see the live render reference");
+    }
+
+    // 批量使用独立的实例：不与实时采集/渲染共享分帧器、处理模块与统计，
+    // 每次调用复制当前配置后从初始状态开始
+    if (!batchImpl_) batchImpl_ = std::make_unique<Impl>();
+    batchImpl_->CopyConfig(*impl_);
+    if (!batchImpl_->Initialize(sampleRate_, channels_)) {
+        return 0;
+    }
+    return batchImpl_->ProcessBatch(capture, sampleCount, render, renderCount, frameSamples, outputData);
+}
+
+} // namespace webrtc_apm
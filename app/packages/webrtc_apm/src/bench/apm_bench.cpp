@@ -0,0 +1,485 @@
+/**
+ * webrtc_apm 主机基准测试与输出回归检查
+ *
+ * 对 8 种 AEC/NS/AGC 开关组合、全开加 VAD 以及立体声（逐声道 / 混音）分别运行 AudioProcessor，
+ * 报告每 10ms 帧的耗时，
+ * 并可与 golden 文件比对输出：
+ *   apm_bench                                    合成语料，只报告耗时
+ *   apm_bench --golden bench/golden.txt          比对输出，超出容差时返回 1
+ *   apm_bench --update-golden bench/golden.txt   重新生成 golden
+ *   apm_bench --capture mic.pcm --render tts.pcm --sample-rate 16000
+ *
+ * 合成语料用固定种子生成，可复现：近端语音 + 经延迟与低通的 TTS 回声 + 背景噪声，
+ * 依次覆盖仅回声、双讲、仅近端三种场景。外部语料为单声道 PCM16 小端裸数据，render 可省略。
+ * 立体声配置把语料复制为两个声道，右声道衰减 6dB；包络只取左声道。
+ *
+ * golden 比对分两级：输出逐位一致（哈希相同）为 identical；否则比较每 100ms 的 RMS 包络，
+ * 最大偏差不超过容差（默认 1dB）视为 SIMD/浮点实现差异导致的 drift，超出则判为回归
+ */
+
+#include "audio_processor.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+using webrtc_apm::AudioProcessor;
+using webrtc_apm::ProcessingStats;
+
+constexpr int kConfigCount = 11;
+constexpr int kEnvelopeMs = 100;
+
+// 包络比较的电平下限（-60dBFS）：更安静的段落只比较是否同样安静
+constexpr double kEnvelopeFloor = 1e-3;
+
+// 开关组合：aec << 2 | ns << 1 | agc，另加 vad << 3、立体声 << 4、混音 << 5
+const int kConfigFlags[kConfigCount] = {0, 1, 2, 3, 4, 5, 6, 7, 15, 23, 55};
+const char* const kConfigNames[kConfigCount] = {
+    "none", "agc", "ns", "ns+agc", "aec", "aec+agc", "aec+ns", "aec+ns+agc", "all+vad",
+    "stereo", "stereo+dmx",
+};
+
+struct Corpus {
+    int sampleRate = 16000;
+    int seconds = 0;            // 合成语料的时长，外部语料为 0
+    std::vector<int16_t> capture;
+    std::vector<int16_t> render;
+};
+
+struct RunResult {
+    double nsPerFrame = 0;
+    uint64_t hash = 0;
+    std::vector<double> envelope;  // 每 100ms 的 RMS（满幅为 1）
+    ProcessingStats stats;
+};
+
+struct GoldenEntry {
+    uint64_t hash = 0;
+    std::vector<double> envelopeDb;
+};
+
+class Random {
+public:
+    explicit Random(uint32_t seed) : state_(seed) {}
+
+    // [-1, 1)
+    float Uniform() {
+        state_ = state_ * 1664525u + 1013904223u;
+        return static_cast<float>(state_ >> 8) / static_cast<float>(1 << 23) - 1.0f;
+    }
+
+private:
+    uint32_t state_;
+};
+
+/**
+ * 类语音信号：基频抖动的声门脉冲串经两个共振峰滤波，按音节开关
+ * @param active 只在 [begin, end) 比例区间内发声
+ */
+std::vector<float> SynthSpeech(int sampleRate, int samples, uint32_t seed, float f0Base,
+                               const std::vector<std::pair<float, float>>& active) {
+    static const float kVowels[][2] = {{700, 1200}, {300, 2300}, {500, 1500}, {350, 800}, {600, 1900}};
+    Random random(seed);
+    std::vector<float> out(samples, 0.0f);
+
+    int pos = 0;
+    while (pos < samples) {
+        int syllable = sampleRate * (200 + static_cast<int>((random.Uniform() + 1.0f) * 50)) / 1000;
+        int gap = sampleRate * (40 + static_cast<int>((random.Uniform() + 1.0f) * 40)) / 1000;
+        const float* vowel = kVowels[static_cast<int>((random.Uniform() + 1.0f) * 2.5f) % 5];
+        float f0 = f0Base * (1.0f + 0.15f * random.Uniform());
+
+        // 两个二阶谐振器：y = x + 2r·cos(w)·y1 - r²·y2
+        float r = 0.97f;
+        float c1 = 2 * r * std::cos(2 * static_cast<float>(M_PI) * vowel[0] / sampleRate);
+        float c2 = 2 * r * std::cos(2 * static_cast<float>(M_PI) * vowel[1] / sampleRate);
+        float a1 = 0, b1 = 0, a2 = 0, b2 = 0;
+        float phase = 0;
+
+        for (int i = 0; i < syllable && pos + i < samples; ++i) {
+            float t = static_cast<float>(pos + i) / samples;
+            bool on = false;
+            for (const auto& range : active) on |= t >= range.first && t < range.second;
+            if (!on) continue;
+
+            // 基频缓慢滑动，脉冲之间叠加少量气声
+            phase += (f0 * (1.0f + 0.05f * std::sin(6.0f * i / sampleRate))) / sampleRate;
+            float excitation = 0.02f * random.Uniform();
+            if (phase >= 1.0f) {
+                phase -= 1.0f;
+                excitation += 1.0f;
+            }
+            float y1 = excitation + c1 * a1 - r * r * b1;
+            b1 = a1;
+            a1 = y1;
+            float y2 = y1 + c2 * a2 - r * r * b2;
+            b2 = a2;
+            a2 = y2;
+
+            // 音节包络：升余弦起止
+            float envelope = std::sin(static_cast<float>(M_PI) * i / syllable);
+            out[pos + i] = y2 * envelope;
+        }
+        pos += syllable + gap;
+    }
+
+    float peak = 1e-6f;
+    for (float v : out) peak = std::max(peak, std::fabs(v));
+    for (float& v : out) v *= 0.3f / peak;
+    return out;
+}
+
+int16_t ToPcm(float v) {
+    return static_cast<int16_t>(std::lrint(std::clamp(v, -1.0f, 32767.0f / 32768.0f) * 32768.0f));
+}
+
+/**
+ * 合成语料：前半段 TTS 单讲，中段双讲，后段近端单讲并再次出现 TTS
+ */
+Corpus SynthCorpus(int sampleRate, int seconds) {
+    Corpus corpus;
+    corpus.sampleRate = sampleRate;
+    corpus.seconds = seconds;
+    int samples = sampleRate * seconds;
+
+    std::vector<float> far = SynthSpeech(sampleRate, samples, 1, 190.0f, {{0.0f, 0.5f}, {0.75f, 1.0f}});
+    std::vector<float> near = SynthSpeech(sampleRate, samples, 2, 120.0f, {{0.4f, 1.0f}});
+
+    // 回声路径：48ms 延迟 + 单极点低通 + 0.4 倍衰减
+    int delay = sampleRate * 48 / 1000;
+    Random noise(3);
+    float echoState = 0;
+    float noiseState = 0;
+
+    corpus.capture.resize(samples);
+    corpus.render.resize(samples);
+    for (int i = 0; i < samples; ++i) {
+        corpus.render[i] = ToPcm(far[i]);
+        float echoInput = i >= delay ? far[i - delay] : 0.0f;
+        echoState = 0.6f * echoState + 0.4f * echoInput;
+        noiseState = 0.7f * noiseState + 0.3f * noise.Uniform();
+        corpus.capture[i] = ToPcm(0.5f * near[i] + 0.4f * echoState + 0.01f * noiseState);
+    }
+    return corpus;
+}
+
+bool ReadPcm(const std::string& path, std::vector<int16_t>* samples) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) return false;
+    std::vector<char> bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    samples->resize(bytes.size() / 2);
+    for (size_t i = 0; i < samples->size(); ++i) {
+        (*samples)[i] = static_cast<int16_t>(static_cast<uint8_t>(bytes[2 * i]) |
+                                             (static_cast<uint8_t>(bytes[2 * i + 1]) << 8));
+    }
+    return true;
+}
+
+uint64_t Fnv1a(const int16_t* data, size_t count) {
+    uint64_t hash = 0xcbf29ce484222325ull;
+    const auto* bytes = reinterpret_cast<const uint8_t*>(data);
+    for (size_t i = 0; i < count * sizeof(int16_t); ++i) {
+        hash ^= bytes[i];
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+
+std::vector<double> Envelope(const std::vector<int16_t>& samples, int sampleRate) {
+    std::vector<double> envelope;
+    size_t window = static_cast<size_t>(sampleRate) * kEnvelopeMs / 1000;
+    for (size_t start = 0; start + window <= samples.size(); start += window) {
+        double energy = 0;
+        for (size_t i = start; i < start + window; ++i) {
+            double v = samples[i] / 32768.0;
+            energy += v * v;
+        }
+        envelope.push_back(std::sqrt(energy / window));
+    }
+    return envelope;
+}
+
+double ToDb(double rms) {
+    return 20.0 * std::log10(std::max(rms, 1e-5));
+}
+
+/**
+ * 单声道复制为立体声，右声道衰减 6dB，使两个声道的处理状态不同
+ */
+std::vector<int16_t> ToStereo(const std::vector<int16_t>& mono) {
+    std::vector<int16_t> stereo(mono.size() * 2);
+    for (size_t i = 0; i < mono.size(); ++i) {
+        stereo[2 * i] = mono[i];
+        stereo[2 * i + 1] = static_cast<int16_t>(mono[i] / 2);
+    }
+    return stereo;
+}
+
+/**
+ * 按 10ms 帧运行一种配置：每帧先送参考信号再处理采集，与实时路径的时序一致。
+ * 每轮使用新的处理器，耗时取各轮最小值
+ */
+bool Run(const Corpus& corpus, int config, int iterations, RunResult* result) {
+    int flags = kConfigFlags[config];
+    int channels = (flags & 16) ? 2 : 1;
+    std::vector<int16_t> stereoCapture, stereoRender;
+    if (channels == 2) {
+        stereoCapture = ToStereo(corpus.capture);
+        stereoRender = ToStereo(corpus.render);
+    }
+    const std::vector<int16_t>& capture = channels == 2 ? stereoCapture : corpus.capture;
+    const std::vector<int16_t>& render = channels == 2 ? stereoRender : corpus.render;
+
+    int frame = corpus.sampleRate / 100 * channels;
+    int frames = static_cast<int>(capture.size()) / frame;
+    std::vector<int16_t> output(static_cast<size_t>(frames) * frame);
+    double bestNs = 0;
+
+    for (int iteration = 0; iteration < iterations; ++iteration) {
+        AudioProcessor processor;
+        if (!processor.Initialize(corpus.sampleRate, channels)) return false;
+        processor.SetAecEnabled((flags & 4) != 0);
+        processor.SetNsEnabled((flags & 2) != 0);
+        processor.SetAgcEnabled((flags & 1) != 0);
+        processor.SetVadEnabled((flags & 8) != 0);
+        processor.SetDownmixEnabled((flags & 32) != 0);
+
+        auto start = std::chrono::steady_clock::now();
+        for (int f = 0; f < frames; ++f) {
+            size_t offset = static_cast<size_t>(f) * frame;
+            if (offset + frame <= render.size()) {
+                processor.ProcessRenderFrame(render.data() + offset, frame);
+            }
+            processor.ProcessCaptureFrame(capture.data() + offset, frame, output.data() + offset);
+        }
+        double elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        if (iteration == 0 || elapsed < bestNs) bestNs = elapsed;
+        if (iteration == iterations - 1) processor.GetStats(&result->stats);
+    }
+
+    result->nsPerFrame = bestNs / frames;
+    result->hash = Fnv1a(output.data(), output.size());
+    if (channels > 1) {
+        std::vector<int16_t> left(output.size() / channels);
+        for (size_t i = 0; i < left.size(); ++i) left[i] = output[i * channels];
+        result->envelope = Envelope(left, corpus.sampleRate);
+    } else {
+        result->envelope = Envelope(output, corpus.sampleRate);
+    }
+    return true;
+}
+
+std::string CorpusLine(const Corpus& corpus) {
+    char line[96];
+    std::snprintf(line, sizeof(line), "corpus synthetic seconds=%d sample_rate=%d", corpus.seconds, corpus.sampleRate);
+    return line;
+}
+
+bool ReadGolden(const std::string& path, const Corpus& corpus, std::vector<GoldenEntry>* entries) {
+    std::ifstream file(path);
+    if (!file) {
+        std::fprintf(stderr, "cannot open golden file %s\n", path.c_str());
+        return false;
+    }
+    entries->assign(kConfigCount, GoldenEntry());
+    std::vector<bool> seen(kConfigCount, false);
+    bool corpusMatches = false;
+
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        if (line.rfind("corpus ", 0) == 0) {
+            corpusMatches = line == CorpusLine(corpus);
+            continue;
+        }
+        std::istringstream fields(line);
+        int config = -1;
+        std::string hash;
+        fields >> config >> hash;
+        if (config < 0 || config >= kConfigCount) continue;
+        GoldenEntry& entry = (*entries)[config];
+        entry.hash = std::strtoull(hash.c_str(), nullptr, 16);
+        double db;
+        while (fields >> db) entry.envelopeDb.push_back(db);
+        seen[config] = true;
+    }
+
+    if (!corpusMatches) {
+        std::fprintf(stderr, "golden file was generated for a different corpus (expected \"%s\")\n",
+                     CorpusLine(corpus).c_str());
+        return false;
+    }
+    if (std::find(seen.begin(), seen.end(), false) != seen.end()) {
+        std::fprintf(stderr, "golden file is missing configurations\n");
+        return false;
+    }
+    return true;
+}
+
+bool WriteGolden(const std::string& path, const Corpus& corpus, const std::vector<RunResult>& results) {
+    std::ofstream file(path);
+    if (!file) return false;
+    file << "# apm_bench golden output, regenerate with: apm_bench --update-golden <path>\n";
+    file << "# <config index: none agc ns ns+agc aec aec+agc aec+ns aec+ns+agc all+vad stereo stereo+dmx> <fnv1a64 of output> <RMS per " << kEnvelopeMs << "ms in dBFS>\n";
+    file << CorpusLine(corpus) << "\n";
+    for (int config = 0; config < kConfigCount; ++config) {
+        char hash[24];
+        std::snprintf(hash, sizeof(hash), "%016llx", static_cast<unsigned long long>(results[config].hash));
+        file << config << " " << hash;
+        for (double rms : results[config].envelope) {
+            char db[16];
+            std::snprintf(db, sizeof(db), " %.2f", ToDb(rms));
+            file << db;
+        }
+        file << "\n";
+    }
+    return static_cast<bool>(file);
+}
+
+/**
+ * 与 golden 比对，返回包络的最大偏差（dB）；长度不一致时返回无穷大
+ */
+double EnvelopeDrift(const RunResult& result, const GoldenEntry& golden) {
+    if (result.envelope.size() != golden.envelopeDb.size()) return INFINITY;
+    double drift = 0;
+    for (size_t i = 0; i < result.envelope.size(); ++i) {
+        double expected = std::pow(10.0, golden.envelopeDb[i] / 20.0);
+        double diff = std::fabs(ToDb(result.envelope[i] + kEnvelopeFloor) - ToDb(expected + kEnvelopeFloor));
+        drift = std::max(drift, diff);
+    }
+    return drift;
+}
+
+void PrintUsage() {
+    std::fprintf(stderr,
+        "usage: apm_bench [options]\n"
+        "  --seconds N           synthetic corpus length (default 10)\n"
+        "  --sample-rate HZ      corpus sample rate (default 16000)\n"
+        "  --capture FILE        raw mono PCM16 LE capture corpus instead of the synthetic one\n"
+        "  --render FILE         raw mono PCM16 LE reference signal for --capture\n"
+        "  --iterations N        runs per configuration, fastest is reported (default 5)\n"
+        "  --golden FILE         compare outputs against FILE, exit 1 on regression\n"
+        "  --update-golden FILE  write current outputs to FILE\n"
+        "  --tolerance DB        max envelope drift accepted by --golden (default 1.0)\n");
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int seconds = 10;
+    int sampleRate = 16000;
+    int iterations = 5;
+    double tolerance = 1.0;
+    std::string capturePath, renderPath, goldenPath, updatePath;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--seconds" && hasValue) seconds = std::atoi(argv[++i]);
+        else if (arg == "--sample-rate" && hasValue) sampleRate = std::atoi(argv[++i]);
+        else if (arg == "--capture" && hasValue) capturePath = argv[++i];
+        else if (arg == "--render" && hasValue) renderPath = argv[++i];
+        else if (arg == "--iterations" && hasValue) iterations = std::atoi(argv[++i]);
+        else if (arg == "--golden" && hasValue) goldenPath = argv[++i];
+        else if (arg == "--update-golden" && hasValue) updatePath = argv[++i];
+        else if (arg == "--tolerance" && hasValue) tolerance = std::atof(argv[++i]);
+        else {
+            PrintUsage();
+            return 2;
+        }
+    }
+    if (seconds <= 0 || sampleRate <= 0 || iterations <= 0) {
+        PrintUsage();
+        return 2;
+    }
+
+    Corpus corpus;
+    if (capturePath.empty()) {
+        corpus = SynthCorpus(sampleRate, seconds);
+    } else {
+        corpus.sampleRate = sampleRate;
+        if (!ReadPcm(capturePath, &corpus.capture) ||
+            (!renderPath.empty() && !ReadPcm(renderPath, &corpus.render))) {
+            std::fprintf(stderr, "cannot read corpus\n");
+            return 2;
+        }
+        if (!goldenPath.empty() || !updatePath.empty()) {
+            std::fprintf(stderr, "golden files are only defined for the synthetic corpus\n");
+            return 2;
+        }
+    }
+    if (corpus.capture.size() < static_cast<size_t>(sampleRate / 100)) {
+        std::fprintf(stderr, "corpus is shorter than one frame\n");
+        return 2;
+    }
+
+    std::vector<GoldenEntry> golden;
+    if (!goldenPath.empty() && !ReadGolden(goldenPath, corpus, &golden)) {
+        return 2;
+    }
+
+    double audioSeconds = static_cast<double>(corpus.capture.size()) / corpus.sampleRate;
+    std::printf("corpus: %.1f s at %d Hz%s, %d iterations\n", audioSeconds, corpus.sampleRate,
+                corpus.render.empty() ? " (no render)" : "", iterations);
+    std::printf("%-11s %9s %9s %21s %21s  %-16s %s\n", "config", "ns/frame", "realtime",
+                "chain p50/p99 (us)", "aec/ns/agc p50 (us)", "output hash", goldenPath.empty() ? "" : "golden");
+
+    std::vector<RunResult> results(kConfigCount);
+    bool regression = false;
+    for (int config = 0; config < kConfigCount; ++config) {
+        RunResult& result = results[config];
+        if (!Run(corpus, config, iterations, &result)) {
+            std::fprintf(stderr, "failed to initialize processor\n");
+            return 2;
+        }
+
+        std::string verdict;
+        if (!golden.empty()) {
+            if (result.hash == golden[config].hash) {
+                verdict = "identical";
+            } else {
+                double drift = EnvelopeDrift(result, golden[config]);
+                char text[48];
+                std::snprintf(text, sizeof(text), "%s drift %.2f dB", drift <= tolerance ? "ok" : "FAIL", drift);
+                verdict = text;
+                regression |= drift > tolerance;
+            }
+        }
+
+        const ProcessingStats& s = result.stats;
+        char chain[32], stages[32];
+        std::snprintf(chain, sizeof(chain), "%d / %d", s.total.p50Us, s.total.p99Us);
+        std::snprintf(stages, sizeof(stages), "%d / %d / %d", s.aec.p50Us, s.ns.p50Us, s.agc.p50Us);
+        std::printf("%-11s %9.0f %8.0fx %21s %21s  %016llx %s\n", kConfigNames[config], result.nsPerFrame,
+                    10e6 / result.nsPerFrame, chain, stages,
+                    static_cast<unsigned long long>(result.hash), verdict.c_str());
+        if (kConfigFlags[config] & 8) {
+            std::printf("%-11s %llu/%llu blocks processed as speech, vad p50 %d us\n", "",
+                        static_cast<unsigned long long>(s.speechBlocks),
+                        static_cast<unsigned long long>(s.captureBlocks), s.vad.p50Us);
+        }
+    }
+
+    if (!updatePath.empty()) {
+        if (!WriteGolden(updatePath, corpus, results)) {
+            std::fprintf(stderr, "cannot write %s\n", updatePath.c_str());
+            return 2;
+        }
+        std::printf("golden written to %s\n", updatePath.c_str());
+    }
+    if (regression) {
+        std::printf("output regression beyond %.2f dB\n", tolerance);
+        return 1;
+    }
+    return 0;
+}
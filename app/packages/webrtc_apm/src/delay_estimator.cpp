@@ -0,0 +1,150 @@
+#include "delay_estimator.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace webrtc_apm {
+
+namespace {
+    // 互功率谱的时间平滑系数
+    constexpr float kCrossSmoothing = 0.7f;
+
+    // 峰值与平均幅度之比的门限
+    constexpr float kPeakRatio = 6.0f;
+
+    // 窗口能量门限（归一化信号，低于此值视为静音）
+    constexpr float kMinWindowEnergy = 1e-4f;
+
+    // 相邻两次估计允许的偏差（抽取后的样本数）
+    constexpr int kStableTolerance = 1;
+
+    // 估计间隔
+    constexpr int kEstimateIntervalMs = 64;
+}
+
+bool DelayEstimator::Initialize(int sampleRate, int blockSize, int maxDelayMs) {
+    if (blockSize % kDecimation != 0) return false;
+
+    int maxDelay = sampleRate / 1000 * maxDelayMs / kDecimation;
+    int length = 4;
+    while (length < 2 * maxDelay) length <<= 1;
+    if (!fft_.Init(length)) return false;
+
+    length_ = length;
+    window_ = length / 2;
+    blockSize_ = blockSize;
+    blocksPerEstimate_ = std::max(1, sampleRate / 1000 * kEstimateIntervalMs / blockSize);
+
+    int bins = fft_.Bins();
+    renderHistory_.assign(length_, 0.0f);
+    captureHistory_.assign(length_, 0.0f);
+    time_.assign(length_, 0.0f);
+    renderRe_.assign(bins, 0.0f);
+    renderIm_.assign(bins, 0.0f);
+    captureRe_.assign(bins, 0.0f);
+    captureIm_.assign(bins, 0.0f);
+    crossRe_.assign(bins, 0.0f);
+    crossIm_.assign(bins, 0.0f);
+
+    Reset();
+    return true;
+}
+
+void DelayEstimator::Reset() {
+    std::fill(renderHistory_.begin(), renderHistory_.end(), 0.0f);
+    std::fill(captureHistory_.begin(), captureHistory_.end(), 0.0f);
+    std::fill(crossRe_.begin(), crossRe_.end(), 0.0f);
+    std::fill(crossIm_.begin(), crossIm_.end(), 0.0f);
+    writePos_ = 0;
+    blockCount_ = 0;
+    delay_ = -1;
+    candidate_ = -1;
+}
+
+bool DelayEstimator::Update(const float* render, const float* capture) {
+    if (length_ == 0) return false;
+
+    // 4 点平均抽取
+    for (int i = 0; i < blockSize_; i += kDecimation) {
+        float r = 0.0f, c = 0.0f;
+        for (int j = 0; j < kDecimation; ++j) {
+            r += render[i + j];
+            c += capture[i + j];
+        }
+        renderHistory_[writePos_] = r;
+        captureHistory_[writePos_] = c;
+        writePos_ = (writePos_ + 1) & (length_ - 1);
+    }
+
+    if (++blockCount_ < blocksPerEstimate_) return false;
+    blockCount_ = 0;
+
+    int previous = delay_;
+    Estimate();
+    return delay_ != previous;
+}
+
+void DelayEstimator::Estimate() {
+    float* t = time_.data();
+    int bins = fft_.Bins();
+
+    // 渲染窗口：最近 length_ 个样本，按时间顺序展开
+    float renderEnergy = 0.0f;
+    for (int i = 0; i < length_; ++i) {
+        float v = renderHistory_[(writePos_ + i) & (length_ - 1)];
+        t[i] = v;
+        renderEnergy += v * v;
+    }
+    fft_.Forward(t, renderRe_.data(), renderIm_.data());
+
+    // 采集窗口：最近 window_ 个样本放在前半部分，后半补零
+    float captureEnergy = 0.0f;
+    int start = writePos_ - window_;
+    for (int i = 0; i < window_; ++i) {
+        float v = captureHistory_[(start + i) & (length_ - 1)];
+        t[i] = v;
+        captureEnergy += v * v;
+    }
+    std::memset(t + window_, 0, window_ * sizeof(float));
+
+    if (renderEnergy < kMinWindowEnergy || captureEnergy < kMinWindowEnergy) return;
+
+    fft_.Forward(t, captureRe_.data(), captureIm_.data());
+
+    // 平滑 conj(C) * R，再做 PHAT 加权
+    for (int k = 0; k < bins; ++k) {
+        float cr = captureRe_[k], ci = captureIm_[k];
+        float rr = renderRe_[k], ri = renderIm_[k];
+        float xr = cr * rr + ci * ri;
+        float xi = cr * ri - ci * rr;
+        crossRe_[k] = kCrossSmoothing * crossRe_[k] + (1.0f - kCrossSmoothing) * xr;
+        crossIm_[k] = kCrossSmoothing * crossIm_[k] + (1.0f - kCrossSmoothing) * xi;
+
+        float magnitude = std::sqrt(crossRe_[k] * crossRe_[k] + crossIm_[k] * crossIm_[k]) + 1e-12f;
+        renderRe_[k] = crossRe_[k] / magnitude;
+        renderIm_[k] = crossIm_[k] / magnitude;
+    }
+    fft_.Inverse(renderRe_.data(), renderIm_.data(), t);
+
+    // t[k] = sum c[j] * r[j + k]；延迟 d 对应 k = window_ - d
+    int peak = 0;
+    float peakValue = t[0];
+    float sumAbs = 0.0f;
+    for (int k = 0; k <= window_; ++k) {
+        sumAbs += std::fabs(t[k]);
+        if (t[k] > peakValue) {
+            peakValue = t[k];
+            peak = k;
+        }
+    }
+    float meanAbs = sumAbs / (window_ + 1);
+    if (peakValue < kPeakRatio * meanAbs) return;
+
+    int estimate = window_ - peak;
+    if (candidate_ >= 0 && std::abs(estimate - candidate_) <= kStableTolerance) {
+        delay_ = estimate * kDecimation;
+    }
+    candidate_ = estimate;
+}
+
+} // namespace webrtc_apm
@@ -0,0 +1,66 @@
+#ifndef DELAY_ESTIMATOR_H
+#define DELAY_ESTIMATOR_H
+
+#include "fft.h"
+#include <vector>
+
+namespace webrtc_apm {
+
+/**
+ * 渲染/采集信号延迟估计
+ *
+ * 将两路信号 4 倍抽取后，用 FFT 计算经时间平滑的 GCC-PHAT 互相关，
+ * 取峰值作为延迟。峰值需足够突出且连续两次一致才会采纳，
+ * 避免短暂的双讲或静音导致估计跳变。
+ */
+class DelayEstimator {
+public:
+    /**
+     * @param sampleRate 采样率
+     * @param blockSize 每次 Update 的样本数（需为 4 的倍数）
+     * @param maxDelayMs 可估计的最大延迟
+     */
+    bool Initialize(int sampleRate, int blockSize, int maxDelayMs);
+    void Reset();
+
+    /**
+     * 输入一块渲染与采集信号（浮点，已归一化）
+     * @return 采纳了新的延迟估计时返回 true
+     */
+    bool Update(const float* render, const float* capture);
+
+    /**
+     * 当前延迟（全采样率下的样本数），尚无估计时为 -1
+     */
+    int DelaySamples() const { return delay_; }
+
+private:
+    static constexpr int kDecimation = 4;
+
+    void Estimate();
+
+    Fft fft_;
+    int length_ = 0;        // FFT 长度（抽取后），渲染窗口长度
+    int window_ = 0;        // 采集窗口长度 = length_ / 2
+    int blockSize_ = 0;
+    int blocksPerEstimate_ = 0;
+    int blockCount_ = 0;
+
+    // 抽取后的循环历史
+    std::vector<float> renderHistory_;
+    std::vector<float> captureHistory_;
+    int writePos_ = 0;
+
+    // 工作缓冲区
+    std::vector<float> time_;
+    std::vector<float> renderRe_, renderIm_;
+    std::vector<float> captureRe_, captureIm_;
+    std::vector<float> crossRe_, crossIm_;  // 平滑后的互功率谱
+
+    int delay_ = -1;
+    int candidate_ = -1;
+};
+
+} // namespace webrtc_apm
+
+#endif // DELAY_ESTIMATOR_H
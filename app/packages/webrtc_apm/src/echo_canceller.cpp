@@ -0,0 +1,298 @@
+#include "echo_canceller.h"
+#include "audio_kernels.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace webrtc_apm {
+
+namespace {
+    // 滤波器覆盖的回声尾长与可估计的最大整体延迟
+    constexpr int kFilterLengthMs = 48;
+    constexpr int kMaxDelayMs = 250;
+
+    // NLMS 步长与参考信号功率平滑系数
+    constexpr float kStepSize = 0.5f;
+    constexpr float kPowerSmoothing = 0.9f;
+    constexpr float kPowerFloor = 1e-6f;
+    constexpr float kRegularization = 0.01f;
+
+    // 参考块能量低于此值时不更新滤波器
+    constexpr float kMinFarEnergy = 1e-6f;
+
+    // 收敛阶段（有参考信号的前 2 秒）使用全步长，之后按回声/误差能量比缩放步长，
+    // 近端说话（双讲）时误差远大于回声估计，步长随之减小，避免滤波器被扰乱
+    constexpr int kConvergenceMs = 2000;
+    constexpr float kMinStepScale = 0.05f;
+
+    // 延迟变化超过此值（以 block 计）时重置滤波器
+    constexpr int kDelayChangeBlocks = 1;
+
+    // 对齐时提前取参考信号的余量，保证回声路径起点落在滤波器内
+    constexpr int kDelayMarginBlocks = 2;
+
+    // 抑制级别对应的残余回声比例与最小增益（low, moderate, high）
+    constexpr float kLeak[] = {0.05f, 0.1f, 0.2f};
+    constexpr float kMinGain[] = {0.3f, 0.15f, 0.05f};
+
+    // 增益下降快、恢复慢
+    constexpr float kGainAttack = 0.5f;
+    constexpr float kGainRelease = 0.05f;
+
+    constexpr float kInt16Scale = 1.0f / 32768.0f;
+}
+
+bool EchoCanceller::Initialize(int sampleRate) {
+    if (sampleRate <= 0) return false;
+
+    // 约 4ms 的 2 的幂分块
+    int block = 32;
+    while (block < sampleRate / 250) block <<= 1;
+    if (!fft_.Init(2 * block)) return false;
+    if (!delayEstimator_.Initialize(sampleRate, block, kMaxDelayMs)) return false;
+
+    block_ = block;
+    bins_ = block + 1;
+    int filterSamples = sampleRate / 1000 * kFilterLengthMs;
+    partitions_ = std::max(1, (filterSamples + block - 1) / block);
+    convergenceBlocks_ = sampleRate / 1000 * kConvergenceMs / block;
+
+    captureBlock_.assign(block_, 0.0f);
+    renderBlock_.assign(block_, 0.0f);
+    outputBlock_.assign(block_, 0.0f);
+
+    int history = 1;
+    int maxDelay = sampleRate / 1000 * kMaxDelayMs;
+    while (history < maxDelay + 2 * block_) history <<= 1;
+    renderHistory_.assign(history, 0.0f);
+    historyMask_ = history - 1;
+
+    farRe_.assign(partitions_ * bins_, 0.0f);
+    farIm_.assign(partitions_ * bins_, 0.0f);
+    weightRe_.assign(partitions_ * bins_, 0.0f);
+    weightIm_.assign(partitions_ * bins_, 0.0f);
+    farPower_.assign(bins_, 0.0f);
+
+    aligned_.assign(block_, 0.0f);
+    farTime_.assign(2 * block_, 0.0f);
+    time_.assign(2 * block_, 0.0f);
+    specRe_.assign(bins_, 0.0f);
+    specIm_.assign(bins_, 0.0f);
+    errRe_.assign(bins_, 0.0f);
+    errIm_.assign(bins_, 0.0f);
+
+    Reset();
+    return true;
+}
+
+void EchoCanceller::Reset() {
+    std::fill(captureBlock_.begin(), captureBlock_.end(), 0.0f);
+    std::fill(renderBlock_.begin(), renderBlock_.end(), 0.0f);
+    std::fill(outputBlock_.begin(), outputBlock_.end(), 0.0f);
+    std::fill(renderHistory_.begin(), renderHistory_.end(), 0.0f);
+    fill_ = 0;
+    historyPos_ = 0;
+    delay_ = 0;
+    gain_ = 1.0f;
+    delayEstimator_.Reset();
+    ResetFilter();
+}
+
+void EchoCanceller::ResetFilter() {
+    std::fill(farRe_.begin(), farRe_.end(), 0.0f);
+    std::fill(farIm_.begin(), farIm_.end(), 0.0f);
+    std::fill(weightRe_.begin(), weightRe_.end(), 0.0f);
+    std::fill(weightIm_.begin(), weightIm_.end(), 0.0f);
+    std::fill(farPower_.begin(), farPower_.end(), 0.0f);
+    std::fill(farTime_.begin(), farTime_.end(), 0.0f);
+    farIndex_ = 0;
+    constrainIndex_ = 0;
+    adaptedBlocks_ = 0;
+}
+
+void EchoCanceller::SetSuppressionLevel(int level) {
+    level = std::clamp(level, 0, 2);
+    leak_ = kLeak[level];
+    minGain_ = kMinGain[level];
+}
+
+void EchoCanceller::Process(const int16_t* capture, int16_t* out, int count, const int16_t* render, int renderCount) {
+    if (block_ == 0) return;
+
+    // 逐段填充 block，输出上一 block 的结果（固定延迟 block_ 个样本）
+    int i = 0;
+    while (i < count) {
+        int n = std::min(count - i, block_ - fill_);
+        int rendered = std::clamp(renderCount - i, 0, n);
+
+        dsp::Int16ToFloat(capture + i, captureBlock_.data() + fill_, n, kInt16Scale);
+        dsp::Int16ToFloat(render + i, renderBlock_.data() + fill_, rendered, kInt16Scale);
+        std::fill(renderBlock_.begin() + fill_ + rendered, renderBlock_.begin() + fill_ + n, 0.0f);
+        dsp::FloatToInt16(outputBlock_.data() + fill_, out + i, n, 32768.0f);
+
+        fill_ += n;
+        i += n;
+
+        if (fill_ == block_) {
+            ProcessBlock();
+            fill_ = 0;
+        }
+    }
+}
+
+void EchoCanceller::ProcessBlock() {
+    // 记录参考信号历史
+    for (int i = 0; i < block_; ++i) {
+        renderHistory_[(historyPos_ + i) & historyMask_] = renderBlock_[i];
+    }
+    historyPos_ = (historyPos_ + block_) & historyMask_;
+
+    // 延迟估计发生明显变化时，重新对齐并重置滤波器
+    if (delayEstimator_.Update(renderBlock_.data(), captureBlock_.data())) {
+        int estimate = std::max(0, delayEstimator_.DelaySamples() - kDelayMarginBlocks * block_);
+        if (std::abs(estimate - delay_) > kDelayChangeBlocks * block_) {
+            delay_ = estimate;
+            ResetFilter();
+        }
+    }
+
+    // 取延迟 delay_ 之前的参考块
+    int start = historyPos_ - block_ - delay_;
+    for (int i = 0; i < block_; ++i) {
+        aligned_[i] = renderHistory_[(start + i) & historyMask_];
+    }
+
+    AdaptiveFilter(aligned_.data(), captureBlock_.data(), outputBlock_.data());
+}
+
+void EchoCanceller::AdaptiveFilter(const float* far, const float* near, float* out) {
+    const int bins = bins_;
+
+    // 参考频谱：FFT([上一块, 当前块])，写入环形分块
+    std::memmove(farTime_.data(), farTime_.data() + block_, block_ * sizeof(float));
+    std::memcpy(farTime_.data() + block_, far, block_ * sizeof(float));
+    farIndex_ = (farIndex_ + partitions_ - 1) % partitions_;
+    float* curRe = farRe_.data() + farIndex_ * bins;
+    float* curIm = farIm_.data() + farIndex_ * bins;
+    fft_.Forward(farTime_.data(), curRe, curIm);
+
+    float farEnergy = 0.0f;
+    for (int i = 0; i < block_; ++i) farEnergy += far[i] * far[i];
+
+    // 回声估计 Y = sum_p W_p * X_{n-p}
+    std::fill(specRe_.begin(), specRe_.end(), 0.0f);
+    std::fill(specIm_.begin(), specIm_.end(), 0.0f);
+    for (int p = 0; p < partitions_; ++p) {
+        int slot = (farIndex_ + p) % partitions_;
+        const float* xr = farRe_.data() + slot * bins;
+        const float* xi = farIm_.data() + slot * bins;
+        const float* wr = weightRe_.data() + p * bins;
+        const float* wi = weightIm_.data() + p * bins;
+        for (int k = 0; k < bins; ++k) {
+            specRe_[k] += wr[k] * xr[k] - wi[k] * xi[k];
+            specIm_[k] += wr[k] * xi[k] + wi[k] * xr[k];
+        }
+    }
+    fft_.Inverse(specRe_.data(), specIm_.data(), time_.data());
+
+    // 误差 e = d - y（overlap-save 取后半）
+    const float* echo = time_.data() + block_;
+    float echoEnergy = 0.0f, errorEnergy = 0.0f, nearEnergy = 0.0f;
+    for (int i = 0; i < block_; ++i) {
+        out[i] = near[i] - echo[i];
+        echoEnergy += echo[i] * echo[i];
+        errorEnergy += out[i] * out[i];
+        nearEnergy += near[i] * near[i];
+    }
+
+    // 线性滤波器使信号变差（发散或双讲突变）时，本块输出原始信号
+    bool diverged = errorEnergy > nearEnergy;
+
+    if (farEnergy > kMinFarEnergy) {
+        // 误差频谱 E = FFT([0, e])
+        std::memset(time_.data(), 0, block_ * sizeof(float));
+        std::memcpy(time_.data() + block_, out, block_ * sizeof(float));
+        fft_.Forward(time_.data(), errRe_.data(), errIm_.data());
+
+        float stepScale = 1.0f;
+        if (adaptedBlocks_ < convergenceBlocks_) {
+            ++adaptedBlocks_;
+        } else {
+            stepScale = std::max(kMinStepScale, echoEnergy / (echoEnergy + errorEnergy + 1e-12f));
+        }
+
+        float totalPower = 0.0f;
+        for (int k = 0; k < bins; ++k) {
+            float power = curRe[k] * curRe[k] + curIm[k] * curIm[k];
+            farPower_[k] = farPower_[k] > 0.0f
+                ? kPowerSmoothing * farPower_[k] + (1.0f - kPowerSmoothing) * power
+                : power;
+            totalPower += farPower_[k];
+        }
+
+        // 正则项随参考信号平均功率变化：窄带参考（如纯音）下几乎无能量的频点不至于步长失控
+        float regularization = kRegularization * totalPower / bins + kPowerFloor;
+
+        for (int k = 0; k < bins; ++k) {
+            // 按全部分块的参考功率归一化（各分块的更新叠加作用于同一误差）
+            float mu = stepScale * kStepSize / (partitions_ * (farPower_[k] + regularization));
+            errRe_[k] *= mu;
+            errIm_[k] *= mu;
+        }
+
+        // W_p += mu * conj(X_{n-p}) * E
+        for (int p = 0; p < partitions_; ++p) {
+            int slot = (farIndex_ + p) % partitions_;
+            const float* xr = farRe_.data() + slot * bins;
+            const float* xi = farIm_.data() + slot * bins;
+            float* wr = weightRe_.data() + p * bins;
+            float* wi = weightIm_.data() + p * bins;
+            for (int k = 0; k < bins; ++k) {
+                wr[k] += xr[k] * errRe_[k] + xi[k] * errIm_[k];
+                wi[k] += xr[k] * errIm_[k] - xi[k] * errRe_[k];
+            }
+        }
+
+        // 轮流对一个分块施加梯度约束：权重时域后半置零
+        float* wr = weightRe_.data() + constrainIndex_ * bins;
+        float* wi = weightIm_.data() + constrainIndex_ * bins;
+        fft_.Inverse(wr, wi, time_.data());
+        std::memset(time_.data() + block_, 0, block_ * sizeof(float));
+        fft_.Forward(time_.data(), wr, wi);
+        constrainIndex_ = (constrainIndex_ + 1) % partitions_;
+    }
+
+    if (diverged) {
+        std::memcpy(out, near, block_ * sizeof(float));
+        errorEnergy = nearEnergy;
+    }
+
+    ApplySuppression(out, echoEnergy, errorEnergy);
+}
+
+/**
+ * 残余回声宽带抑制
+ *
+ * 假设线性滤波后仍残留 leak_ 比例的回声，按残余回声占误差信号能量的比例降低增益。
+ * 增益逐样本插值，避免块边界处的跳变。
+ */
+void EchoCanceller::ApplySuppression(float* out, float echoEnergy, float errorEnergy) {
+    float target = 1.0f;
+    if (errorEnergy > 1e-9f) {
+        float residual = leak_ * echoEnergy;
+        target = std::max(minGain_, 1.0f - residual / errorEnergy);
+    }
+
+    float rate = target < gain_ ? kGainAttack : kGainRelease;
+    float next = gain_ + rate * (target - gain_);
+    float step = (next - gain_) / block_;
+
+    float g = gain_;
+    for (int i = 0; i < block_; ++i) {
+        g += step;
+        out[i] *= g;
+    }
+    gain_ = next;
+}
+
+} // namespace webrtc_apm
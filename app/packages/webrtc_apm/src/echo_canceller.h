@@ -0,0 +1,90 @@
+#ifndef ECHO_CANCELLER_H
+#define ECHO_CANCELLER_H
+
+#include "delay_estimator.h"
+#include "fft.h"
+#include <cstdint>
+#include <vector>
+
+namespace webrtc_apm {
+
+/**
+ * 频域回声消除器
+ *
+ * 1. DelayEstimator 估计渲染到采集的整体延迟，对齐参考信号
+ * 2. 分块频域自适应滤波器（PBFDAF，overlap-save，NLMS 归一化）估计并减去线性回声，
+ *    梯度约束按分块轮流施加，每块固定 5 次 FFT
+ * 3. 按抑制级别对残余回声做宽带非线性抑制
+ *
+ * 内部以 block 为单位处理，输出比输入固定延迟一个 block（16kHz 下 4ms）。
+ * 所有缓冲区在 Initialize 中分配，Process 不做堆分配。
+ */
+class EchoCanceller {
+public:
+    bool Initialize(int sampleRate);
+    void Reset();
+
+    /**
+     * @param level 0 = low, 1 = moderate, 2 = high
+     */
+    void SetSuppressionLevel(int level);
+
+    /**
+     * 处理一段单声道采集信号，out 可与 capture 相同
+     * @param render 与采集同期的参考信号，不足 count 的部分视为静音
+     */
+    void Process(const int16_t* capture, int16_t* out, int count, const int16_t* render, int renderCount);
+
+    int BlockSize() const { return block_; }
+    int DelaySamples() const { return delay_; }
+
+private:
+    void ProcessBlock();
+    void AdaptiveFilter(const float* far, const float* near, float* out);
+    void ApplySuppression(float* out, float echoEnergy, float errorEnergy);
+    void ResetFilter();
+
+    Fft fft_;
+    DelayEstimator delayEstimator_;
+
+    int block_ = 0;        // 分块长度 B，FFT 长度为 2B
+    int bins_ = 0;         // B + 1
+    int partitions_ = 0;   // 滤波器分块数 P
+
+    // 按样本累积的输入/输出块
+    std::vector<float> captureBlock_;
+    std::vector<float> renderBlock_;
+    std::vector<float> outputBlock_;
+    int fill_ = 0;
+
+    // 全采样率参考信号历史，用于按估计延迟取对齐的参考块
+    std::vector<float> renderHistory_;
+    int historyMask_ = 0;
+    int historyPos_ = 0;
+    int delay_ = 0;
+
+    // 滤波器状态：P 个分块的参考频谱与权重（分离格式，每块 bins_ 个频点）
+    std::vector<float> farRe_, farIm_;
+    std::vector<float> weightRe_, weightIm_;
+    std::vector<float> farPower_;
+    int farIndex_ = 0;
+    int constrainIndex_ = 0;
+    int adaptedBlocks_ = 0;
+    int convergenceBlocks_ = 0;
+
+    // 工作缓冲区
+    std::vector<float> aligned_;    // 对齐后的参考块
+    std::vector<float> farTime_;    // [上一块, 当前块]
+    std::vector<float> time_;
+    std::vector<float> specRe_, specIm_;
+    std::vector<float> errRe_, errIm_;
+
+    // 非线性抑制
+    float leak_ = 0.1f;
+    float minGain_ = 0.15f;
+    float gain_ = 1.0f;
+};
+
+} // namespace webrtc_apm
+
+#endif // ECHO_CANCELLER_H
@@ -0,0 +1,189 @@
+#include "fft.h"
+#include <cmath>
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define APM_FFT_NEON 1
+#endif
+
+namespace webrtc_apm {
+
+bool Fft::Init(int n) {
+    if (n < 4 || (n & (n - 1)) != 0) return false;
+
+    n_ = n;
+    m_ = n / 2;
+
+    int bits = 0;
+    while ((1 << bits) < m_) ++bits;
+    bitrev_.resize(m_);
+    for (int i = 0; i < m_; ++i) {
+        int r = 0;
+        for (int b = 0; b < bits; ++b) {
+            r |= ((i >> b) & 1) << (bits - 1 - b);
+        }
+        bitrev_[i] = r;
+    }
+
+    twRe_.assign(m_, 0.0f);
+    twIm_.assign(m_, 0.0f);
+    for (int h = 1; h < m_; h <<= 1) {
+        for (int k = 0; k < h; ++k) {
+            double angle = -M_PI * k / h;
+            twRe_[h + k] = static_cast<float>(std::cos(angle));
+            twIm_[h + k] = static_cast<float>(std::sin(angle));
+        }
+    }
+
+    postRe_.resize(m_ + 1);
+    postIm_.resize(m_ + 1);
+    for (int k = 0; k <= m_; ++k) {
+        double angle = -2.0 * M_PI * k / n_;
+        postRe_[k] = static_cast<float>(std::cos(angle));
+        postIm_[k] = static_cast<float>(std::sin(angle));
+    }
+
+    zr_.assign(m_, 0.0f);
+    zi_.assign(m_, 0.0f);
+    return true;
+}
+
+/**
+ * 原地复数 FFT（输入已按位反转顺序排列）
+ */
+void Fft::Transform(float* zr, float* zi) const {
+    // 前两级合并为基 4，避免 h < 4 时的短循环
+    if (m_ >= 4) {
+        for (int s = 0; s < m_; s += 4) {
+            float ar = zr[s], ai = zi[s];
+            float br = zr[s + 1], bi = zi[s + 1];
+            float cr = zr[s + 2], ci = zi[s + 2];
+            float dr = zr[s + 3], di = zi[s + 3];
+
+            float t0r = ar + br, t0i = ai + bi;
+            float t1r = ar - br, t1i = ai - bi;
+            float t2r = cr + dr, t2i = ci + di;
+            float t3r = cr - dr, t3i = ci - di;
+
+            // t3 * (-i)
+            float u3r = t3i, u3i = -t3r;
+
+            zr[s] = t0r + t2r;      zi[s] = t0i + t2i;
+            zr[s + 2] = t0r - t2r;  zi[s + 2] = t0i - t2i;
+            zr[s + 1] = t1r + u3r;  zi[s + 1] = t1i + u3i;
+            zr[s + 3] = t1r - u3r;  zi[s + 3] = t1i - u3i;
+        }
+    } else {
+        for (int s = 0; s < m_; s += 2) {
+            float ar = zr[s], ai = zi[s];
+            zr[s] = ar + zr[s + 1];      zi[s] = ai + zi[s + 1];
+            zr[s + 1] = ar - zr[s + 1];  zi[s + 1] = ai - zi[s + 1];
+        }
+        return;
+    }
+
+    for (int h = 4; h < m_; h <<= 1) {
+        const float* wr = twRe_.data() + h;
+        const float* wi = twIm_.data() + h;
+
+        for (int s = 0; s < m_; s += 2 * h) {
+            float* ar = zr + s;
+            float* ai = zi + s;
+            float* br = zr + s + h;
+            float* bi = zi + s + h;
+
+#ifdef APM_FFT_NEON
+            for (int k = 0; k < h; k += 4) {
+                float32x4_t vwr = vld1q_f32(wr + k);
+                float32x4_t vwi = vld1q_f32(wi + k);
+                float32x4_t vbr = vld1q_f32(br + k);
+                float32x4_t vbi = vld1q_f32(bi + k);
+                float32x4_t var = vld1q_f32(ar + k);
+                float32x4_t vai = vld1q_f32(ai + k);
+
+                float32x4_t tr = vmlsq_f32(vmulq_f32(vbr, vwr), vbi, vwi);
+                float32x4_t ti = vmlaq_f32(vmulq_f32(vbr, vwi), vbi, vwr);
+
+                vst1q_f32(ar + k, vaddq_f32(var, tr));
+                vst1q_f32(ai + k, vaddq_f32(vai, ti));
+                vst1q_f32(br + k, vsubq_f32(var, tr));
+                vst1q_f32(bi + k, vsubq_f32(vai, ti));
+            }
+#else
+            for (int k = 0; k < h; ++k) {
+                float tr = br[k] * wr[k] - bi[k] * wi[k];
+                float ti = br[k] * wi[k] + bi[k] * wr[k];
+                br[k] = ar[k] - tr;
+                bi[k] = ai[k] - ti;
+                ar[k] += tr;
+                ai[k] += ti;
+            }
+#endif
+        }
+    }
+}
+
+void Fft::Forward(const float* in, float* re, float* im) {
+    float* zr = zr_.data();
+    float* zi = zi_.data();
+
+    // 偶数样本作实部、奇数样本作虚部，直接写入位反转位置
+    for (int j = 0; j < m_; ++j) {
+        int r = bitrev_[j];
+        zr[r] = in[2 * j];
+        zi[r] = in[2 * j + 1];
+    }
+
+    Transform(zr, zi);
+
+    // 拆分出实数序列的频谱：X[k] = E[k] + e^{-2πik/n} O[k]
+    re[0] = zr[0] + zi[0];
+    im[0] = 0.0f;
+    re[m_] = zr[0] - zi[0];
+    im[m_] = 0.0f;
+    for (int k = 1; k < m_; ++k) {
+        float zkr = zr[k], zki = zi[k];
+        float zcr = zr[m_ - k], zci = -zi[m_ - k];
+
+        float er = 0.5f * (zkr + zcr), ei = 0.5f * (zki + zci);
+        // O = (Zk - conj(Zm-k)) / 2i
+        float or_ = 0.5f * (zki - zci), oi = -0.5f * (zkr - zcr);
+
+        float wr = postRe_[k], wi = postIm_[k];
+        re[k] = er + or_ * wr - oi * wi;
+        im[k] = ei + or_ * wi + oi * wr;
+    }
+}
+
+void Fft::Inverse(const float* re, const float* im, float* out) {
+    float* zr = zr_.data();
+    float* zi = zi_.data();
+
+    // 重建 Z[k] = E[k] + i O[k]，并取共轭以复用正变换
+    for (int k = 0; k < m_; ++k) {
+        float xkr = re[k], xki = im[k];
+        float xcr = re[m_ - k], xci = -im[m_ - k];
+
+        float er = 0.5f * (xkr + xcr), ei = 0.5f * (xki + xci);
+        float dr = 0.5f * (xkr - xcr), di = 0.5f * (xki - xci);
+
+        // O = D * e^{+2πik/n}
+        float wr = postRe_[k], wi = -postIm_[k];
+        float or_ = dr * wr - di * wi;
+        float oi = dr * wi + di * wr;
+
+        int r = bitrev_[k];
+        zr[r] = er - oi;
+        zi[r] = -(ei + or_);
+    }
+
+    Transform(zr, zi);
+
+    float scale = 1.0f / m_;
+    for (int j = 0; j < m_; ++j) {
+        out[2 * j] = zr[j] * scale;
+        out[2 * j + 1] = -zi[j] * scale;
+    }
+}
+
+} // namespace webrtc_apm
@@ -0,0 +1,57 @@
+#ifndef FFT_H
+#define FFT_H
+
+#include <vector>
+
+namespace webrtc_apm {
+
+/**
+ * 实数 FFT（长度为 2 的幂）
+ *
+ * 频谱以分离格式存储：re/im 各 n/2+1 个频点。
+ * 内部将 n 点实数变换折叠为 n/2 点复数变换，旋转因子、位反转表与
+ * 工作缓冲区都在 Init 中预分配，Forward/Inverse 不做任何堆分配。
+ * ARM 上蝶形运算使用 NEON 每次处理 4 个复数。
+ */
+class Fft {
+public:
+    Fft() = default;
+
+    /**
+     * @param n 变换长度，必须是 2 的幂且 >= 4
+     * @return 长度非法时返回 false
+     */
+    bool Init(int n);
+
+    int Size() const { return n_; }
+    int Bins() const { return n_ / 2 + 1; }
+
+    /**
+     * 正变换（不做归一化）
+     * @param in n 个实数样本
+     * @param re,im 输出 n/2+1 个频点
+     */
+    void Forward(const float* in, float* re, float* im);
+
+    /**
+     * 逆变换（包含 1/n 归一化）
+     * @param re,im n/2+1 个频点
+     * @param out 输出 n 个实数样本
+     */
+    void Inverse(const float* re, const float* im, float* out);
+
+private:
+    void Transform(float* zr, float* zi) const;
+
+    int n_ = 0;
+    int m_ = 0;  // 复数变换长度 n/2
+
+    std::vector<int> bitrev_;
+    std::vector<float> twRe_, twIm_;  // 第 h 级蝶形的旋转因子位于 [h, 2h)
+    std::vector<float> postRe_, postIm_;  // e^{-2πik/n}, k = 0..m
+    std::vector<float> zr_, zi_;
+};
+
+} // namespace webrtc_apm
+
+#endif // FFT_H
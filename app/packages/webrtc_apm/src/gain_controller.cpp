@@ -0,0 +1,137 @@
+#include "gain_controller.h"
+#include "audio_kernels.h"
+#include <algorithm>
+#include <cmath>
+
+namespace webrtc_apm {
+
+namespace {
+    struct ModeParams {
+        float minGain;
+        float maxGain;
+        float attackMs;       // 电平包络上升
+        float releaseMs;      // 电平包络下降
+        float gainDecayMs;    // 增益下降
+        float gainRiseMs;     // 增益上升
+    };
+
+    // 各模式的增益范围与时间常数
+    constexpr ModeParams kModes[] = {
+        // adaptive analog：-12..+24 dB，慢速
+        {0.25f, 16.0f, 50.0f, 2000.0f, 200.0f, 3000.0f},
+        // adaptive digital：-6..+20 dB，与原实现的 0.5x-10x 范围一致
+        {0.5f, 10.0f, 10.0f, 500.0f, 20.0f, 400.0f},
+        // fixed digital：增益固定，仅限幅
+        {1.0f, 1.0f, 10.0f, 500.0f, 0.0f, 0.0f},
+    };
+
+    // 模式切换的增益过渡，与 adaptive digital 的时间常数相同；
+    // 增益与期望值相差在 kSwitchDoneRatio 以内时过渡结束
+    constexpr float kSwitchDecayMs = 20.0f;
+    constexpr float kSwitchRiseMs = 400.0f;
+    constexpr float kSwitchDoneRatio = 0.01f;
+
+    // 固定数字增益（WebRTC 默认 compression gain 为 9 dB）
+    constexpr float kFixedGain = 2.8183829f;  // 10^(9/20)
+
+    // 低于此 RMS 视为静音，保持当前增益，不跟踪电平
+    constexpr float kSilenceRms = 20.0f;
+
+    // 限幅：输出峰值不超过 -1 dBFS
+    constexpr float kLimitPeak = 29204.0f;
+
+    float Coefficient(float timeMs, int count, int sampleRate) {
+        if (timeMs <= 0.0f) return 1.0f;
+        float frameMs = 1000.0f * count / sampleRate;
+        return 1.0f - std::exp(-frameMs / timeMs);
+    }
+}
+
+bool GainController::Initialize(int sampleRate) {
+    if (sampleRate <= 0) return false;
+    sampleRate_ = sampleRate;
+    coefficientCount_ = 0;
+    Reset();
+    return true;
+}
+
+void GainController::Reset() {
+    level_ = 0.0f;
+    hasLevel_ = false;
+    gain_ = mode_ == 2 ? kFixedGain : 1.0f;
+    if (switching_) coefficientCount_ = 0;
+    switching_ = false;
+}
+
+void GainController::SetMode(int mode) {
+    mode = std::clamp(mode, 0, 2);
+    if (mode == mode_) return;
+    mode_ = mode;
+    coefficientCount_ = 0;
+    switching_ = true;
+}
+
+void GainController::SetTargetLevel(int targetLevelDbfs) {
+    // dBFS = 20 * log10(rms / 32768)，配置时计算一次
+    targetRms_ = 32768.0f * std::pow(10.0f, -std::clamp(targetLevelDbfs, 0, 31) / 20.0f);
+}
+
+/**
+ * 帧长变化时重新计算平滑系数（通常只在第一帧发生）
+ */
+void GainController::UpdateCoefficients(int count) {
+    if (count == coefficientCount_) return;
+    const ModeParams& p = kModes[mode_];
+    levelAttack_ = Coefficient(p.attackMs, count, sampleRate_);
+    levelRelease_ = Coefficient(p.releaseMs, count, sampleRate_);
+    bool ramp = switching_ && p.gainDecayMs <= 0.0f;
+    gainDecay_ = Coefficient(ramp ? kSwitchDecayMs : p.gainDecayMs, count, sampleRate_);
+    gainRise_ = Coefficient(ramp ? kSwitchRiseMs : p.gainRiseMs, count, sampleRate_);
+    coefficientCount_ = count;
+}
+
+void GainController::Process(const int16_t* in, int16_t* out, int count, int channels,
+                             int64_t energy, int peak) {
+    if (count <= 0 || channels <= 0) return;
+    UpdateCoefficients(count);
+
+    const ModeParams& p = kModes[mode_];
+    float rms = std::sqrt(static_cast<float>(energy) / (static_cast<int64_t>(count) * channels));
+    float desired = gain_;
+
+    // 电平包络：快攻慢放。fixed digital 也跟踪，切回自适应模式时包络仍然有效
+    if (rms >= kSilenceRms) {
+        if (!hasLevel_) {
+            level_ = rms;
+            hasLevel_ = true;
+        } else {
+            level_ += (rms > level_ ? levelAttack_ : levelRelease_) * (rms - level_);
+        }
+        if (mode_ != 2) desired = std::clamp(targetRms_ / level_, p.minGain, p.maxGain);
+    }
+    if (mode_ == 2) desired = kFixedGain;
+
+    float from = gain_;
+    float next = gain_ + (desired < gain_ ? gainDecay_ : gainRise_) * (desired - gain_);
+
+    // 过渡到新模式的期望增益后恢复该模式自身的时间常数
+    if (switching_ && std::abs(next - desired) <= kSwitchDoneRatio * desired) {
+        next = desired;
+        switching_ = false;
+        coefficientCount_ = 0;
+    }
+
+    // 峰值限幅：整帧即刻生效，不经过斜坡
+    if (peak > 0 && peak * next > kLimitPeak) {
+        next = kLimitPeak / peak;
+        from = std::min(from, next);
+    }
+
+    for (int c = 0; c < channels; ++c) {
+        size_t offset = static_cast<size_t>(c) * count;
+        dsp::ApplyGainRamp(in + offset, out + offset, count, from, next);
+    }
+    gain_ = next;
+}
+
+} // namespace webrtc_apm
@@ -0,0 +1,75 @@
+#ifndef GAIN_CONTROLLER_H
+#define GAIN_CONTROLLER_H
+
+#include <cstdint>
+
+namespace webrtc_apm {
+
+/**
+ * 有状态的自动增益控制
+ *
+ * 对帧电平做快攻慢放的包络跟踪，由目标电平得到期望增益，
+ * 增益本身再按模式平滑，帧内线性过渡并做峰值限幅，避免帧间跳变与削波。
+ *
+ * 模式（与 WebRTC AGC 对应）：
+ *   0 = adaptive analog   模拟"麦克风音量"，增益范围大、变化缓慢
+ *   1 = adaptive digital  数字自适应，跟随语音电平较快
+ *   2 = fixed digital     固定增益，仅做限幅
+ *
+ * 多声道按平面布局处理，各声道共用同一增益（联动），不改变声像。
+ * 目标电平与时间常数在配置变化时预先计算，每帧无 pow/exp。
+ */
+class GainController {
+public:
+    bool Initialize(int sampleRate);
+    void Reset();
+
+    /**
+     * 切换模式，在处理线程的帧间调用
+     *
+     * 保留当前增益与电平包络，增益从当前值平滑过渡到新模式的期望增益，
+     * 切换点不跳变；新模式本身不平滑增益（fixed digital）时按过渡时间常数逼近
+     */
+    void SetMode(int mode);
+
+    /**
+     * @param targetLevelDbfs 目标电平（低于满幅的 dB 数，0..31）
+     */
+    void SetTargetLevel(int targetLevelDbfs);
+
+    /**
+     * 处理一帧，out 可与 in 相同
+     * @param count 每声道的样本数
+     * @param channels 声道数，声道 c 位于 in + c * count（平面布局）
+     * @param energy 本帧所有声道输入样本平方和
+     * @param peak 本帧所有声道输入最大绝对值
+     */
+    void Process(const int16_t* in, int16_t* out, int count, int channels, int64_t energy, int peak);
+
+    float Gain() const { return gain_; }
+
+private:
+    void UpdateCoefficients(int count);
+
+    int sampleRate_ = 16000;
+    int mode_ = 1;
+    float targetRms_ = 0.0f;
+
+    // 按帧长缓存的平滑系数
+    int coefficientCount_ = 0;
+    float levelAttack_ = 0.0f;
+    float levelRelease_ = 0.0f;
+    float gainDecay_ = 0.0f;
+    float gainRise_ = 0.0f;
+
+    float level_ = 0.0f;
+    float gain_ = 1.0f;
+    bool hasLevel_ = false;
+
+    // 模式切换后、增益到达新模式期望值之前为 true
+    bool switching_ = false;
+};
+
+} // namespace webrtc_apm
+
+#endif // GAIN_CONTROLLER_H
@@ -0,0 +1,174 @@
+#ifndef AUDIO_PROCESSOR_H
+#define AUDIO_PROCESSOR_H
+
+#include <cstdint>
+#include <vector>
+#include <memory>
+
+namespace webrtc_apm {
+
+/**
+ * 单个处理阶段每个 10ms 块的耗时分布（微秒，墙钟时间）
+ */
+struct StageLatency {
+    uint64_t blocks = 0;
+    int p50Us = 0;
+    int p99Us = 0;
+    int maxUs = 0;
+};
+
+/**
+ * 处理统计快照，统计区间为初始化或上次 ResetStats 之后
+ */
+struct ProcessingStats {
+    uint64_t captureBlocks = 0;         // 已处理的 10ms 采集块数
+    uint64_t renderFrames = 0;          // 送入的参考信号帧数
+    uint64_t renderOverruns = 0;        // 参考信号缓冲区满而丢弃的帧数
+    uint64_t inputClippedSamples = 0;   // 输入中满幅（削波）的样本数
+    uint64_t outputClippedSamples = 0;  // 输出中满幅的样本数（通常由 AGC 增益过大引起）
+    uint64_t processingTimeUs = 0;      // 累计处理耗时，除以 captureBlocks * 10000 即为实时负载
+    uint64_t speechBlocks = 0;          // 按语音完整处理的块数，VAD 关闭时等于 captureBlocks
+    int aecDelayMs = -1;                // AEC 估计的渲染到采集延迟，AEC 未运行时为 -1
+    int renderBufferedMs = 0;           // 参考信号缓冲区中尚未消费的时长
+
+    StageLatency aec;
+    StageLatency ns;
+    StageLatency agc;
+    StageLatency vad;
+    StageLatency total;                 // 整个处理链
+};
+
+/**
+ * 音频处理器
+ *
+ * 封装 WebRTC APM 的功能
+ *
+ * 线程模型：采集与渲染可以在两个线程上并发调用；配置调用（Set*）可在任意线程上
+ * 与处理调用并发，只写入待生效的配置，由采集线程在下一个 10ms 块开始时统一应用，
+ * 包括模块启用时的状态重置。ProcessCaptureBatch 使用独立的内部状态，可与实时的
+ * 采集/渲染并发，但批量调用之间需串行。Initialize/Destroy 需与其他调用串行
+ */
+class AudioProcessor {
+public:
+    AudioProcessor();
+    ~AudioProcessor();
+
+    /**
+     * 初始化处理器
+     *
+     * 处理模块固定按 10ms 块运行，高于 16kHz 的输入（如 44.1/48kHz）在内部降到 16kHz 处理后再升回。
+     * 多声道输入按平面布局逐声道处理，AEC/NS 每个声道独立维护状态，AGC 各声道联动
+     * @param sampleRate 采样率（如 16000）
+     * @param channels 声道数（如 1），采集与参考信号均为该声道数的交织数据
+     * @return 是否成功
+     */
+    bool Initialize(int sampleRate, int channels);
+
+    /**
+     * 释放资源
+     */
+    void Destroy();
+
+    // AEC 配置
+    bool SetAecEnabled(bool enabled);
+    bool SetAecSuppressionLevel(int level);
+
+    // NS 配置
+    bool SetNsEnabled(bool enabled);
+    bool SetNsSuppressionLevel(int level);
+
+    // AGC 配置
+    bool SetAgcEnabled(bool enabled);
+    bool SetAgcMode(int mode);
+    bool SetAgcTargetLevel(int targetLevelDbfs);
+
+    /**
+     * VAD 配置
+     *
+     * 启用后每个 10ms 块先做语音检测：非语音块跳过 AEC/NS/AGC，
+     * 按 NS 的增益下限衰减后输出（NS 关闭时原样输出）。默认关闭
+     */
+    bool SetVadEnabled(bool enabled);
+
+    /**
+     * 多声道混音模式
+     *
+     * 启用后多声道采集先混为单声道，只运行一路 AEC/NS/AGC，结果复制到每个声道输出，
+     * 处理耗时与单声道相同。适用于只需要一路语音的场景（如 ASR）。默认关闭，单声道时无效
+     */
+    bool SetDownmixEnabled(bool enabled);
+
+    /**
+     * 处理捕获的音频（麦克风输入）
+     *
+     * 输入长度任意，内部分帧后输出与输入等长，整体固定延迟约 10ms（另加重采样滤波器的群延迟）
+     * @param audioData PCM16 音频数据
+     * @param size 数据大小
+     * @param outputData 输出缓冲区（可与 audioData 相同，即原地处理）
+     * @return 处理后的数据大小
+     */
+    int ProcessCaptureFrame(const int16_t* audioData, int size, int16_t* outputData);
+
+    /**
+     * 上一次 ProcessCaptureFrame 处理的块中是否有语音（含拖尾）
+     *
+     * 供调用方跳过静音帧的上传；VAD 关闭或未初始化时恒为 true。
+     * 该次调用不足一块时沿用之前的结果
+     */
+    bool LastCaptureSpeech() const;
+
+    /**
+     * 处理渲染的音频（扬声器输出/TTS 参考信号）
+     * @param audioData PCM16 音频数据
+     * @param size 数据大小
+     * @return 是否成功
+     */
+    bool ProcessRenderFrame(const int16_t* audioData, int size);
+
+    /**
+     * 批量处理积压的音频（如 ASR 重连后补发），一次调用内逐帧循环
+     *
+     * 每帧先送入对应的参考信号，再处理采集信号，与实时路径的时序一致。
+     * 批量在独立的处理实例上运行：复制当前配置，每次调用从初始状态开始（AEC/NS 重新收敛），
+     * 不影响实时路径的状态与 GetStats，实时送入的参考信号也不参与批量的 AEC。
+     * 分帧器的固定延迟在调用内抵消，输出与输入逐帧对齐，只剩重采样滤波器的群延迟
+     * （输入不高于 16kHz 时为 0，48kHz 时约 1.5ms）。实时采集或渲染仍在进行时首次调用会输出一条日志
+     * @param capture 交织的采集数据，sampleCount 个样本
+     * @param render 与采集逐样本对应的参考信号，可为 nullptr；不足的部分视为无参考
+     * @param frameSamples 每帧样本数（如 16kHz 单声道 10ms 为 160），须为声道数的整数倍，末帧可不满
+     * @param outputData 输出缓冲区（可与 capture 相同）
+     * @return 处理的样本数，参数无效时返回 0
+     */
+    int ProcessCaptureBatch(const int16_t* capture, int sampleCount,
+                            const int16_t* render, int renderCount,
+                            int frameSamples, int16_t* outputData);
+
+    /**
+     * 获取处理统计，可与处理调用并发（得到的是近似快照）
+     *
+     * 计时只包含处理链本身，每块至多 5 次单调时钟读取（多声道另加 1 次）
+     * @return 未初始化时返回 false
+     */
+    bool GetStats(ProcessingStats* stats) const;
+
+    /**
+     * 清空统计，从下一个采集块开始重新计数
+     */
+    void ResetStats();
+
+    int SampleRate() const { return sampleRate_; }
+    int Channels() const { return channels_; }
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> impl_;
+    std::unique_ptr<Impl> batchImpl_;   // ProcessCaptureBatch 专用，首次调用时创建
+
+    bool initialized_;
+    int sampleRate_;
+    int channels_;
+};
+
+} // namespace webrtc_apm
+
+#endif // AUDIO_PROCESSOR_H
@@ -0,0 +1,78 @@
+#ifndef WEBRTC_APM_C_H
+#define WEBRTC_APM_C_H
+
+/**
+ * AudioProcessor 的 C ABI
+ *
+ * 供 dart:ffi 等不经过 JNI 的调用方直接使用：所有音频数据都是调用方持有的
+ * PCM16 缓冲区，调用同步完成，不做序列化与复制。
+ * 同一处理器的采集与渲染可以在两个线程上并发调用；配置调用可与处理调用并发，
+ * 在下一个 10ms 采集块开始时生效。创建与销毁需与其他调用串行。
+ */
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define WEBRTC_APM_EXPORT __attribute__((visibility("default"))) __attribute__((used))
+
+typedef struct WebrtcApm WebrtcApm;
+
+/**
+ * 创建并初始化处理器
+ * @return 失败时返回 NULL
+ */
+WEBRTC_APM_EXPORT WebrtcApm* webrtc_apm_create(int32_t sample_rate, int32_t channels);
+
+WEBRTC_APM_EXPORT void webrtc_apm_destroy(WebrtcApm* apm);
+
+// 配置：成功返回 1，失败返回 0
+WEBRTC_APM_EXPORT int32_t webrtc_apm_set_aec_enabled(WebrtcApm* apm, int32_t enabled);
+WEBRTC_APM_EXPORT int32_t webrtc_apm_set_aec_suppression_level(WebrtcApm* apm, int32_t level);
+WEBRTC_APM_EXPORT int32_t webrtc_apm_set_ns_enabled(WebrtcApm* apm, int32_t enabled);
+WEBRTC_APM_EXPORT int32_t webrtc_apm_set_ns_suppression_level(WebrtcApm* apm, int32_t level);
+WEBRTC_APM_EXPORT int32_t webrtc_apm_set_agc_enabled(WebrtcApm* apm, int32_t enabled);
+WEBRTC_APM_EXPORT int32_t webrtc_apm_set_agc_mode(WebrtcApm* apm, int32_t mode);
+WEBRTC_APM_EXPORT int32_t webrtc_apm_set_agc_target_level(WebrtcApm* apm, int32_t target_level_dbfs);
+WEBRTC_APM_EXPORT int32_t webrtc_apm_set_vad_enabled(WebrtcApm* apm, int32_t enabled);
+WEBRTC_APM_EXPORT int32_t webrtc_apm_set_downmix_enabled(WebrtcApm* apm, int32_t enabled);
+
+/**
+ * 处理采集音频
+ * @param output 可与 input 相同（原地处理）
+ * @return 输出的样本数，参数无效时返回 -1
+ */
+WEBRTC_APM_EXPORT int32_t webrtc_apm_process_capture(WebrtcApm* apm, const int16_t* input,
+                                                     int32_t sample_count, int16_t* output);
+
+/**
+ * 上一次 webrtc_apm_process_capture 的输出中是否有语音
+ * @return 有语音（或 VAD 关闭）返回 1，否则返回 0
+ */
+WEBRTC_APM_EXPORT int32_t webrtc_apm_last_capture_speech(const WebrtcApm* apm);
+
+/**
+ * 输入渲染音频（AEC 参考信号）
+ * @return 成功返回 1，失败返回 0
+ */
+WEBRTC_APM_EXPORT int32_t webrtc_apm_process_render(WebrtcApm* apm, const int16_t* data, int32_t sample_count);
+
+/**
+ * 批量处理积压音频，语义同 AudioProcessor::ProcessCaptureBatch
+ * 在独立的处理状态上运行，可与实时采集/渲染并发，批量调用之间需串行
+ * @param render 可为 NULL
+ * @param frame_samples 须为声道数的整数倍
+ * @return 处理的样本数，参数无效时返回 -1
+ */
+WEBRTC_APM_EXPORT int32_t webrtc_apm_process_capture_batch(WebrtcApm* apm,
+                                                           const int16_t* capture, int32_t sample_count,
+                                                           const int16_t* render, int32_t render_count,
+                                                           int32_t frame_samples, int16_t* output);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif // WEBRTC_APM_C_H
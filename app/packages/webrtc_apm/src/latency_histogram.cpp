@@ -0,0 +1,63 @@
+#include "latency_histogram.h"
+#include <algorithm>
+#include <cmath>
+
+namespace webrtc_apm {
+
+void LatencyHistogram::Record(int64_t durationNs) {
+    uint32_t us = static_cast<uint32_t>(std::clamp<int64_t>(durationNs / 1000, 0, UINT32_MAX));
+
+    // 单写者：load + store 即可，没有读改写的开销
+    auto& bucket = buckets_[BucketOf(us)];
+    bucket.store(bucket.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    count_.store(count_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    totalUs_.store(totalUs_.load(std::memory_order_relaxed) + us, std::memory_order_relaxed);
+    if (us > maxUs_.load(std::memory_order_relaxed)) {
+        maxUs_.store(us, std::memory_order_relaxed);
+    }
+}
+
+void LatencyHistogram::Reset() {
+    for (auto& bucket : buckets_) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+    count_.store(0, std::memory_order_relaxed);
+    totalUs_.store(0, std::memory_order_relaxed);
+    maxUs_.store(0, std::memory_order_relaxed);
+}
+
+int LatencyHistogram::PercentileUs(double quantile) const {
+    uint64_t count = Count();
+    if (count == 0) return 0;
+
+    uint64_t target = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(quantile * count)));
+    uint64_t seen = 0;
+    for (int b = 0; b < kBucketCount; ++b) {
+        seen += buckets_[b].load(std::memory_order_relaxed);
+        if (seen >= target) {
+            return static_cast<int>(std::min(BucketUpperUs(b), maxUs_.load(std::memory_order_relaxed)));
+        }
+    }
+    // 读取期间有新的写入，各桶之和可能略小于 count
+    return MaxUs();
+}
+
+int LatencyHistogram::BucketOf(uint32_t us) {
+    if (us < kLinearBuckets) return static_cast<int>(us);
+
+    int exponent = 31 - __builtin_clz(us);
+    if (exponent > kMaxExponent) return kBucketCount - 1;
+    int mantissa = static_cast<int>(us >> (exponent - 3)) & (kSubBuckets - 1);
+    return kLinearBuckets + (exponent - 4) * kSubBuckets + mantissa;
+}
+
+uint32_t LatencyHistogram::BucketUpperUs(int bucket) {
+    if (bucket < kLinearBuckets) return static_cast<uint32_t>(bucket);
+    if (bucket == kBucketCount - 1) return UINT32_MAX;
+
+    int exponent = (bucket - kLinearBuckets) / kSubBuckets + 4;
+    int mantissa = (bucket - kLinearBuckets) % kSubBuckets;
+    return ((static_cast<uint32_t>(kSubBuckets + mantissa + 1)) << (exponent - 3)) - 1;
+}
+
+} // namespace webrtc_apm
@@ -0,0 +1,70 @@
+#ifndef LATENCY_HISTOGRAM_H
+#define LATENCY_HISTOGRAM_H
+
+#include <atomic>
+#include <cstdint>
+
+namespace webrtc_apm {
+
+/**
+ * 处理耗时直方图（单写者/多读者，无锁）
+ *
+ * 以微秒为单位对数分桶：16us 以下每 1us 一桶，之上每个 2 的幂区间再分 8 桶，
+ * 相对误差不超过 12.5%，最大约 1s，更长的计入最后一桶。
+ * 写入端（采集线程）只做 relaxed 的 load/store，不使用原子读改写；
+ * 读取端可在任意线程调用，得到的是近似快照（各桶之间不保证同一时刻）。
+ */
+class LatencyHistogram {
+public:
+    LatencyHistogram() { Reset(); }
+
+    LatencyHistogram(const LatencyHistogram&) = delete;
+    LatencyHistogram& operator=(const LatencyHistogram&) = delete;
+
+    // ---- 写入端 ----
+
+    /**
+     * 记录一次耗时
+     */
+    void Record(int64_t durationNs);
+
+    /**
+     * 清空所有计数，只能在写入端调用
+     */
+    void Reset();
+
+    // ---- 读取端 ----
+
+    uint64_t Count() const { return count_.load(std::memory_order_relaxed); }
+
+    /**
+     * 累计耗时（微秒）
+     */
+    uint64_t TotalUs() const { return totalUs_.load(std::memory_order_relaxed); }
+
+    int MaxUs() const { return static_cast<int>(maxUs_.load(std::memory_order_relaxed)); }
+
+    /**
+     * 分位数（微秒），返回所在桶的上界且不超过最大值；没有记录时返回 0
+     * @param quantile 0-1，如 0.5、0.99
+     */
+    int PercentileUs(double quantile) const;
+
+private:
+    static constexpr int kLinearBuckets = 16;
+    static constexpr int kSubBuckets = 8;
+    static constexpr int kMaxExponent = 19;
+    static constexpr int kBucketCount = kLinearBuckets + (kMaxExponent - 3) * kSubBuckets;
+
+    static int BucketOf(uint32_t us);
+    static uint32_t BucketUpperUs(int bucket);
+
+    std::atomic<uint32_t> buckets_[kBucketCount];
+    std::atomic<uint64_t> count_;
+    std::atomic<uint64_t> totalUs_;
+    std::atomic<uint32_t> maxUs_;
+};
+
+} // namespace webrtc_apm
+
+#endif // LATENCY_HISTOGRAM_H
@@ -0,0 +1,164 @@
+#include "noise_suppressor.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+namespace webrtc_apm {
+
+namespace {
+    // 帧移约 8ms，窗长为两倍帧移
+    constexpr int kHopMs = 8;
+
+    // 启动阶段直接平均得到初始噪声估计的帧数（约 160ms）
+    constexpr int kInitFrames = 20;
+
+    // 功率谱平滑、噪声下降系数、噪声上升速率（约 5dB/s）
+    constexpr float kPowerSmoothing = 0.7f;
+    constexpr float kNoiseFall = 0.2f;
+    constexpr float kNoiseRiseDbPerSec = 5.0f;
+
+    // 判决引导的平滑系数
+    constexpr float kDdAlpha = 0.98f;
+
+    // 抑制级别对应的增益下限（-6/-12/-20/-26 dB）与噪声过估计系数
+    constexpr float kMinGain[] = {0.5f, 0.25f, 0.1f, 0.05f};
+    constexpr float kOverdrive[] = {1.0f, 1.0f, 1.1f, 1.25f};
+
+    constexpr float kEpsilon = 1e-10f;
+    constexpr float kInt16Scale = 1.0f / 32768.0f;
+}
+
+bool NoiseSuppressor::Initialize(int sampleRate) {
+    if (sampleRate <= 0) return false;
+
+    int hop = 16;
+    while (hop < sampleRate / 1000 * kHopMs) hop <<= 1;
+    if (!fft_.Init(2 * hop)) return false;
+
+    hop_ = hop;
+    size_ = 2 * hop;
+    bins_ = hop + 1;
+
+    // 周期 sqrt-Hann 窗：分析与合成各乘一次，50% 重叠时平方和为 1
+    window_.resize(size_);
+    for (int i = 0; i < size_; ++i) {
+        window_[i] = static_cast<float>(std::sqrt(0.5 * (1.0 - std::cos(2.0 * M_PI * i / size_))));
+    }
+
+    input_.assign(size_, 0.0f);
+    output_.assign(hop_, 0.0f);
+    overlap_.assign(hop_, 0.0f);
+    frame_.assign(size_, 0.0f);
+    re_.assign(bins_, 0.0f);
+    im_.assign(bins_, 0.0f);
+    smoothedPower_.assign(bins_, 0.0f);
+    noise_.assign(bins_, 0.0f);
+    prevSnr_.assign(bins_, 0.0f);
+
+    noiseRise_ = static_cast<float>(std::pow(10.0, kNoiseRiseDbPerSec / 10.0 * hop_ / sampleRate));
+
+    Reset();
+    return true;
+}
+
+void NoiseSuppressor::Reset() {
+    std::fill(input_.begin(), input_.end(), 0.0f);
+    std::fill(output_.begin(), output_.end(), 0.0f);
+    std::fill(overlap_.begin(), overlap_.end(), 0.0f);
+    std::fill(smoothedPower_.begin(), smoothedPower_.end(), 0.0f);
+    std::fill(noise_.begin(), noise_.end(), 0.0f);
+    std::fill(prevSnr_.begin(), prevSnr_.end(), 0.0f);
+    fill_ = 0;
+    frames_ = 0;
+}
+
+void NoiseSuppressor::SetLevel(int level) {
+    level = std::clamp(level, 0, 3);
+    minGain_ = kMinGain[level];
+    overdrive_ = kOverdrive[level];
+}
+
+void NoiseSuppressor::Process(const int16_t* data, int16_t* out, int count, int stride, dsp::FrameStats* stats) {
+    if (hop_ == 0) return;
+
+    float* in = input_.data() + hop_;
+    int i = 0;
+    while (i < count) {
+        int n = std::min(count - i, hop_ - fill_);
+        if (stride == 1) {
+            int16_t* chunk = out + i;
+            dsp::Int16ToFloat(data + i, in + fill_, n, kInt16Scale);
+            dsp::FloatToInt16(output_.data() + fill_, chunk, n, 32768.0f);
+            // 刚写出的样本仍在缓存中，顺带统计
+            if (stats) stats->Add(dsp::ComputeStats(chunk, n));
+        } else {
+            for (int j = 0; j < n; ++j) {
+                int offset = (i + j) * stride;
+                in[fill_ + j] = data[offset] * kInt16Scale;
+
+                int16_t* sample = out + offset;
+                *sample = static_cast<int16_t>(std::clamp(output_[fill_ + j] * 32768.0f, -32768.0f, 32767.0f));
+                if (stats) {
+                    stats->energy += static_cast<int32_t>(*sample) * *sample;
+                    stats->peak = std::max(stats->peak, std::abs(static_cast<int>(*sample)));
+                }
+            }
+        }
+        fill_ += n;
+        i += n;
+
+        if (fill_ == hop_) {
+            ProcessFrame();
+            fill_ = 0;
+        }
+    }
+}
+
+void NoiseSuppressor::ProcessFrame() {
+    for (int i = 0; i < size_; ++i) {
+        frame_[i] = input_[i] * window_[i];
+    }
+    fft_.Forward(frame_.data(), re_.data(), im_.data());
+
+    bool initializing = frames_ < kInitFrames;
+    for (int k = 0; k < bins_; ++k) {
+        float power = re_[k] * re_[k] + im_[k] * im_[k];
+
+        // 噪声底跟踪
+        if (initializing) {
+            noise_[k] += (power - noise_[k]) / (frames_ + 1);
+            smoothedPower_[k] = noise_[k];
+        } else {
+            float smoothed = kPowerSmoothing * smoothedPower_[k] + (1.0f - kPowerSmoothing) * power;
+            smoothedPower_[k] = smoothed;
+            if (smoothed < noise_[k]) {
+                noise_[k] += kNoiseFall * (smoothed - noise_[k]);
+            } else {
+                noise_[k] = std::min(noise_[k] * noiseRise_, smoothed);
+            }
+        }
+
+        // 判决引导先验信噪比 + Wiener 增益
+        float posterior = power / (overdrive_ * noise_[k] + kEpsilon);
+        float prior = kDdAlpha * prevSnr_[k] + (1.0f - kDdAlpha) * std::max(posterior - 1.0f, 0.0f);
+        float gain = std::max(prior / (1.0f + prior), minGain_);
+        prevSnr_[k] = gain * gain * posterior;
+
+        re_[k] *= gain;
+        im_[k] *= gain;
+    }
+    if (initializing) ++frames_;
+
+    fft_.Inverse(re_.data(), im_.data(), frame_.data());
+
+    // 合成窗 + 重叠相加
+    for (int i = 0; i < hop_; ++i) {
+        output_[i] = overlap_[i] + frame_[i] * window_[i];
+        overlap_[i] = frame_[hop_ + i] * window_[hop_ + i];
+    }
+
+    std::memcpy(input_.data(), input_.data() + hop_, hop_ * sizeof(float));
+}
+
+} // namespace webrtc_apm
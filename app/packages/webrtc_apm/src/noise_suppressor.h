@@ -0,0 +1,76 @@
+#ifndef NOISE_SUPPRESSOR_H
+#define NOISE_SUPPRESSOR_H
+
+#include "audio_kernels.h"
+#include "fft.h"
+#include <cstdint>
+#include <vector>
+
+namespace webrtc_apm {
+
+/**
+ * STFT 频谱噪声抑制器（单通道）
+ *
+ * sqrt-Hann 窗、50% 重叠的 WOLA 分析/合成。每个频点维护持续的噪声底估计
+ * （初始若干帧取平均，之后快降慢升地跟踪平滑功率谱的下包络），
+ * 用判决引导（decision-directed）的先验信噪比计算 Wiener 增益，
+ * 并按抑制级别设置增益下限与噪声过估计系数。
+ *
+ * 输出比输入固定延迟一个窗长（16kHz 下 16ms）。
+ * 所有缓冲区在 Initialize 中分配，Process 不做堆分配。
+ */
+class NoiseSuppressor {
+public:
+    bool Initialize(int sampleRate);
+    void Reset();
+
+    /**
+     * @param level 0 = low, 1 = moderate, 2 = high, 3 = very high
+     */
+    void SetLevel(int level);
+
+    /**
+     * 处理一段单通道信号，out 可与 in 相同
+     * @param count 本通道的样本数
+     * @param stride 相邻样本的间隔（交织多声道时为声道数）
+     * @param stats 可选，累加输出样本的平方和与峰值（供 AGC 复用，省去一次遍历）
+     */
+    void Process(const int16_t* data, int16_t* out, int count, int stride, dsp::FrameStats* stats);
+
+    int LatencySamples() const { return 2 * hop_; }
+
+    /**
+     * 当前抑制级别的增益下限，即纯噪声段落的衰减
+     */
+    float MinGain() const { return minGain_; }
+
+private:
+    void ProcessFrame();
+
+    Fft fft_;
+    int hop_ = 0;
+    int size_ = 0;
+    int bins_ = 0;
+
+    std::vector<float> window_;
+    std::vector<float> input_;    // [上一 hop, 当前 hop]
+    std::vector<float> output_;   // 可输出的一个 hop
+    std::vector<float> overlap_;  // 上一帧合成结果的后半
+    std::vector<float> frame_;
+    std::vector<float> re_, im_;
+    int fill_ = 0;
+
+    // 每个频点的状态
+    std::vector<float> smoothedPower_;
+    std::vector<float> noise_;
+    std::vector<float> prevSnr_;  // 上一帧的 G^2 * 后验信噪比
+    float noiseRise_ = 1.0f;      // 每帧噪声估计的最大上升倍数
+    int frames_ = 0;
+
+    float minGain_ = 0.1f;
+    float overdrive_ = 1.1f;
+};
+
+} // namespace webrtc_apm
+
+#endif // NOISE_SUPPRESSOR_H
@@ -0,0 +1,148 @@
+#include "render_ring.h"
+#include <algorithm>
+#include <cstring>
+
+namespace webrtc_apm {
+
+void RenderRing::Reset(int capacitySamples, int sampleRate) {
+    uint64_t capacity = 1;
+    while (capacity < static_cast<uint64_t>(std::max(capacitySamples, 1))) {
+        capacity <<= 1;
+    }
+    samples_.assign(capacity, 0);
+    mask_ = capacity - 1;
+    sampleRate_ = sampleRate > 0 ? sampleRate : 16000;
+
+    head_.store(0, std::memory_order_relaxed);
+    tail_.store(0, std::memory_order_relaxed);
+    chunkHead_.store(0, std::memory_order_relaxed);
+    chunkTail_.store(0, std::memory_order_relaxed);
+    overruns_.store(0, std::memory_order_relaxed);
+}
+
+void RenderRing::Clear() {
+    samples_.clear();
+    samples_.shrink_to_fit();
+    mask_ = 0;
+    head_.store(0, std::memory_order_relaxed);
+    tail_.store(0, std::memory_order_relaxed);
+    chunkHead_.store(0, std::memory_order_relaxed);
+    chunkTail_.store(0, std::memory_order_relaxed);
+}
+
+bool RenderRing::Write(const int16_t* data, int count, int64_t timestampNs) {
+    if (!data || count <= 0 || samples_.empty()) return false;
+
+    uint64_t capacity = mask_ + 1;
+    uint64_t head = head_.load(std::memory_order_relaxed);
+    uint64_t tail = tail_.load(std::memory_order_acquire);
+    uint32_t chunkHead = chunkHead_.load(std::memory_order_relaxed);
+    uint32_t chunkTail = chunkTail_.load(std::memory_order_acquire);
+
+    if (static_cast<uint64_t>(count) > capacity - (head - tail) ||
+        chunkHead - chunkTail >= kMaxChunks) {
+        overruns_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    // 最多两段连续复制
+    size_t offset = head & mask_;
+    size_t first = std::min(static_cast<size_t>(count), static_cast<size_t>(capacity - offset));
+    std::memcpy(samples_.data() + offset, data, first * sizeof(int16_t));
+    if (first < static_cast<size_t>(count)) {
+        std::memcpy(samples_.data(), data + first, (count - first) * sizeof(int16_t));
+    }
+
+    chunks_[chunkHead % kMaxChunks] = Chunk{head, timestampNs};
+    chunkHead_.store(chunkHead + 1, std::memory_order_release);
+    head_.store(head + count, std::memory_order_release);
+    return true;
+}
+
+int RenderRing::Available() const {
+    return static_cast<int>(head_.load(std::memory_order_acquire) -
+                            tail_.load(std::memory_order_relaxed));
+}
+
+/**
+ * 返回 position 处样本的时间戳，以及其所在写入块的结束位置
+ *
+ * 调用前需保证 position < head，且所在块尚未被释放
+ */
+int64_t RenderRing::TimestampAt(uint64_t position, uint64_t* chunkEnd) const {
+    // 先读 head：生产者先发布块再发布 head，保证 head 之前的样本都有对应的块
+    uint64_t head = head_.load(std::memory_order_acquire);
+    uint32_t chunkTail = chunkTail_.load(std::memory_order_relaxed);
+    uint32_t chunkHead = chunkHead_.load(std::memory_order_acquire);
+
+    uint32_t index = chunkTail;
+    while (index + 1 != chunkHead && chunks_[(index + 1) % kMaxChunks].start <= position) {
+        ++index;
+    }
+
+    const Chunk& chunk = chunks_[index % kMaxChunks];
+    *chunkEnd = index + 1 != chunkHead ? chunks_[(index + 1) % kMaxChunks].start : head;
+    return chunk.timestampNs +
+           static_cast<int64_t>(position - chunk.start) * 1000000000LL / sampleRate_;
+}
+
+/**
+ * 释放完全位于 position 之前的写入块
+ */
+void RenderRing::ReleaseChunks(uint64_t position) {
+    uint32_t chunkTail = chunkTail_.load(std::memory_order_relaxed);
+    uint32_t chunkHead = chunkHead_.load(std::memory_order_acquire);
+
+    // 最后一个块的结束位置尚未确定，始终保留
+    while (chunkHead - chunkTail > 1) {
+        if (chunks_[(chunkTail + 1) % kMaxChunks].start > position) break;
+        ++chunkTail;
+    }
+    chunkTail_.store(chunkTail, std::memory_order_release);
+}
+
+void RenderRing::DiscardOlderThan(int64_t oldestNs) {
+    uint64_t tail = tail_.load(std::memory_order_relaxed);
+    uint64_t head = head_.load(std::memory_order_acquire);
+
+    while (tail < head) {
+        uint64_t chunkEnd;
+        int64_t timestamp = TimestampAt(tail, &chunkEnd);
+        if (timestamp >= oldestNs) break;
+
+        // 向上取整，跳过块内所有过旧的样本
+        uint64_t skip = static_cast<uint64_t>(
+            ((oldestNs - timestamp) * sampleRate_ + 999999999LL) / 1000000000LL);
+        tail = std::min(tail + std::max<uint64_t>(skip, 1), chunkEnd);
+    }
+
+    ReleaseChunks(tail);
+    tail_.store(tail, std::memory_order_release);
+}
+
+int RenderRing::Read(int16_t* out, int count, int64_t* timestampNs) {
+    uint64_t tail = tail_.load(std::memory_order_relaxed);
+    uint64_t head = head_.load(std::memory_order_acquire);
+    int n = static_cast<int>(std::min<uint64_t>(head - tail, count > 0 ? count : 0));
+    if (n == 0) return 0;
+
+    if (timestampNs) {
+        uint64_t chunkEnd;
+        *timestampNs = TimestampAt(tail, &chunkEnd);
+    }
+
+    uint64_t capacity = mask_ + 1;
+    size_t offset = tail & mask_;
+    size_t first = std::min(static_cast<size_t>(n), static_cast<size_t>(capacity - offset));
+    std::memcpy(out, samples_.data() + offset, first * sizeof(int16_t));
+    if (first < static_cast<size_t>(n)) {
+        std::memcpy(out + first, samples_.data(), (n - first) * sizeof(int16_t));
+    }
+
+    tail += n;
+    ReleaseChunks(tail);
+    tail_.store(tail, std::memory_order_release);
+    return n;
+}
+
+} // namespace webrtc_apm
@@ -0,0 +1,102 @@
+#ifndef RENDER_RING_H
+#define RENDER_RING_H
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+namespace webrtc_apm {
+
+/**
+ * AEC 参考信号环形缓冲区（单生产者/单消费者，无锁）
+ *
+ * 生产者为渲染（TTS）线程，消费者为采集线程。写入与读取都是 O(帧长)，
+ * 容量可以远大于 AEC 所需的窗口而不影响每帧开销。
+ *
+ * 每次写入都记录一个时间戳，消费者据此丢弃过旧的参考信号，
+ * 因此采集暂停后恢复时不会与陈旧的 TTS 数据比对。
+ * 缓冲区满时丢弃新写入的帧（由消费者负责清理旧数据）。
+ */
+class RenderRing {
+public:
+    RenderRing() = default;
+
+    RenderRing(const RenderRing&) = delete;
+    RenderRing& operator=(const RenderRing&) = delete;
+
+    /**
+     * 重新分配并清空缓冲区，不可与读写并发调用
+     * @param capacitySamples 最少容纳的样本数（向上取整为 2 的幂）
+     * @param sampleRate 采样率，用于样本位置与时间戳之间的换算
+     */
+    void Reset(int capacitySamples, int sampleRate);
+
+    /**
+     * 释放缓冲区，不可与读写并发调用
+     */
+    void Clear();
+
+    // ---- 生产者（渲染线程） ----
+
+    /**
+     * 追加一帧参考信号
+     * @param timestampNs 第一个样本的单调时钟时间
+     * @return 空间不足而丢弃时返回 false
+     */
+    bool Write(const int16_t* data, int count, int64_t timestampNs);
+
+    // ---- 消费者（采集线程） ----
+
+    /**
+     * 可读取的样本数
+     */
+    int Available() const;
+
+    /**
+     * 丢弃时间戳早于 oldestNs 的样本
+     */
+    void DiscardOlderThan(int64_t oldestNs);
+
+    /**
+     * 读取并消费最多 count 个样本
+     * @param timestampNs 可选，返回第一个样本的时间戳
+     * @return 实际读取的样本数
+     */
+    int Read(int16_t* out, int count, int64_t* timestampNs);
+
+    /**
+     * 因缓冲区满而丢弃的写入次数
+     */
+    uint64_t Overruns() const { return overruns_.load(std::memory_order_relaxed); }
+
+private:
+    struct Chunk {
+        uint64_t start;       // 第一个样本的位置
+        int64_t timestampNs;  // 第一个样本的时间
+    };
+
+    static constexpr uint32_t kMaxChunks = 128;
+
+    int64_t TimestampAt(uint64_t position, uint64_t* chunkEnd) const;
+    void ReleaseChunks(uint64_t position);
+
+    std::vector<int16_t> samples_;
+    uint64_t mask_ = 0;
+    int sampleRate_ = 16000;
+
+    Chunk chunks_[kMaxChunks] = {};
+
+    // 生产者写入，消费者读取
+    std::atomic<uint64_t> head_{0};
+    std::atomic<uint32_t> chunkHead_{0};
+
+    // 消费者写入，生产者读取
+    std::atomic<uint64_t> tail_{0};
+    std::atomic<uint32_t> chunkTail_{0};
+
+    std::atomic<uint64_t> overruns_{0};
+};
+
+} // namespace webrtc_apm
+
+#endif // RENDER_RING_H
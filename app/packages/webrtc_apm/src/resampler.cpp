@@ -0,0 +1,146 @@
+#include "resampler.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <numeric>
+
+namespace webrtc_apm {
+
+namespace {
+    // 升采样时每个相位的系数个数，降采样按 down/up 等比加长
+    constexpr int kBaseTaps = 24;
+
+    // 截止频率相对较小 Nyquist 的比例，留出过渡带
+    constexpr double kCutoff = 0.9;
+
+    // Kaiser 窗参数，约 80dB 阻带衰减
+    constexpr double kKaiserBeta = 8.0;
+
+    constexpr double kPi = 3.14159265358979323846;
+
+    // 第一类零阶修正贝塞尔函数（级数展开）
+    double BesselI0(double x) {
+        double sum = 1.0;
+        double term = 1.0;
+        double q = x * x / 4.0;
+        for (int k = 1; k < 50; ++k) {
+            term *= q / (static_cast<double>(k) * k);
+            sum += term;
+            if (term < sum * 1e-12) break;
+        }
+        return sum;
+    }
+}
+
+bool Resampler::Initialize(int inRate, int outRate, int channels) {
+    if (inRate <= 0 || outRate <= 0 || channels <= 0) return false;
+
+    int g = std::gcd(inRate, outRate);
+    up_ = outRate / g;
+    down_ = inRate / g;
+    channels_ = channels;
+
+    coeffs_.clear();
+    history_.clear();
+    taps_ = 0;
+    if (IsPassthrough()) return true;
+
+    taps_ = kBaseTaps * std::max(1, (down_ + up_ - 1) / up_);
+    int length = taps_ * up_;
+
+    // 原型低通工作在升采样后的速率上，增益为 up_ 以补偿插零
+    double fc = kCutoff * 0.5 / std::max(up_, down_);
+    double center = (length - 1) / 2.0;
+    double norm = BesselI0(kKaiserBeta);
+    std::vector<double> prototype(length);
+    double sum = 0.0;
+    for (int i = 0; i < length; ++i) {
+        double t = i - center;
+        double sinc = t == 0.0 ? 2.0 * fc : std::sin(2.0 * kPi * fc * t) / (kPi * t);
+        double r = t / (center + 1.0);
+        double window = BesselI0(kKaiserBeta * std::sqrt(std::max(0.0, 1.0 - r * r))) / norm;
+        prototype[i] = sinc * window;
+        sum += prototype[i];
+    }
+
+    // 拆成 up_ 个相位，各相位内按时间反转存放
+    coeffs_.resize(length);
+    for (int p = 0; p < up_; ++p) {
+        for (int k = 0; k < taps_; ++k) {
+            coeffs_[p * taps_ + (taps_ - 1 - k)] = static_cast<float>(prototype[p + k * up_] * up_ / sum);
+        }
+    }
+
+    history_.resize(channels_);
+    Reset();
+    return true;
+}
+
+void Resampler::Reset() {
+    for (auto& h : history_) h.assign(taps_ - 1, 0.0f);
+    phase_ = 0;
+    next_ = 0;
+}
+
+int Resampler::MaxOutputFrames(int frames) const {
+    if (IsPassthrough()) return frames;
+    return static_cast<int>((static_cast<int64_t>(frames) * up_ + down_ - 1) / down_) + 1;
+}
+
+int Resampler::Process(const int16_t* in, int frames, int16_t* out) {
+    if (frames <= 0) return 0;
+    if (IsPassthrough()) {
+        if (out != in) std::memcpy(out, in, static_cast<size_t>(frames) * channels_ * sizeof(int16_t));
+        return frames;
+    }
+
+    int keep = taps_ - 1;
+    int produced = 0;
+    int phase = phase_;
+    int next = next_;
+
+    for (int c = 0; c < channels_; ++c) {
+        // 解交织到该声道的历史缓冲区之后
+        std::vector<float>& buf = history_[c];
+        buf.resize(keep + frames);
+        for (int i = 0; i < frames; ++i) {
+            buf[keep + i] = in[i * channels_ + c];
+        }
+
+        // 输出 j 对应最新输入 n、相位 p，所需窗口为 buf[n, n + taps_)
+        phase = phase_;
+        next = next_;
+        int j = 0;
+        while (next < frames) {
+            const float* h = coeffs_.data() + phase * taps_;
+            const float* x = buf.data() + next;
+            float acc0 = 0.0f, acc1 = 0.0f, acc2 = 0.0f, acc3 = 0.0f;
+            int k = 0;
+            for (; k + 4 <= taps_; k += 4) {
+                acc0 += h[k] * x[k];
+                acc1 += h[k + 1] * x[k + 1];
+                acc2 += h[k + 2] * x[k + 2];
+                acc3 += h[k + 3] * x[k + 3];
+            }
+            for (; k < taps_; ++k) acc0 += h[k] * x[k];
+            float y = std::clamp((acc0 + acc1) + (acc2 + acc3), -32768.0f, 32767.0f);
+            out[j * channels_ + c] = static_cast<int16_t>(std::lrint(y));
+            ++j;
+
+            phase += down_;
+            next += phase / up_;
+            phase %= up_;
+        }
+        produced = j;
+
+        // 保留最近 keep 个样本作为下次的历史
+        std::memmove(buf.data(), buf.data() + frames, keep * sizeof(float));
+        buf.resize(keep);
+    }
+
+    phase_ = phase;
+    next_ = next - frames;
+    return produced;
+}
+
+} // namespace webrtc_apm
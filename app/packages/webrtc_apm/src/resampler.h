@@ -0,0 +1,57 @@
+#ifndef RESAMPLER_H
+#define RESAMPLER_H
+
+#include <cstdint>
+#include <vector>
+
+namespace webrtc_apm {
+
+/**
+ * 有理数比例的多相 FIR 重采样器（交织多声道 PCM16，流式）
+ *
+ * 比例化简为 up/down 后按多相结构计算：对每个输出样本只取一组相位系数与
+ * 最近的 taps 个输入做点积，不生成插零的中间序列。原型滤波器为 Kaiser 窗 sinc，
+ * 截止频率取两侧 Nyquist 的较小者，降采样时按比例加长以保持过渡带宽度。
+ *
+ * 输入按声道解交织到各自的浮点历史缓冲区中处理，调用之间保留相位与历史，
+ * 任意长度的输入拼接后与一次性处理结果一致。
+ * 输入输出采样率相同时为直通。
+ */
+class Resampler {
+public:
+    bool Initialize(int inRate, int outRate, int channels);
+    void Reset();
+
+    bool IsPassthrough() const { return up_ == down_; }
+
+    /**
+     * 输入 frames 帧时最多产生的输出帧数
+     */
+    int MaxOutputFrames(int frames) const;
+
+    /**
+     * @param in 交织输入，frames 帧
+     * @param out 交织输出，容量至少为 MaxOutputFrames(frames) 帧
+     * @return 输出帧数
+     */
+    int Process(const int16_t* in, int frames, int16_t* out);
+
+private:
+    int up_ = 1;
+    int down_ = 1;
+    int taps_ = 0;      // 每个相位的系数个数
+    int channels_ = 0;
+
+    // 相位主序：coeffs_[p * taps_ + j]，j 已按时间反转，可直接与历史做点积
+    std::vector<float> coeffs_;
+
+    // 每个声道 [taps_ - 1 个历史样本, 本次输入]
+    std::vector<std::vector<float>> history_;
+
+    int phase_ = 0;     // 下一个输出的相位
+    int next_ = 0;      // 下一个输出对应的最新输入下标（相对本次输入起点）
+};
+
+} // namespace webrtc_apm
+
+#endif // RESAMPLER_H
@@ -0,0 +1,141 @@
+#include "voice_detector.h"
+#include <algorithm>
+#include <cmath>
+
+namespace webrtc_apm {
+
+namespace {
+    constexpr int kBlockMs = 10;
+
+    // 平坦度统计的频带：语音能量集中的区间，避开低频嗡声
+    constexpr float kLowHz = 300.0f;
+    constexpr float kHighHz = 4000.0f;
+
+    // 平坦度低于此值视为浊音（白噪声约 0.56）
+    constexpr float kMaxFlatness = 0.4f;
+
+    // 能量高于噪声底 6dB 才可能是语音；低于 RMS 20 一律视为静音（与 AGC 的静音门限一致）
+    constexpr float kSpeechSnr = 4.0f;
+    constexpr float kMinSpeechEnergy = 20.0f * 20.0f;
+
+    // 噪声底：下降系数、非浊音块与浊音块的上升速率
+    constexpr float kNoiseFall = 0.2f;
+    constexpr float kNoiseRiseDbPerSec = 4.0f;
+    constexpr float kVoicedNoiseRiseDbPerSec = 0.5f;
+    constexpr float kMinNoise = 1.0f;
+
+    // 语音结束后保持的拖尾
+    constexpr int kHangoverMs = 300;
+
+    constexpr float kEpsilon = 1.0f;
+
+    float RisePerBlock(float dbPerSec) {
+        return static_cast<float>(std::pow(10.0, dbPerSec / 10.0 * kBlockMs / 1000.0));
+    }
+}
+
+bool VoiceDetector::Initialize(int sampleRate) {
+    if (sampleRate <= 0) return false;
+
+    int size = 16;
+    while (size < sampleRate / 1000 * kBlockMs) size <<= 1;
+    if (!fft_.Init(size)) return false;
+
+    lowBin_ = static_cast<int>(std::ceil(kLowHz * size / sampleRate));
+    highBin_ = std::min(static_cast<int>(kHighHz * size / sampleRate), fft_.Bins() - 1);
+    lowBin_ = std::min(lowBin_, highBin_);
+
+    window_.assign(size, 0.0f);
+    frame_.assign(size, 0.0f);
+    re_.assign(fft_.Bins(), 0.0f);
+    im_.assign(fft_.Bins(), 0.0f);
+    windowCount_ = 0;
+
+    noiseRise_ = RisePerBlock(kNoiseRiseDbPerSec);
+    voicedNoiseRise_ = RisePerBlock(kVoicedNoiseRiseDbPerSec);
+    hangoverBlocks_ = kHangoverMs / kBlockMs;
+
+    Reset();
+    return true;
+}
+
+void VoiceDetector::Reset() {
+    noise_ = kMinNoise;
+    hasNoise_ = false;
+    hangover_ = 0;
+}
+
+/**
+ * 块长变化时重新计算 Hann 窗（通常只在第一块发生），其余部分补零
+ */
+void VoiceDetector::UpdateWindow(int count) {
+    if (count == windowCount_) return;
+    for (int i = 0; i < fft_.Size(); ++i) {
+        window_[i] = i < count ? static_cast<float>(0.5 * (1.0 - std::cos(2.0 * M_PI * i / count))) : 0.0f;
+        frame_[i] = 0.0f;
+    }
+    windowCount_ = count;
+}
+
+bool VoiceDetector::Process(const int16_t* data, int count, int stride) {
+    if (fft_.Size() == 0 || count <= 0) return IsSpeech();
+    count = std::min(count, fft_.Size());
+    UpdateWindow(count);
+
+    // 混合为单声道加窗，同时统计能量
+    float energy = 0.0f;
+    for (int i = 0; i < count; ++i) {
+        float v;
+        if (stride == 1) {
+            v = data[i];
+        } else {
+            int sum = 0;
+            for (int c = 0; c < stride; ++c) sum += data[i * stride + c];
+            v = static_cast<float>(sum) / stride;
+        }
+        energy += v * v;
+        frame_[i] = v * window_[i];
+    }
+    energy /= count;
+
+    bool voiced = SpectralFlatness() < kMaxFlatness;
+
+    // 噪声底跟踪
+    if (!hasNoise_) {
+        noise_ = energy;
+        hasNoise_ = true;
+    } else if (energy < noise_) {
+        noise_ += kNoiseFall * (energy - noise_);
+    } else {
+        noise_ = std::min(noise_ * (voiced ? voicedNoiseRise_ : noiseRise_), energy);
+    }
+    noise_ = std::max(noise_, kMinNoise);
+
+    bool loud = energy >= kMinSpeechEnergy && energy > kSpeechSnr * noise_;
+    bool speech = IsSpeech() ? loud : loud && voiced;
+    if (speech) {
+        hangover_ = hangoverBlocks_;
+    } else if (hangover_ > 0) {
+        --hangover_;
+    }
+    return IsSpeech();
+}
+
+/**
+ * 语音频带内功率谱的几何平均与算术平均之比（0..1，越小越接近谐波结构）
+ */
+float VoiceDetector::SpectralFlatness() {
+    fft_.Forward(frame_.data(), re_.data(), im_.data());
+
+    double logSum = 0.0;
+    double sum = 0.0;
+    for (int k = lowBin_; k <= highBin_; ++k) {
+        float power = re_[k] * re_[k] + im_[k] * im_[k] + kEpsilon;
+        logSum += std::log(power);
+        sum += power;
+    }
+    int bins = highBin_ - lowBin_ + 1;
+    return static_cast<float>(std::exp(logSum / bins) / (sum / bins));
+}
+
+} // namespace webrtc_apm
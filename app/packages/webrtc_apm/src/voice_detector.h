@@ -0,0 +1,63 @@
+#ifndef VOICE_DETECTOR_H
+#define VOICE_DETECTOR_H
+
+#include "fft.h"
+#include <cstdint>
+#include <vector>
+
+namespace webrtc_apm {
+
+/**
+ * 语音活动检测（VAD）
+ *
+ * 每个 10ms 块计算两个特征：块能量相对噪声底的倍数，以及 300-4000Hz 功率谱的
+ * 平坦度（几何平均 / 算术平均，白噪声约 0.56，浊音通常低于 0.3）。
+ * 能量高于噪声底且频谱不平坦时判为语音起点；进入语音后只看能量，
+ * 覆盖清辅音等平坦的段落。判决结束后再保持一段拖尾，覆盖词间停顿。
+ *
+ * 噪声底跟踪块能量的下包络：快降慢升，判为浊音的块上升得更慢，
+ * 避免持续讲话时噪声底被抬高。
+ * 所有缓冲区在 Initialize 中分配，Process 不做堆分配。
+ */
+class VoiceDetector {
+public:
+    bool Initialize(int sampleRate);
+    void Reset();
+
+    /**
+     * 检测一个 10ms 块
+     * @param count 每声道的样本数
+     * @param stride 相邻样本的间隔（交织多声道时为声道数，各声道取平均后检测）
+     * @return 是否为语音（含拖尾）
+     */
+    bool Process(const int16_t* data, int count, int stride);
+
+    bool IsSpeech() const { return hangover_ > 0; }
+
+private:
+    float SpectralFlatness();
+    void UpdateWindow(int count);
+
+    Fft fft_;
+    int lowBin_ = 0;
+    int highBin_ = 0;
+
+    // 按块长缓存的分析窗
+    int windowCount_ = 0;
+    std::vector<float> window_;
+    std::vector<float> frame_;
+    std::vector<float> re_, im_;
+
+    // 噪声底（每样本平均能量，PCM16 量纲）与每块上升倍数
+    float noise_ = 0.0f;
+    float noiseRise_ = 1.0f;
+    float voicedNoiseRise_ = 1.0f;
+    bool hasNoise_ = false;
+
+    int hangoverBlocks_ = 0;
+    int hangover_ = 0;
+};
+
+} // namespace webrtc_apm
+
+#endif // VOICE_DETECTOR_H
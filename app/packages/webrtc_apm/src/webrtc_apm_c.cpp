@@ -0,0 +1,93 @@
+#include "include/webrtc_apm_c.h"
+#include "include/audio_processor.h"
+#include <new>
+
+#define LOG_TAG "WebRTC_APM_C"
+#include "apm_log.h"
+
+struct WebrtcApm {
+    webrtc_apm::AudioProcessor processor;
+};
+
+extern "C" {
+
+WebrtcApm* webrtc_apm_create(int32_t sample_rate, int32_t channels) {
+    auto* apm = new (std::nothrow) WebrtcApm();
+    if (!apm) return nullptr;
+    if (!apm->processor.Initialize(sample_rate, channels)) {
+        LOGE("webrtc_apm_create: initialize failed, sampleRate=%d, channels=%d", sample_rate, channels);
+        delete apm;
+        return nullptr;
+    }
+    return apm;
+}
+
+void webrtc_apm_destroy(WebrtcApm* apm) {
+    if (!apm) return;
+    apm->processor.Destroy();
+    delete apm;
+}
+
+int32_t webrtc_apm_set_aec_enabled(WebrtcApm* apm, int32_t enabled) {
+    return apm && apm->processor.SetAecEnabled(enabled != 0) ? 1 : 0;
+}
+
+int32_t webrtc_apm_set_aec_suppression_level(WebrtcApm* apm, int32_t level) {
+    return apm && apm->processor.SetAecSuppressionLevel(level) ? 1 : 0;
+}
+
+int32_t webrtc_apm_set_ns_enabled(WebrtcApm* apm, int32_t enabled) {
+    return apm && apm->processor.SetNsEnabled(enabled != 0) ? 1 : 0;
+}
+
+int32_t webrtc_apm_set_ns_suppression_level(WebrtcApm* apm, int32_t level) {
+    return apm && apm->processor.SetNsSuppressionLevel(level) ? 1 : 0;
+}
+
+int32_t webrtc_apm_set_agc_enabled(WebrtcApm* apm, int32_t enabled) {
+    return apm && apm->processor.SetAgcEnabled(enabled != 0) ? 1 : 0;
+}
+
+int32_t webrtc_apm_set_agc_mode(WebrtcApm* apm, int32_t mode) {
+    return apm && apm->processor.SetAgcMode(mode) ? 1 : 0;
+}
+
+int32_t webrtc_apm_set_agc_target_level(WebrtcApm* apm, int32_t target_level_dbfs) {
+    return apm && apm->processor.SetAgcTargetLevel(target_level_dbfs) ? 1 : 0;
+}
+
+int32_t webrtc_apm_set_vad_enabled(WebrtcApm* apm, int32_t enabled) {
+    return apm && apm->processor.SetVadEnabled(enabled != 0) ? 1 : 0;
+}
+
+int32_t webrtc_apm_set_downmix_enabled(WebrtcApm* apm, int32_t enabled) {
+    return apm && apm->processor.SetDownmixEnabled(enabled != 0) ? 1 : 0;
+}
+
+int32_t webrtc_apm_process_capture(WebrtcApm* apm, const int16_t* input,
+                                   int32_t sample_count, int16_t* output) {
+    if (!apm || !input || !output || sample_count < 0) return -1;
+    return apm->processor.ProcessCaptureFrame(input, sample_count, output);
+}
+
+int32_t webrtc_apm_last_capture_speech(const WebrtcApm* apm) {
+    return !apm || apm->processor.LastCaptureSpeech() ? 1 : 0;
+}
+
+int32_t webrtc_apm_process_render(WebrtcApm* apm, const int16_t* data, int32_t sample_count) {
+    if (!apm || !data || sample_count <= 0) return 0;
+    return apm->processor.ProcessRenderFrame(data, sample_count) ? 1 : 0;
+}
+
+int32_t webrtc_apm_process_capture_batch(WebrtcApm* apm,
+                                         const int16_t* capture, int32_t sample_count,
+                                         const int16_t* render, int32_t render_count,
+                                         int32_t frame_samples, int16_t* output) {
+    if (!apm || !capture || !output || sample_count < 0 || frame_samples <= 0) return -1;
+    if (sample_count == 0) return 0;
+    int32_t processed = apm->processor.ProcessCaptureBatch(capture, sample_count, render,
+                                                           render ? render_count : 0, frame_samples, output);
+    return processed > 0 ? processed : -1;
+}
+
+} // extern "C"
@@ -3,6 +3,7 @@
 #include <optional>
 
 #include "flutter/generated_plugin_registrant.h"
+#include "startup.h"
 
 FlutterWindow::FlutterWindow(const flutter::DartProject& project)
     : project_(project) {}
@@ -13,6 +14,7 @@ bool FlutterWindow::OnCreate() {
   if (!Win32Window::OnCreate()) {
     return false;
   }
+  StartupTraceMark("window_created");
 
   RECT frame = GetClientArea();
 
@@ -24,11 +26,27 @@ bool FlutterWindow::OnCreate() {
   if (!flutter_controller_->engine() || !flutter_controller_->view()) {
     return false;
   }
-  RegisterPlugins(flutter_controller_->engine());
+  StartupTraceMark("engine_init");
+
+  // Plugins that are only used on user action can wait until the window is
+  // on screen.
+  defer_plugins_ = StartupDeferPluginsEnabled();
+  if (defer_plugins_) {
+    RegisterStartupPlugins(flutter_controller_->engine());
+  } else {
+    RegisterPlugins(flutter_controller_->engine());
+  }
+  StartupTraceMark("plugins_registered");
   SetChildContent(flutter_controller_->view()->GetNativeWindow());
 
   flutter_controller_->engine()->SetNextFrameCallback([&]() {
     this->Show();
+    StartupTraceMark("first_frame");
+    if (defer_plugins_) {
+      RegisterDeferredPlugins(flutter_controller_->engine());
+      StartupTraceMark("deferred_plugins_registered");
+    }
+    StartupTraceWrite();
   });
 
   // Flutter can complete the first frame before the "show window" callback is
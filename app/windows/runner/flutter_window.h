@@ -28,6 +28,10 @@ class FlutterWindow : public Win32Window {
 
   // The Flutter instance hosted by this window.
   std::unique_ptr<flutter::FlutterViewController> flutter_controller_;
+
+  // Whether plugins used only on user action are registered after the first
+  // frame instead of in OnCreate.
+  bool defer_plugins_ = false;
 };
 
 #endif  // RUNNER_FLUTTER_WINDOW_H_
@@ -3,10 +3,20 @@
 #include <windows.h>
 
 #include "flutter_window.h"
+#include "startup.h"
 #include "utils.h"
 
 int APIENTRY wWinMain(_In_ HINSTANCE instance, _In_opt_ HINSTANCE prev,
                       _In_ wchar_t *command_line, _In_ int show_command) {
+  StartupTraceBegin();
+
+  // Warm the AOT snapshot and ICU data while the window and engine are set
+  // up; the engine maps both before it can render the first frame.
+  std::thread prewarm;
+  if (StartupPrewarmEnabled()) {
+    prewarm = PrewarmProject(L"data");
+  }
+
   // Attach to console when present (e.g., 'flutter run') or create a
   // new console when running with a debugger.
   if (!::AttachConsole(ATTACH_PARENT_PROCESS) && ::IsDebuggerPresent()) {
@@ -28,6 +38,9 @@ int APIENTRY wWinMain(_In_ HINSTANCE instance, _In_opt_ HINSTANCE prev,
   Win32Window::Point origin(10, 10);
   Win32Window::Size size(1280, 720);
   if (!window.Create(L"ai_bookkeeping", origin, size)) {
+    if (prewarm.joinable()) {
+      prewarm.join();
+    }
     return EXIT_FAILURE;
   }
   window.SetQuitOnClose(true);
@@ -38,6 +51,9 @@ int APIENTRY wWinMain(_In_ HINSTANCE instance, _In_opt_ HINSTANCE prev,
     ::DispatchMessage(&msg);
   }
 
+  if (prewarm.joinable()) {
+    prewarm.join();
+  }
   ::CoUninitialize();
   return EXIT_SUCCESS;
 }
@@ -0,0 +1,164 @@
+#include "startup.h"
+
+#include <windows.h>
+
+#include <chrono>
+#include <fstream>
+#include <vector>
+
+#include <connectivity_plus/connectivity_plus_windows_plugin.h>
+#include <file_selector_windows/file_selector_windows.h>
+#include <flutter_secure_storage_windows/flutter_secure_storage_windows_plugin.h>
+#include <flutter_tts/flutter_tts_plugin.h>
+#include <gal/gal_plugin_c_api.h>
+#include <geolocator_windows/geolocator_windows.h>
+#include <permission_handler_windows/permission_handler_windows_plugin.h>
+#include <record_windows/record_windows_plugin_c_api.h>
+#include <share_plus/share_plus_windows_plugin_c_api.h>
+#include <speech_to_text_windows/speech_to_text_windows.h>
+#include <url_launcher_windows/url_launcher_windows.h>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct TraceEvent {
+  const char* name;
+  Clock::time_point time;
+};
+
+std::wstring trace_path;
+Clock::time_point trace_start;
+std::vector<TraceEvent> trace_events;
+
+// Returns the value of the environment variable |name|, or an empty string if
+// it is not set.
+std::wstring GetEnvironment(const wchar_t* name) {
+  DWORD size = ::GetEnvironmentVariableW(name, nullptr, 0);
+  if (size == 0) {
+    return std::wstring();
+  }
+  std::wstring value(size, L'\0');
+  size = ::GetEnvironmentVariableW(name, value.data(), size);
+  value.resize(size);
+  return value;
+}
+
+// Returns true if the environment variable |name| is set to anything but an
+// empty string or "0".
+bool GetEnvironmentFlag(const wchar_t* name) {
+  std::wstring value = GetEnvironment(name);
+  return !value.empty() && value != L"0";
+}
+
+long long MicrosecondsBetween(Clock::time_point from, Clock::time_point to) {
+  return std::chrono::duration_cast<std::chrono::microseconds>(to - from)
+      .count();
+}
+
+// Reads |path| to the end so that later mappings of it hit the file cache.
+// Missing files are skipped silently as the bundle layout differs between
+// debug and release builds.
+void ReadIntoCache(const std::wstring& path) {
+  HANDLE file =
+      ::CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                    OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+  if (file == INVALID_HANDLE_VALUE) {
+    return;
+  }
+  std::vector<char> buffer(1 << 20);
+  DWORD read = 0;
+  while (::ReadFile(file, buffer.data(), static_cast<DWORD>(buffer.size()),
+                    &read, nullptr) &&
+         read > 0) {
+  }
+  ::CloseHandle(file);
+}
+
+}  // namespace
+
+void StartupTraceBegin() {
+  trace_start = Clock::now();
+  trace_path = GetEnvironment(L"AI_BOOKKEEPING_STARTUP_TRACE");
+  if (!trace_path.empty()) {
+    trace_events.reserve(16);
+  }
+}
+
+void StartupTraceMark(const char* event) {
+  if (trace_path.empty()) {
+    return;
+  }
+  trace_events.push_back({event, Clock::now()});
+}
+
+void StartupTraceWrite() {
+  if (trace_path.empty()) {
+    return;
+  }
+
+  std::ofstream out(trace_path, std::ios::trunc);
+  Clock::time_point previous = trace_start;
+  for (const TraceEvent& event : trace_events) {
+    out << event.name << '\t' << MicrosecondsBetween(trace_start, event.time)
+        << '\t' << MicrosecondsBetween(previous, event.time) << '\n';
+    previous = event.time;
+  }
+  trace_path.clear();
+}
+
+bool StartupPrewarmEnabled() {
+  return GetEnvironmentFlag(L"AI_BOOKKEEPING_PREWARM");
+}
+
+bool StartupDeferPluginsEnabled() {
+  return GetEnvironmentFlag(L"AI_BOOKKEEPING_DEFER_PLUGINS");
+}
+
+std::thread PrewarmProject(const std::wstring& data_path) {
+  wchar_t executable[MAX_PATH];
+  DWORD length = ::GetModuleFileNameW(nullptr, executable, MAX_PATH);
+  if (length == 0 || length == MAX_PATH) {
+    return std::thread();
+  }
+  std::wstring data_dir(executable, length);
+  data_dir.resize(data_dir.find_last_of(L'\\') + 1);
+  data_dir += data_path + L"\\";
+
+  return std::thread([data_dir]() {
+    ReadIntoCache(data_dir + L"app.so");
+    ReadIntoCache(data_dir + L"icudtl.dat");
+    ReadIntoCache(data_dir + L"flutter_assets\\kernel_blob.bin");
+  });
+}
+
+void RegisterStartupPlugins(flutter::PluginRegistry* registry) {
+  // Used by the HTTP, auth and sync services right after the first frame.
+  ConnectivityPlusWindowsPluginRegisterWithRegistrar(
+      registry->GetRegistrarForPlugin("ConnectivityPlusWindowsPlugin"));
+  FlutterSecureStorageWindowsPluginRegisterWithRegistrar(
+      registry->GetRegistrarForPlugin("FlutterSecureStorageWindowsPlugin"));
+  // The wake-up service may request permissions and start listening during
+  // startup.
+  PermissionHandlerWindowsPluginRegisterWithRegistrar(
+      registry->GetRegistrarForPlugin("PermissionHandlerWindowsPlugin"));
+  RecordWindowsPluginCApiRegisterWithRegistrar(
+      registry->GetRegistrarForPlugin("RecordWindowsPluginCApi"));
+  SpeechToTextWindowsRegisterWithRegistrar(
+      registry->GetRegistrarForPlugin("SpeechToTextWindows"));
+}
+
+void RegisterDeferredPlugins(flutter::PluginRegistry* registry) {
+  FileSelectorWindowsRegisterWithRegistrar(
+      registry->GetRegistrarForPlugin("FileSelectorWindows"));
+  FlutterTtsPluginRegisterWithRegistrar(
+      registry->GetRegistrarForPlugin("FlutterTtsPlugin"));
+  GalPluginCApiRegisterWithRegistrar(
+      registry->GetRegistrarForPlugin("GalPluginCApi"));
+  GeolocatorWindowsRegisterWithRegistrar(
+      registry->GetRegistrarForPlugin("GeolocatorWindows"));
+  SharePlusWindowsPluginCApiRegisterWithRegistrar(
+      registry->GetRegistrarForPlugin("SharePlusWindowsPluginCApi"));
+  UrlLauncherWindowsRegisterWithRegistrar(
+      registry->GetRegistrarForPlugin("UrlLauncherWindows"));
+}
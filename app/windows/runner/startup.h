@@ -0,0 +1,50 @@
+#ifndef RUNNER_STARTUP_H_
+#define RUNNER_STARTUP_H_
+
+#include <flutter/plugin_registry.h>
+
+#include <string>
+#include <thread>
+
+// Startup-time helpers for the runner. Everything here is controlled by
+// environment variables so release builds behave exactly like the stock
+// runner unless a variable is set:
+//
+//   AI_BOOKKEEPING_STARTUP_TRACE=<path>  record startup milestones to <path>.
+//   AI_BOOKKEEPING_PREWARM=1             warm the Dart project files while the
+//                                        window and engine are being created.
+//   AI_BOOKKEEPING_DEFER_PLUGINS=1       register plugins that are only used
+//                                        on user action after the first frame.
+
+// Starts the startup trace if AI_BOOKKEEPING_STARTUP_TRACE is set. Call as
+// early as possible in wWinMain; all timestamps are relative to this call.
+void StartupTraceBegin();
+
+// Records the monotonic time of |event|, which must be a string literal.
+// No-op when tracing is disabled.
+void StartupTraceMark(const char* event);
+
+// Writes the recorded milestones to the trace file, one
+// "event<TAB>elapsed_us<TAB>delta_us" line each. Only the first call writes.
+void StartupTraceWrite();
+
+// Returns true if AI_BOOKKEEPING_PREWARM is set.
+bool StartupPrewarmEnabled();
+
+// Returns true if AI_BOOKKEEPING_DEFER_PLUGINS is set.
+bool StartupDeferPluginsEnabled();
+
+// Reads the AOT snapshot and ICU data from |data_path|, relative to the
+// executable the same way as flutter::DartProject, into the file cache on a
+// background thread. The returned thread must be joined before exit.
+std::thread PrewarmProject(const std::wstring& data_path);
+
+// Registers the plugins the app uses while starting up. Together with
+// RegisterDeferredPlugins this mirrors RegisterPlugins; keep both in step
+// with flutter/generated_plugin_registrant.cc.
+void RegisterStartupPlugins(flutter::PluginRegistry* registry);
+
+// Registers the plugins that are only used on user action.
+void RegisterDeferredPlugins(flutter::PluginRegistry* registry);
+
+#endif  // RUNNER_STARTUP_H_
@@ -11,13 +11,16 @@ Usage:
 Requirements:
     - bsdiff4 Python package: pip install bsdiff4
     - or bsdiff command line tool
+    - zstandard Python package for --codec zstd: pip install zstandard
 
 Example:
     python generate_patch.py app_v1.0.0.apk app_v1.1.0.apk patch_1.0.0_to_1.1.0.patch
 """
 
 import argparse
+import bz2
 import hashlib
+import struct
 import os
 import sys
 import subprocess
@@ -32,6 +35,15 @@ try:
 except ImportError:
     HAS_BSDIFF4 = False
 
+try:
+    import zstandard
+    HAS_ZSTD = True
+except ImportError:
+    HAS_ZSTD = False
+
+# Block codec ids of the BSDIFF41 header understood by the app's bspatch
+CODEC_IDS = {'gzip': 0, 'zstd': 1}
+
 
 def calculate_md5(file_path: str) -> str:
     """Calculate MD5 hash of a file."""
@@ -104,6 +116,78 @@ def generate_patch(old_path: str, new_path: str, patch_path: str) -> bool:
         return generate_patch_cmdline(old_path, new_path, patch_path)
 
 
+def _offtin(buf: bytes) -> int:
+    """Decode a bsdiff sign-magnitude 8-byte integer."""
+    value = struct.unpack('<Q', buf)[0]
+    if value & (1 << 63):
+        return -(value & ~(1 << 63))
+    return value
+
+
+def _offtout(value: int) -> bytes:
+    """Encode a bsdiff sign-magnitude 8-byte integer."""
+    if value < 0:
+        return struct.pack('<Q', -value | (1 << 63))
+    return struct.pack('<Q', value)
+
+
+def _decompress_block(data: bytes) -> bytes:
+    """Decompress a BSDIFF40 block written by bsdiff (bzip2) or gzip."""
+    if not data:
+        return b''
+    if data[:3] == b'BZh':
+        return bz2.decompress(data)
+    return gzip.decompress(data)
+
+
+def repack_patch(patch_path: str, codec: str) -> bool:
+    """Re-encode the blocks of a BSDIFF40 patch for the app's bspatch.
+
+    gzip keeps the BSDIFF40 header; zstd writes a BSDIFF41 header carrying
+    the codec id, which decodes several times faster on device.
+    """
+    try:
+        with open(patch_path, 'rb') as f:
+            patch_data = f.read()
+
+        if len(patch_data) < 32 or patch_data[:8] != b'BSDIFF40':
+            print("Error: not a BSDIFF40 patch")
+            return False
+
+        ctrl_len = _offtin(patch_data[8:16])
+        diff_len = _offtin(patch_data[16:24])
+        new_size = _offtin(patch_data[24:32])
+        blocks = [
+            patch_data[32:32 + ctrl_len],
+            patch_data[32 + ctrl_len:32 + ctrl_len + diff_len],
+            patch_data[32 + ctrl_len + diff_len:],
+        ]
+        ctrl, diff, extra = [_decompress_block(b) for b in blocks]
+
+        if codec == 'zstd':
+            if not HAS_ZSTD:
+                print("Error: zstandard package not installed")
+                return False
+            compressor = zstandard.ZstdCompressor(level=19)
+            ctrl, diff, extra = [compressor.compress(b) for b in (ctrl, diff, extra)]
+            header = b'BSDIFF41'
+        else:
+            ctrl, diff, extra = [gzip.compress(b, 9) for b in (ctrl, diff, extra)]
+            header = b'BSDIFF40'
+
+        header += _offtout(len(ctrl)) + _offtout(len(diff)) + _offtout(new_size)
+        if header[:8] == b'BSDIFF41':
+            header += _offtout(CODEC_IDS[codec])
+
+        with open(patch_path, 'wb') as f:
+            f.write(header + ctrl + diff + extra)
+
+        return True
+    except Exception as e:
+        print(f"Error repacking patch: {e}")
+        return False
+
+
 def verify_patch(old_path: str, patch_path: str, expected_md5: str) -> bool:
     """Verify patch by applying it and checking MD5."""
     if not HAS_BSDIFF4:
@@ -150,6 +234,8 @@ def main():
     parser.add_argument('output_patch', help='Path for the output patch file')
     parser.add_argument('--verify', action='store_true',
                        help='Verify patch after generation')
+    parser.add_argument('--codec', choices=sorted(CODEC_IDS),
+                       help='Re-encode patch blocks for the app (gzip or zstd)')
     parser.add_argument('--json', action='store_true',
                        help='Output metadata as JSON')
 
@@ -195,6 +281,19 @@ def main():
         print("Failed to generate patch!")
         sys.exit(1)
 
+    # Verify against the bsdiff4 output before it is re-encoded
+    if args.verify and args.codec:
+        print()
+        if not verify_patch(args.old_apk, args.output_patch, new_md5):
+            print("Patch verification failed!")
+            sys.exit(1)
+
+    if args.codec:
+        print(f"Re-encoding patch blocks with {args.codec}...")
+        if not repack_patch(args.output_patch, args.codec):
+            print("Failed to re-encode patch!")
+            sys.exit(1)
+
     duration = (datetime.now() - start_time).total_seconds()
 
     # Get patch info
@@ -211,7 +310,7 @@ def main():
     print(f"  Time: {duration:.1f} seconds")
 
     # Verify if requested
-    if args.verify:
+    if args.verify and not args.codec:
         print()
         if not verify_patch(args.old_apk, args.output_patch, new_md5):
             print("Patch verification failed!")